@@ -0,0 +1,13 @@
+#version 410 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aOffset;
+
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+
+uniform float scale;
+
+void main() {
+    gl_Position = viewProjection * vec4(aPos * scale + aOffset, 1.0);
+}
@@ -0,0 +1,13 @@
+// frameData.glsl
+// Per-frame values shared by every shader; must match FrameData in FrameUniforms.h member for member
+layout(std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+    vec4 lightPosition;
+    vec4 lightColor;
+    vec4 sunDirection;
+    float time;
+    float deltaTime;
+};
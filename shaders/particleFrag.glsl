@@ -0,0 +1,17 @@
+#version 410 core
+
+in vec2 corner;
+
+uniform vec4 particleColor;
+uniform float streak;
+
+out vec4 FragColor;
+
+void main() {
+    // Round soft flakes, or streaks that fade towards their long edges
+    float falloff = streak > 0.0 ? 1.0 - abs(corner.x) : 1.0 - dot(corner, corner);
+    if (falloff <= 0.0) {
+        discard;
+    }
+    FragColor = vec4(particleColor.rgb, particleColor.a * falloff);
+}
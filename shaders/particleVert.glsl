@@ -0,0 +1,33 @@
+#version 410 core
+
+layout(location = 0) in vec4 aParticle; // xyz position, w sway phase
+
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+
+uniform vec3 velocity;
+uniform float size;
+uniform float streak;
+uniform float sway;
+
+out vec2 corner;
+
+void main() {
+    // Quad corner from the vertex index, drawn as a four-vertex strip
+    corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+
+    // Drift around the simulated position so flakes do not fall in straight lines
+    vec3 center = aParticle.xyz + vec3(sin(time * 1.3 + aParticle.w), 0.0, cos(time * 0.9 + aParticle.w * 1.7)) * sway;
+
+    // Billboard axes from the camera; streaks are stretched along the fall direction instead
+    vec3 right = vec3(view[0][0], view[1][0], view[2][0]);
+    vec3 up = vec3(view[0][1], view[1][1], view[2][1]);
+    if (streak > 0.0) {
+        vec3 back = vec3(view[0][2], view[1][2], view[2][2]);
+        up = normalize(velocity);
+        right = normalize(cross(up, back));
+    }
+
+    vec3 position = center + right * (corner.x * size * 0.5) + up * (corner.y * (size + streak) * 0.5);
+    gl_Position = viewProjection * vec4(position, 1.0);
+}
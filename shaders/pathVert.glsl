@@ -2,10 +2,11 @@
 
 layout(location = 0) in vec3 aPos;
 
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
 }
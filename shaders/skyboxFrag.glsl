@@ -3,8 +3,49 @@ out vec4 FragColor;
 
 in vec3 TexCoords;
 
-uniform samplerCube skybox;
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
 
-void main() {    
-    FragColor = texture(skybox, TexCoords);
+// Preetham sky model; each coefficient holds luminance Y and chromaticity x, y
+uniform vec3 perezA;
+uniform vec3 perezB;
+uniform vec3 perezC;
+uniform vec3 perezD;
+uniform vec3 perezE;
+uniform vec3 zenith;        // Zenith Yxy divided by the distribution at the zenith
+uniform float daylight;     // 1 by day, fading to 0 once the sun is below the horizon
+
+const float sunCosRadius = 0.99996; // About half a degree across
+const float exposure = 0.04;
+
+vec3 perez(float cosTheta, float gamma) {
+    float cosGamma = cos(gamma);
+    return (1.0 + perezA * exp(perezB / cosTheta)) * (1.0 + perezC * exp(perezD * gamma) + perezE * cosGamma * cosGamma);
+}
+
+void main() {
+    vec3 direction = normalize(TexCoords);
+
+    // The model is undefined below the horizon, so the ground under it mirrors the horizon sky
+    float cosTheta = max(direction.y, 0.01);
+    float gamma = acos(clamp(dot(direction, sunDirection.xyz), -1.0, 1.0));
+    vec3 Yxy = zenith * perez(cosTheta, gamma);
+
+    // Yxy to XYZ to linear sRGB
+    vec3 XYZ = vec3(Yxy.y / Yxy.z * Yxy.x, Yxy.x, (1.0 - Yxy.y - Yxy.z) / Yxy.z * Yxy.x);
+    vec3 rgb = mat3(3.2406, -0.9689, 0.0557,
+                    -1.5372, 1.8758, -0.2040,
+                    -0.4986, 0.0415, 1.0570) * XYZ;
+
+    // Sun disc, then exposure and gamma; the framebuffer is not sRGB
+    if (dot(direction, sunDirection.xyz) > sunCosRadius && direction.y > 0.0) {
+        rgb += vec3(100.0, 90.0, 70.0);
+    }
+    rgb = vec3(1.0) - exp(-max(rgb, vec3(0.0)) * exposure);
+    rgb = pow(rgb, vec3(1.0 / 2.2));
+
+    // Darken the ground and fade towards a night sky as the sun sets
+    rgb *= mix(0.5, 1.0, smoothstep(-0.1, 0.0, direction.y));
+    rgb = mix(vec3(0.01, 0.015, 0.03), rgb, daylight);
+    FragColor = vec4(rgb, 1.0);
 }
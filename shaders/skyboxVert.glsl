@@ -3,11 +3,11 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
 
 void main() {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0); // Without translation, the sky stays around the camera
     gl_Position = pos.xyww; // This ensures skybox is rendered at maximum depth
 }
@@ -1,37 +1,119 @@
 // terrainFrag.glsl
 #version 410 core
 
+// Permutations, defined by Terrain for the layers it has:
+//   HEATMAP          track density overlay
+//   SNOW             accumulated snow
+//   VIRTUAL_TEXTURE  streamed orthophoto in place of the tiled color texture
+
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+#ifndef VIRTUAL_TEXTURE
 uniform sampler2D terrainTexture;
+#endif
+
+#if defined(HEATMAP) || defined(SNOW)
+// World (x, z) to the texel of the heightmap vertex, shared by the heatmap and snow grids
+uniform vec2 gridScale;
+uniform vec2 gridOffset;
+#endif
+
+#ifdef HEATMAP
+// Track density overlay
+uniform sampler2D heatmapTexture;
+uniform float heatmapMaxDensity;
+uniform float heatmapOpacity;
+#endif
+
+#ifdef SNOW
+// Accumulated snow
+uniform sampler2D snowDepthTexture;
+uniform sampler2D snowTexture;
+uniform float snowFullDepth;
+#endif
+
+#ifdef VIRTUAL_TEXTURE
+// Streamed orthophoto, see VirtualTexture
+uniform sampler2D vtPhysical;
+uniform sampler2D vtIndirection;
+uniform vec2 vtScale;           // World (x, z) to texels of level 0
+uniform vec2 vtOffset;
+uniform float vtPageSize;
+uniform float vtBorder;
+uniform float vtCacheSize;
+uniform int vtMaxLevel;
+#endif
 
 // Material properties
 uniform float shininess;
 
+#ifdef VIRTUAL_TEXTURE
+vec3 sampleVirtualTexture(vec2 texel) {
+    // The level whose texels are about a pixel, rounded towards the finer one
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+    int level = clamp(int(floor(lod)), 0, vtMaxLevel);
+
+    // The indirection names the slot of this page, or of the nearest coarser page already loaded
+    int pagesPerSide = (1 << vtMaxLevel) >> level;
+    ivec2 page = clamp(ivec2(texel / (vtPageSize * exp2(float(level)))), ivec2(0), ivec2(pagesPerSide - 1));
+    vec4 entry = texelFetch(vtIndirection, page, level) * 255.0;
+
+    vec2 levelTexel = texel / exp2(entry.b);
+    vec2 inPage = levelTexel - floor(levelTexel / vtPageSize) * vtPageSize;
+    vec2 physical = entry.rg * (vtPageSize + 2.0 * vtBorder) + vtBorder + inPage;
+    return textureLod(vtPhysical, physical / vtCacheSize, 0.0).rgb;
+}
+#endif
+
 void main() {
-    // Ambient lighting
-    vec3 ambient = vec3(0.3);
+    // Ambient lighting; keeps some sky light when the sun is low or down
+    vec3 ambient = mix(vec3(0.08, 0.09, 0.12), vec3(0.3), clamp(length(lightColor.rgb), 0.0, 1.0));
 
     // Diffuse lighting
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPosition.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * vec3(0.7);
+    vec3 diffuse = diff * 0.7 * lightColor.rgb;
 
     // Specular lighting
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(cameraPosition.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    vec3 specular = spec * vec3(0.2);
+    vec3 specular = spec * 0.2 * lightColor.rgb;
 
     // Texture color
+#ifdef VIRTUAL_TEXTURE
+    vec3 textureColor = sampleVirtualTexture(FragPos.xz * vtScale + vtOffset);
+#else
     vec3 textureColor = texture(terrainTexture, TexCoords).rgb;
+#endif
+#if defined(HEATMAP) || defined(SNOW)
+    vec2 gridCoords = FragPos.xz * gridScale + gridOffset;
+#endif
+
+#ifdef SNOW
+    // Thin snow lets the ground show through, deep snow hides it
+    float snowDepth = texture(snowDepthTexture, gridCoords).r;
+    float cover = smoothstep(0.0, snowFullDepth, snowDepth);
+    textureColor = mix(textureColor, texture(snowTexture, TexCoords).rgb, cover);
+#endif
+
+#ifdef HEATMAP
+    // Blend in the track density; log scale keeps lone tracks visible next to busy trails
+    float density = texture(heatmapTexture, gridCoords).r;
+    float heat = log(1.0 + density) / log(1.0 + heatmapMaxDensity);
+    vec3 heatColor = mix(vec3(0.1, 0.3, 1.0), vec3(1.0, 0.9, 0.1), smoothstep(0.0, 0.6, heat));
+    heatColor = mix(heatColor, vec3(1.0, 0.15, 0.05), smoothstep(0.6, 1.0, heat));
+    textureColor = mix(textureColor, heatColor, heatmapOpacity * smoothstep(0.0, 0.05, heat));
+#endif
 
     // Combine results
     vec3 result = (ambient + diffuse + specular) * textureColor;
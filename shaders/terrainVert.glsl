@@ -9,14 +9,15 @@ out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
     TexCoords = aTexCoords;
 
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+    gl_Position = viewProjection * vec4(FragPos, 1.0);
 }
@@ -0,0 +1,18 @@
+#version 410 core
+
+layout(location = 0) in vec3 aPos;
+
+// Per-frame values, see FrameData in FrameUniforms.h
+#include "frameData.glsl"
+
+uniform mat4 model;
+
+// Interpolated end of the trail, substituted for the edge pair after the last stored one
+uniform int tipIndex;
+uniform vec3 tipLeft;
+uniform vec3 tipRight;
+
+void main() {
+    vec3 position = gl_VertexID == tipIndex ? tipLeft : gl_VertexID == tipIndex + 1 ? tipRight : aPos;
+    gl_Position = viewProjection * model * vec4(position, 1.0);
+}
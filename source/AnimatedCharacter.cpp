@@ -1,14 +1,16 @@
 #include "AnimatedCharacter.h"
+#include "GLStateCache.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <algorithm>
 
 // Constructor
 // In AnimatedCharacter.cpp, modify the constructor:
 AnimatedCharacter::AnimatedCharacter()
     : characterVAO(0), characterVBO(0), characterPosition(0.0f),
-    progress(0.0f), currentPathIndex(0), movingForward(true),
+    movingForward(true),
     movementSpeed(5.0f), // Reduce from 5.0f for smoother movement
-    totalPathLength(0.0f), distanceHiked(0.0f),
+    distanceHiked(0.0f),
     distanceRemaining(0.0f), timeElapsed(0.0f), elevationChange(0.0f) {}
 
 // Destructor
@@ -29,106 +31,129 @@ void AnimatedCharacter::setupCharacterBuffers() {
     glGenVertexArrays(1, &characterVAO);
     glGenBuffers(1, &characterVBO);
 
-    glBindVertexArray(characterVAO);
+    GLStateCache::getInstance().bindVertexArray(characterVAO);
     glBindBuffer(GL_ARRAY_BUFFER, characterVBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 
     std::cout << "INFO: Character buffers initialized." << std::endl;
 }
 
 void AnimatedCharacter::moveForward(float deltaTime) {
-    if (currentPathIndex < pathPoints.size() - 1) {
-        progress += movementSpeed * deltaTime;
-        if (progress >= 1.0f) {
-            progress = 0.0f;
-            currentPathIndex++;
-        }
-    }
+    moveWithinPath(deltaTime);
 }
 
 void AnimatedCharacter::moveBackward(float deltaTime) {
-    if (currentPathIndex > 0) {
-        progress -= movementSpeed * deltaTime;
-        if (progress <= 0.0f) {
-            progress = 1.0f;
-            currentPathIndex--;
-        }
+    moveWithinPath(-deltaTime);
+}
+
+void AnimatedCharacter::moveWithinPath(float deltaTime) {
+    if (!path || path->getSegmentCount() == 0) return;
+
+    // Zero-length segments are stepped over instead of stalling on them
+    size_t segment = cursor.segment;
+    float progress = path->getSegmentLength(segment) > 0.0f
+        ? cursor.getSegmentFraction(*path) + movementSpeed * deltaTime
+        : (deltaTime > 0.0f ? 1.0f : 0.0f);
+
+    if (progress >= 1.0f && segment + 1 < path->getSegmentCount()) {
+        progress = 0.0f;
+        segment++;
     }
+    else if (progress <= 0.0f && segment > 0) {
+        progress = 1.0f;
+        segment--;
+    }
+
+    cursor.moveToSegment(*path, segment, progress);
+    updateHikeStatistics();
 }
 
-// Load path points for the animation
-void AnimatedCharacter::loadPathData(const std::vector<glm::vec3>& path) {
-    pathPoints = path;
-    if (!pathPoints.empty()) {
-        characterPosition = pathPoints[0];
-        totalPathLength = calculatePathLength();
-        elevationChange = calculateElevationChange();
+void AnimatedCharacter::setPath(std::shared_ptr<const PathData> newPath) {
+    path = std::move(newPath);
+    cursor = PathCursor();
+    if (path && path->getPointCount() > 0) {
+        const TrackStatistics& statistics = path->getStatistics();
+        size_t lastPoint = path->getPointCount() - 1;
+        characterPosition = path->getPoints()[0];
+        elevationChange = statistics.isBuilt()
+            ? statistics.getAscent(0, lastPoint) + statistics.getDescent(0, lastPoint)
+            : 0.0f;
         distanceHiked = 0.0f;
-        distanceRemaining = totalPathLength;
+        distanceRemaining = path->getTotalLength();
+        hikeStatistics = TrackStatistics::Interval();
+    }
+    if (characterVAO == 0) {
+        setupCharacterBuffers();
     }
-    setupCharacterBuffers();
 }
 
-float AnimatedCharacter::calculatePathLength() {
-    float length = 0.0f;
-    for (size_t i = 1; i < pathPoints.size(); ++i) {
-        length += glm::distance(pathPoints[i - 1], pathPoints[i]);
-    }
-    return length;
+// Load path points for the animation
+void AnimatedCharacter::loadPathData(const std::vector<glm::vec3>& path, const std::vector<float>& times) {
+    setPath(PathData::create(path, times));
 }
 
-float AnimatedCharacter::calculateElevationChange() {
-    float elevation = 0.0f;
-    for (size_t i = 1; i < pathPoints.size(); ++i) {
-        elevation += abs(pathPoints[i].y - pathPoints[i - 1].y);
-    }
-    return elevation;
+void AnimatedCharacter::updateHikeStatistics() {
+    if (!path || !path->getStatistics().isBuilt()) return;
+
+    // The cursor already holds the distance at the current point plus the covered part of the segment
+    distanceHiked = cursor.distance;
+    distanceRemaining = path->getTotalLength() - distanceHiked;
+
+    hikeStatistics = path->getStatistics().query(0.0f, distanceHiked);
 }
 
 void AnimatedCharacter::updatePosition(float deltaTime, const Terrain& terrain) {
-    if (pathPoints.empty() || currentPathIndex >= pathPoints.size() - 1) return;
+    if (!path || path->getSegmentCount() == 0) return;
 
-    glm::vec3 start = pathPoints[currentPathIndex];
-    glm::vec3 end = pathPoints[currentPathIndex + 1];
+    size_t segment = cursor.segment;
+    float progress = path->getSegmentLength(segment) > 0.0f
+        ? cursor.getSegmentFraction(*path) + movementSpeed * deltaTime
+        : 1.0f;
 
-    progress += movementSpeed * deltaTime;
+    timeElapsed += deltaTime;
 
     if (progress >= 1.0f) {
         progress = 0.0f;
-        currentPathIndex++;
-        if (currentPathIndex >= pathPoints.size() - 1) {
-            currentPathIndex = 0;  // Loop back to start
+        segment++;
+        if (segment >= path->getSegmentCount()) {
+            segment = 0;  // Loop back to start
+            timeElapsed = 0.0f;
         }
     }
 
+    cursor.moveToSegment(*path, segment, progress);
+    updateHikeStatistics();
+
     // Interpolate position along path
-    characterPosition = glm::mix(start, end, progress);
+    characterPosition = cursor.getPosition(*path);
 
     // Ensure character stays above terrain
     float terrainHeight = terrain.getHeightAtPosition(characterPosition.x, characterPosition.z);
     characterPosition.y = terrainHeight + 2.0f;  // Raise character above terrain
 }
 
-void AnimatedCharacter::render(const glm::mat4& view, const glm::mat4& projection, Shader& shader) {
+void AnimatedCharacter::render(Shader& shader) {
+    render(shader, characterPosition);
+}
+
+void AnimatedCharacter::render(Shader& shader, const glm::vec3& position) {
     shader.use();
 
     // Make character more visible
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), characterPosition);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
     model = glm::scale(model, glm::vec3(5.0f)); // Larger size for visibility
 
     shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
 
     // Draw character in bright color
     shader.setVec3("pathColor", glm::vec3(0.0f, 0.0f, 1.0f)); // Blue color
 
-    glBindVertexArray(characterVAO);
+    GLStateCache::getInstance().bindVertexArray(characterVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
 
     // Draw outline for better visibility
@@ -137,23 +162,22 @@ void AnimatedCharacter::render(const glm::mat4& view, const glm::mat4& projectio
     shader.setVec3("pathColor", glm::vec3(1.0f)); // White outline
     glDrawArrays(GL_TRIANGLES, 0, 36);
 
-    glBindVertexArray(0);
 }
 
 // Reset hike stats
 void AnimatedCharacter::resetHike() {
-    currentPathIndex = 0;
-    progress = 0.0f;
+    cursor = PathCursor();
     movingForward = true;
     distanceHiked = 0.0f;
-    distanceRemaining = totalPathLength;
+    distanceRemaining = path ? path->getTotalLength() : 0.0f;
     timeElapsed = 0.0f;
-    characterPosition = pathPoints.empty() ? glm::vec3(0.0f) : pathPoints[0];
+    hikeStatistics = TrackStatistics::Interval();
+    characterPosition = path && path->getPointCount() > 0 ? path->getPoints()[0] : glm::vec3(0.0f);
 }
 
 // Cleanup OpenGL resources
 void AnimatedCharacter::cleanup() {
-    if (characterVAO) glDeleteVertexArrays(1, &characterVAO);
+    if (characterVAO) GLStateCache::getInstance().deleteVertexArray(characterVAO);
     if (characterVBO) glDeleteBuffers(1, &characterVBO);
 
     characterVAO = 0;
@@ -179,6 +203,27 @@ float AnimatedCharacter::getElevationChange() const {
     return elevationChange;
 }
 
+float AnimatedCharacter::getAscent() const {
+    return hikeStatistics.ascent;
+}
+
+float AnimatedCharacter::getDescent() const {
+    return hikeStatistics.descent;
+}
+
+float AnimatedCharacter::getMaxGrade() const {
+    return hikeStatistics.maxGrade;
+}
+
+const TrackStatistics::Interval& AnimatedCharacter::getHikeStatistics() const {
+    return hikeStatistics;
+}
+
+TrackStatistics::Interval AnimatedCharacter::getStatisticsBetween(float fromDistance, float toDistance) const {
+    if (!path) return TrackStatistics::Interval();
+    return path->getStatistics().query(fromDistance, toDistance);
+}
+
 glm::vec3 AnimatedCharacter::getCurrentPosition() const {
     return characterPosition;
 }
@@ -2,28 +2,30 @@
 #define ANIMATED_CHARACTER_H
 
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
+#include "PathData.h"
 #include "Shader.h"
 #include "Terrain.h"
+#include "TrackStatistics.h"
 
 class AnimatedCharacter {
 private:
     GLuint characterVAO, characterVBO;         // OpenGL buffers for the character model
     glm::vec3 characterPosition;               // Current position of the character
-    std::vector<glm::vec3> pathPoints;         // Path points for the animation
-    float progress;                            // Animation progress (0.0 - 1.0)
-    int currentPathIndex;                      // Current index along the path
+    std::shared_ptr<const PathData> path;      // Shared path for the animation
+    PathCursor cursor;                         // Current distance and segment along the path
     bool movingForward;                        // Animation direction (forward or backward)
     float movementSpeed;                       // Speed of character movement
-    float totalPathLength;                     // Total path length
     float distanceHiked;                       // Distance covered
     float distanceRemaining;                   // Distance left to hike
     float timeElapsed;                         // Time since the hike started
     float elevationChange;                     // Total elevation change
+    TrackStatistics::Interval hikeStatistics;  // Statistics from the start to the current position
 
     void setupCharacterBuffers();              // Initialize character buffers
-    float calculatePathLength();               // Helper function to calculate total path length
-    float calculateElevationChange();          // Helper function to calculate total elevation change
+    void updateHikeStatistics();               // Refresh the live statistics in O(log n)
+    void moveWithinPath(float deltaTime);      // Step movementSpeed segments per second, clamped to the ends
 
 public:
     AnimatedCharacter();                       // Constructor
@@ -32,9 +34,11 @@ public:
     void moveForward(float deltaTime);
     void moveBackward(float deltaTime);
 
-    void loadPathData(const std::vector<glm::vec3>& path);  // Load path points
+    void setPath(std::shared_ptr<const PathData> newPath);  // Follow a shared path without copying it
+    void loadPathData(const std::vector<glm::vec3>& path, const std::vector<float>& times = {});  // Load path points and optional timestamps
     void updatePosition(float deltaTime, const Terrain& terrain); // Update character position
-    void render(const glm::mat4& view, const glm::mat4& projection, Shader& shader); // Render the character
+    void render(Shader& shader); // Render the character
+    void render(Shader& shader, const glm::vec3& position); // Render at a snapshot position
     void resetHike();                          // Reset hike stats
     void cleanup();                            // Cleanup OpenGL resources
 
@@ -43,6 +47,11 @@ public:
     float getDistanceRemaining() const;
     float getTimeElapsed() const;
     float getElevationChange() const;
+    float getAscent() const;                   // Climb so far
+    float getDescent() const;                  // Descent so far
+    float getMaxGrade() const;                 // Steepest climb so far
+    const TrackStatistics::Interval& getHikeStatistics() const;
+    TrackStatistics::Interval getStatisticsBetween(float fromDistance, float toDistance) const; // Any stretch, O(log n)
     glm::vec3 getCurrentPosition() const;
 };
 
@@ -0,0 +1,170 @@
+// AssetCache.cpp
+
+#include "AssetCache.h"
+#include "GLStateCache.h"
+#include "TextureBatchLoader.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+
+TextureAsset::~TextureAsset() {
+    if (texture) {
+        GLStateCache::getInstance().deleteTexture(texture);
+    }
+}
+
+/**
+ * @brief Retrieves the singleton instance of the AssetCache.
+ */
+AssetCache& AssetCache::getInstance() {
+    static AssetCache instance;
+    return instance;
+}
+
+AssetCache::AssetCache()
+    : budget(512ull * 1024 * 1024), bytesHeld(0) {}
+
+std::string AssetCache::makeKey(const TextureRequest& request) {
+    std::string key = request.cubemap ? "cube" : "2d:" + std::to_string(request.wrap);
+    for (const std::string& path : request.paths) {
+        // The same file reached through a relative path, an absolute one or "..", maps to one key
+        std::error_code error;
+        std::filesystem::path normalized = std::filesystem::weakly_canonical(path, error);
+        if (error) {
+            normalized = std::filesystem::path(path).lexically_normal();
+        }
+        std::string text = normalized.generic_string();
+#ifdef _WIN32
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+        key += '|';
+        key += text;
+    }
+    return key;
+}
+
+TextureHandle AssetCache::loadTexture(const std::string& path, GLenum wrap) {
+    TextureRequest request;
+    request.paths = { path };
+    request.wrap = wrap;
+    return loadTextures({ request }).front();
+}
+
+TextureHandle AssetCache::loadCubemap(const std::vector<std::string>& faces) {
+    TextureRequest request;
+    request.paths = faces;
+    request.cubemap = true;
+    return loadTextures({ request }).front();
+}
+
+std::vector<TextureHandle> AssetCache::loadTextures(const std::vector<TextureRequest>& requests,
+    const std::function<void()>& whileDecoding) {
+    std::vector<TextureHandle> handles(requests.size());
+    std::vector<std::string> keys(requests.size());
+
+    // Hits are answered straight away; each distinct miss is queued once
+    TextureBatchLoader loader;
+    std::unordered_map<std::string, size_t> queued;  // Key to the first request asking for it
+    std::vector<size_t> loaderIndices(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        keys[i] = makeKey(requests[i]);
+        auto found = entries.find(keys[i]);
+        if (found != entries.end()) {
+            recentKeys.splice(recentKeys.begin(), recentKeys, found->second.recency);
+            handles[i] = found->second.asset;
+            ++statistics.hits;
+            continue;
+        }
+        if (queued.count(keys[i]) == 0) {
+            const TextureRequest& request = requests[i];
+            loaderIndices[i] = request.cubemap ? loader.addCubemap(request.paths) : loader.addTexture(request.paths.front(), request.wrap);
+            queued[keys[i]] = i;
+            ++statistics.misses;
+        }
+        else {
+            ++statistics.hits;
+        }
+    }
+
+    if (queued.empty()) {
+        if (whileDecoding) {
+            whileDecoding();
+        }
+        return handles;
+    }
+
+    loader.start();
+    if (whileDecoding) {
+        whileDecoding();
+    }
+    loader.finish();
+
+    for (const auto& [key, request] : queued) {
+        size_t index = loaderIndices[request];
+        GLuint texture = loader.getTexture(index);
+        if (texture == 0) {
+            continue;
+        }
+        auto asset = std::make_shared<TextureAsset>();
+        asset->texture = texture;
+        asset->target = requests[request].cubemap ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+        asset->channels = loader.getChannels(index);
+        asset->bytes = loader.getBytes(index);
+
+        recentKeys.push_front(key);
+        entries[key] = { asset, recentKeys.begin() };
+        bytesHeld += asset->bytes;
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+        auto found = entries.find(keys[i]);
+        if (!handles[i] && found != entries.end()) {
+            handles[i] = found->second.asset;
+        }
+    }
+
+    trim();
+    return handles;
+}
+
+void AssetCache::trim() {
+    // Walk from the least recently used end, skipping textures someone still holds
+    for (auto it = recentKeys.end(); bytesHeld > budget && it != recentKeys.begin();) {
+        --it;
+        auto found = entries.find(*it);
+        if (found->second.asset.use_count() > 1) {
+            continue;
+        }
+        bytesHeld -= found->second.asset->bytes;
+        entries.erase(found);
+        it = recentKeys.erase(it);
+        ++statistics.evictions;
+    }
+}
+
+void AssetCache::setBudget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+size_t AssetCache::getBudget() const {
+    return budget;
+}
+
+size_t AssetCache::getBytesHeld() const {
+    return bytesHeld;
+}
+
+size_t AssetCache::getAssetCount() const {
+    return entries.size();
+}
+
+const AssetCache::Statistics& AssetCache::getStatistics() const {
+    return statistics;
+}
+
+void AssetCache::clear() {
+    entries.clear();
+    recentKeys.clear();
+    bytesHeld = 0;
+}
@@ -0,0 +1,164 @@
+// AssetCache.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct TextureAsset
+ * @brief A texture owned by the asset cache. The GL texture is deleted with the last handle.
+ */
+struct TextureAsset {
+    GLuint texture = 0;             ///< OpenGL texture ID.
+    GLenum target = GL_TEXTURE_2D;  ///< GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+    int channels = 0;               ///< Channels of the source image.
+    size_t bytes = 0;               ///< Video memory held, mips included.
+
+    TextureAsset() = default;
+    ~TextureAsset();
+    TextureAsset(const TextureAsset&) = delete;
+    TextureAsset& operator=(const TextureAsset&) = delete;
+};
+
+/**
+ * @brief Reference-counted handle to a cached texture.
+ */
+using TextureHandle = std::shared_ptr<const TextureAsset>;
+
+/**
+ * @class AssetCache
+ * @brief Loads each texture once and shares it between everyone who asks for it.
+ *
+ * Textures are keyed by their normalized paths and load parameters, so asking again for a texture
+ * that is already loaded only returns another handle to it. The cache keeps its own reference to
+ * every texture, so one that nobody holds any more stays loaded for the next request. When the
+ * bytes held pass the budget, the least recently used textures that nobody else holds are dropped.
+ * Textures still in use are never dropped, so the budget can be exceeded while they are held.
+ * Must only be used on the thread that owns the GL context.
+ */
+class AssetCache {
+public:
+    /**
+     * @brief One texture to load: a single image, or six cubemap faces.
+     */
+    struct TextureRequest {
+        std::vector<std::string> paths;     ///< One image for a 2D texture, six faces for a cubemap.
+        GLenum wrap = GL_REPEAT;            ///< Wrap mode of 2D textures.
+        bool cubemap = false;               ///< True to load the paths as cubemap faces.
+    };
+
+    /**
+     * @brief Counters since startup.
+     */
+    struct Statistics {
+        size_t hits = 0;                    ///< Requests served from the cache.
+        size_t misses = 0;                  ///< Requests that had to load.
+        size_t evictions = 0;               ///< Textures dropped to stay within the budget.
+    };
+
+    /**
+     * @brief Retrieves the singleton instance of the AssetCache.
+     * @return Reference to the AssetCache instance.
+     */
+    static AssetCache& getInstance();
+
+    /**
+     * @brief Gets a 2D texture, loading it on first use.
+     * @param path Image path.
+     * @param wrap Wrap mode for both axes.
+     * @return Handle to the texture, nullptr if it could not be loaded.
+     */
+    TextureHandle loadTexture(const std::string& path, GLenum wrap = GL_REPEAT);
+
+    /**
+     * @brief Gets a cubemap, loading it on first use.
+     * @param faces Paths to the +X, -X, +Y, -Y, +Z and -Z faces.
+     * @return Handle to the cubemap, nullptr if it could not be loaded.
+     */
+    TextureHandle loadCubemap(const std::vector<std::string>& faces);
+
+    /**
+     * @brief Gets several textures, loading all that are not cached in one parallel batch.
+     * @param requests Textures to get.
+     * @param whileDecoding Optional work to run on this thread while the images decode.
+     * @return One handle per request, nullptr for those that could not be loaded.
+     */
+    std::vector<TextureHandle> loadTextures(const std::vector<TextureRequest>& requests,
+        const std::function<void()>& whileDecoding = nullptr);
+
+    /**
+     * @brief Sets how much video memory cached textures may hold and drops textures past it.
+     * @param bytes Budget in bytes.
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Gets the memory budget.
+     * @return Budget in bytes.
+     */
+    size_t getBudget() const;
+
+    /**
+     * @brief Gets the video memory held by all cached textures.
+     * @return Size in bytes.
+     */
+    size_t getBytesHeld() const;
+
+    /**
+     * @brief Gets the number of cached textures.
+     * @return Texture count.
+     */
+    size_t getAssetCount() const;
+
+    /**
+     * @brief Gets the hit, miss and eviction counters.
+     * @return Counters since startup.
+     */
+    const Statistics& getStatistics() const;
+
+    /**
+     * @brief Drops the cache's references to every texture. Call before the GL context goes away.
+     */
+    void clear();
+
+private:
+    // Private Constructor for Singleton
+    AssetCache();
+
+    // Delete copy constructor and assignment operator
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    /**
+     * @brief A cached texture and its place in the recency order.
+     */
+    struct Entry {
+        std::shared_ptr<TextureAsset> asset;
+        std::list<std::string>::iterator recency;   ///< Position in recentKeys.
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recentKeys;              ///< Keys from most to least recently used.
+    size_t budget;                                  ///< Bytes allowed before textures are dropped.
+    size_t bytesHeld;                               ///< Bytes of all cached textures.
+    Statistics statistics;
+
+    /**
+     * @brief Builds the key of a request from its normalized paths and parameters.
+     * @param request Texture request.
+     * @return Cache key.
+     */
+    static std::string makeKey(const TextureRequest& request);
+
+    /**
+     * @brief Drops least recently used textures nobody holds until the bytes held fit the budget.
+     */
+    void trim();
+};
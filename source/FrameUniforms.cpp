@@ -0,0 +1,36 @@
+// FrameUniforms.cpp
+
+#include "FrameUniforms.h"
+
+FrameUniforms::FrameUniforms()
+    : buffer(0) {}
+
+FrameUniforms::~FrameUniforms() {
+    cleanup();
+}
+
+void FrameUniforms::update(const FrameData& data) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+    }
+    else {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    }
+
+    // One upload replaces the matrices, camera and light every draw used to set by name
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, buffer);
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void FrameUniforms::cleanup() {
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
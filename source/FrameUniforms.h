@@ -0,0 +1,67 @@
+// FrameUniforms.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/**
+ * @struct FrameData
+ * @brief Per-frame values every shader reads from the FrameData uniform block, laid out as std140.
+ *
+ * The GLSL block in shaders/frameData.glsl must declare the same members in the same order. vec3 values are
+ * padded to vec4, as std140 would pad them anyway.
+ */
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 cameraPosition;   ///< xyz world position.
+    glm::vec4 lightPosition;    ///< xyz world position of the sun or the fixed light.
+    glm::vec4 lightColor;       ///< rgb light color, black at night.
+    glm::vec4 sunDirection;     ///< xyz unit vector towards the sun.
+    float time;                 ///< Seconds since startup.
+    float deltaTime;            ///< Seconds since the previous frame.
+    float padding[2];
+};
+
+static_assert(sizeof(FrameData) % 16 == 0, "FrameData must match the std140 block size");
+
+/**
+ * @class FrameUniforms
+ * @brief Uniform buffer holding FrameData, written once per frame and bound for every shader.
+ *
+ * Shader links its programs' FrameData block to BINDING, so draws only set their own uniforms such
+ * as the model matrix and colors.
+ */
+class FrameUniforms {
+public:
+    static const GLuint BINDING = 0;    ///< Uniform buffer binding point of the FrameData block.
+
+    /**
+     * @brief Constructor.
+     */
+    FrameUniforms();
+
+    /**
+     * @brief Destructor.
+     */
+    ~FrameUniforms();
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    /**
+     * @brief Uploads this frame's values and binds the buffer, creating it on first use.
+     * @param data Values for this frame.
+     */
+    void update(const FrameData& data);
+
+    /**
+     * @brief Cleans up OpenGL resources.
+     */
+    void cleanup();
+
+private:
+    GLuint buffer;
+};
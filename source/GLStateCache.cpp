@@ -0,0 +1,146 @@
+// GLStateCache.cpp
+
+#include "GLStateCache.h"
+#include <algorithm>
+
+/**
+ * @brief Retrieves the singleton instance of the GLStateCache.
+ */
+GLStateCache& GLStateCache::getInstance() {
+    static GLStateCache instance;
+    return instance;
+}
+
+GLStateCache::GLStateCache() {
+    invalidate();
+}
+
+void GLStateCache::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    textures2D.fill(UNKNOWN);
+    texturesCube.fill(UNKNOWN);
+    depthTest = UNKNOWN;
+    cullFace = UNKNOWN;
+    blend = UNKNOWN;
+    depthFunc = UNKNOWN;
+    depthMask = UNKNOWN;
+    blendSource = UNKNOWN;
+    blendDestination = UNKNOWN;
+    culledFace = UNKNOWN;
+}
+
+bool GLStateCache::change(GLuint& shadow, GLuint value) {
+    if (shadow == value) {
+        ++statistics.filtered;
+        return false;
+    }
+    shadow = value;
+    ++statistics.issued;
+    return true;
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (change(this->program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray) {
+    if (change(this->vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    GLuint* shadow = nullptr;
+    if (unit < MAX_TEXTURE_UNITS) {
+        shadow = target == GL_TEXTURE_2D ? &textures2D[unit] : target == GL_TEXTURE_CUBE_MAP ? &texturesCube[unit] : nullptr;
+    }
+    if (shadow && *shadow == texture) {
+        ++statistics.filtered;
+        return;
+    }
+
+    if (change(activeUnit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    if (shadow) {
+        *shadow = texture;
+    }
+    ++statistics.issued;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::deleteProgram(GLuint program) {
+    glDeleteProgram(program);
+    // A program deleted while in use stays current until replaced, so its state is unknown rather than 0
+    if (this->program == program) {
+        this->program = UNKNOWN;
+    }
+}
+
+void GLStateCache::deleteVertexArray(GLuint vertexArray) {
+    glDeleteVertexArrays(1, &vertexArray);
+    if (this->vertexArray == vertexArray) {
+        this->vertexArray = 0;
+    }
+}
+
+void GLStateCache::deleteTexture(GLuint texture) {
+    glDeleteTextures(1, &texture);
+    std::replace(textures2D.begin(), textures2D.end(), texture, 0u);
+    std::replace(texturesCube.begin(), texturesCube.end(), texture, 0u);
+}
+
+void GLStateCache::setEnabled(GLenum capability, bool enabled) {
+    GLuint* shadow = capability == GL_DEPTH_TEST ? &depthTest
+        : capability == GL_CULL_FACE ? &cullFace
+        : capability == GL_BLEND ? &blend : nullptr;
+    if (shadow && !change(*shadow, enabled ? 1u : 0u)) {
+        return;
+    }
+    if (!shadow) {
+        ++statistics.issued;
+    }
+    if (enabled) {
+        glEnable(capability);
+    }
+    else {
+        glDisable(capability);
+    }
+}
+
+void GLStateCache::setDepthFunc(GLenum function) {
+    if (change(depthFunc, function)) {
+        glDepthFunc(function);
+    }
+}
+
+void GLStateCache::setDepthMask(bool write) {
+    if (change(depthMask, write ? 1u : 0u)) {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GLStateCache::setBlendFunc(GLenum source, GLenum destination) {
+    if (blendSource == source && blendDestination == destination) {
+        ++statistics.filtered;
+        return;
+    }
+    blendSource = source;
+    blendDestination = destination;
+    ++statistics.issued;
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::setCullFace(GLenum face) {
+    if (change(culledFace, face)) {
+        glCullFace(face);
+    }
+}
+
+const GLStateCache::Statistics& GLStateCache::getStatistics() const {
+    return statistics;
+}
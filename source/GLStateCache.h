@@ -0,0 +1,142 @@
+// GLStateCache.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cstddef>
+
+/**
+ * @class GLStateCache
+ * @brief Shadows the GL state set while drawing and drops calls that would not change it.
+ *
+ * Covers the current program, vertex array, active texture unit, 2D and cubemap bindings of the
+ * first MAX_TEXTURE_UNITS units, the depth test, face culling, blending, depth function, depth
+ * mask, blend function and culled face. Everything that binds, sets or deletes these has to go
+ * through the cache, or the shadow copy goes stale. State starts unknown, so the first call of
+ * each kind always reaches the driver. invalidate() forgets everything; calling it once per frame
+ * bounds the damage of any call made behind the cache's back. Must only be used on the thread that
+ * owns the GL context.
+ */
+class GLStateCache {
+public:
+    static const GLuint MAX_TEXTURE_UNITS = 16;    ///< Texture units shadowed; higher ones pass straight through.
+
+    /**
+     * @brief Calls issued and dropped since startup.
+     */
+    struct Statistics {
+        size_t issued = 0;      ///< Calls that reached the driver.
+        size_t filtered = 0;    ///< Calls dropped because they would have changed nothing.
+    };
+
+    /**
+     * @brief Retrieves the singleton instance of the GLStateCache.
+     * @return Reference to the GLStateCache instance.
+     */
+    static GLStateCache& getInstance();
+
+    /**
+     * @brief Forgets the shadowed state, so the next call of each kind reaches the driver.
+     */
+    void invalidate();
+
+    /**
+     * @brief glUseProgram.
+     * @param program Program ID, 0 for none.
+     */
+    void useProgram(GLuint program);
+
+    /**
+     * @brief glBindVertexArray.
+     * @param vertexArray Vertex array ID, 0 for none.
+     */
+    void bindVertexArray(GLuint vertexArray);
+
+    /**
+     * @brief glActiveTexture and glBindTexture, the former only when the unit changes.
+     * @param unit Texture unit index, not GL_TEXTURE0 based.
+     * @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP; other targets are not filtered.
+     * @param texture Texture ID, 0 to unbind.
+     */
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    /**
+     * @brief glDeleteProgram. The shadow is cleared, since a new program may get the same name.
+     */
+    void deleteProgram(GLuint program);
+
+    /**
+     * @brief glDeleteVertexArrays for one array, which GL unbinds if it is bound.
+     */
+    void deleteVertexArray(GLuint vertexArray);
+
+    /**
+     * @brief glDeleteTextures for one texture, which GL unbinds from every unit it is bound to.
+     */
+    void deleteTexture(GLuint texture);
+
+    /**
+     * @brief glEnable or glDisable.
+     * @param capability GL_DEPTH_TEST, GL_CULL_FACE or GL_BLEND; others are not filtered.
+     * @param enabled True to enable.
+     */
+    void setEnabled(GLenum capability, bool enabled);
+
+    /**
+     * @brief glDepthFunc.
+     */
+    void setDepthFunc(GLenum function);
+
+    /**
+     * @brief glDepthMask.
+     */
+    void setDepthMask(bool write);
+
+    /**
+     * @brief glBlendFunc.
+     */
+    void setBlendFunc(GLenum source, GLenum destination);
+
+    /**
+     * @brief glCullFace.
+     */
+    void setCullFace(GLenum face);
+
+    /**
+     * @brief Gets the issued and filtered counters.
+     * @return Counters since startup.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+    // Private Constructor for Singleton
+    GLStateCache();
+
+    // Delete copy constructor and assignment operator
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;     ///< Shadow value of state not yet set through the cache.
+
+    /**
+     * @brief Counts a call and tells if it has to be issued.
+     * @return True if the shadowed value differs, after storing the new one in it.
+     */
+    bool change(GLuint& shadow, GLuint value);
+
+    GLuint program;
+    GLuint vertexArray;
+    GLuint activeUnit;
+    std::array<GLuint, MAX_TEXTURE_UNITS> textures2D;
+    std::array<GLuint, MAX_TEXTURE_UNITS> texturesCube;
+    GLuint depthTest;
+    GLuint cullFace;
+    GLuint blend;
+    GLuint depthFunc;
+    GLuint depthMask;
+    GLuint blendSource;
+    GLuint blendDestination;
+    GLuint culledFace;
+    Statistics statistics;
+};
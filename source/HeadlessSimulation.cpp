@@ -0,0 +1,300 @@
+// HeadlessSimulation.cpp
+
+#include "HeadlessSimulation.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    void appendNumber(std::string& text, double value, int precision) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, precision);
+        text.append(buffer, result.ptr);
+    }
+
+    bool parseFloat(const char* text, float& value) {
+        const char* end = text + std::strlen(text);
+        auto result = std::from_chars(text, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    // Step counts are derived from these by division and cast to integers, so zero, negative and infinite values are rejected
+    bool parsePositiveFloat(const char* text, float& value) {
+        return parseFloat(text, value) && std::isfinite(value) && value > 0.0f;
+    }
+
+    // Quoted as RFC 4180 asks when the field would otherwise break the row
+    void appendCsvField(std::string& text, const std::string& field) {
+        if (field.find_first_of(",\"\r\n") == std::string::npos) {
+            text += field;
+            return;
+        }
+        text += '"';
+        for (char c : field) {
+            if (c == '"') {
+                text += '"';
+            }
+            text += c;
+        }
+        text += '"';
+    }
+}
+
+bool HeadlessSimulation::parseArguments(int argc, char** argv, Settings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--headless") {
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "ERROR::HEADLESS::MISSING_VALUE: " << option << std::endl;
+            return false;
+        }
+
+        const char* value = argv[++i];
+        bool valid = true;
+        if (option == "--heightmap") {
+            settings.heightmapFile = value;
+        }
+        else if (option == "--tracks") {
+            // An archive is reopened as is; anything else is treated as a directory to import
+            std::string path = value;
+            bool isArchive = path.size() >= 4 && path.compare(path.size() - 4, 4, ".pak") == 0;
+            settings.trackArchive = isArchive ? path : "";
+            settings.trackDirectory = isArchive ? "" : path;
+        }
+        else if (option == "--telemetry") {
+            settings.telemetryFile = value;
+        }
+        else if (option == "--step") {
+            valid = parsePositiveFloat(value, settings.stepSeconds);
+        }
+        else if (option == "--interval") {
+            valid = parsePositiveFloat(value, settings.telemetryInterval);
+        }
+        else if (option == "--hours") {
+            valid = parsePositiveFloat(value, settings.maxHours);
+        }
+        else {
+            std::cerr << "ERROR::HEADLESS::UNKNOWN_OPTION: " << option << std::endl;
+            return false;
+        }
+
+        if (!valid) {
+            std::cerr << "ERROR::HEADLESS::INVALID_VALUE: " << option << " " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+float HeadlessSimulation::toblerSpeed(float grade) {
+    // 6 km/h * e^(-3.5 |grade + 0.05|), fastest on a slight descent
+    return (6.0f / 3.6f) * std::exp(-3.5f * std::abs(grade + 0.05f));
+}
+
+bool HeadlessSimulation::load(const Settings& settings) {
+    this->settings = settings;
+    tracks.clear();
+    trackNames.clear();
+    segmentGrades.clear();
+    segmentSpeeds.clear();
+
+    terrain.setHeightScale(settings.heightScale);
+    terrain.setHorizontalScale(settings.horizontalScale);
+    if (!terrain.loadHeightmap(settings.heightmapFile, false)) {
+        std::cerr << "ERROR::HEADLESS::FAILED_TO_LOAD_HEIGHTMAP: " << settings.heightmapFile << std::endl;
+        return false;
+    }
+
+    bool tracksLoaded = (!settings.trackArchive.empty() && library.openArchive(settings.trackArchive, settings.trackDirectory)) ||
+        (!settings.trackDirectory.empty() && library.importDirectory(settings.trackDirectory));
+    if (!tracksLoaded) {
+        std::cerr << "ERROR::HEADLESS::NO_TRACKS" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < library.getTrackCount(); ++i) {
+        TrackLibrary::TrackView track = library.getTrack(i);
+        addTrack(track.getPoints(), std::string(track.name));
+    }
+    if (tracks.empty()) {
+        std::cerr << "ERROR::HEADLESS::NO_USABLE_TRACKS" << std::endl;
+        return false;
+    }
+
+    cursors.assign(tracks.size(), PathCursor());
+    finishTimes.assign(tracks.size(), -1.0f);
+
+    std::cout << "INFO: Headless simulation loaded " << tracks.size() << " tracks on a "
+        << terrain.getWidth() << " x " << terrain.getHeight() << " terrain." << std::endl;
+    return true;
+}
+
+void HeadlessSimulation::addTrack(std::vector<glm::vec3> points, std::string name) {
+    if (points.size() < 2) {
+        return;
+    }
+
+    // Same placement as the interactive hiker: scaled, clamped to the terrain and draped over it
+    float halfWidth = terrain.getWidth() * terrain.getHorizontalScale() * 0.5f;
+    float halfDepth = terrain.getHeight() * terrain.getHorizontalScale() * 0.5f;
+    for (glm::vec3& point : points) {
+        point.x = glm::clamp(point.x * settings.horizontalScale, -halfWidth, halfWidth);
+        point.z = glm::clamp(point.z * settings.horizontalScale, -halfDepth, halfDepth);
+        point.y = terrain.getHeightAtPosition(point.x, point.z);
+    }
+
+    std::shared_ptr<const PathData> path = PathData::create(std::move(points));
+    if (path->getTotalLength() <= 0.0f) {
+        return;
+    }
+
+    const std::vector<glm::vec3>& placed = path->getPoints();
+    std::vector<float> grades(path->getSegmentCount());
+    std::vector<float> speeds(path->getSegmentCount());
+    for (size_t s = 0; s < grades.size(); ++s) {
+        float run = glm::length(glm::vec2(placed[s + 1].x - placed[s].x, placed[s + 1].z - placed[s].z));
+        grades[s] = run > 0.0f ? (placed[s + 1].y - placed[s].y) / run : 0.0f;
+        speeds[s] = toblerSpeed(grades[s]);
+    }
+
+    tracks.push_back(std::move(path));
+    trackNames.push_back(std::move(name));
+    segmentGrades.push_back(std::move(grades));
+    segmentSpeeds.push_back(std::move(speeds));
+}
+
+void HeadlessSimulation::stepHiker(size_t hiker, float startTime) {
+    const PathData& track = *tracks[hiker];
+    const std::vector<float>& distances = track.getCumulativeDistances();
+    const std::vector<float>& speeds = segmentSpeeds[hiker];
+    PathCursor& cursor = cursors[hiker];
+
+    // Walk segment by segment so every stretch is covered at its own pace
+    float remaining = settings.stepSeconds;
+    while (remaining > 0.0f) {
+        size_t segment = cursor.segment;
+        float speed = speeds[segment];
+        float segmentTime = (distances[segment + 1] - cursor.distance) / speed;
+
+        if (segmentTime > remaining) {
+            cursor.distance += speed * remaining;
+            return;
+        }
+
+        remaining -= segmentTime;
+        cursor.distance = distances[segment + 1];
+        if (segment + 1 == track.getSegmentCount()) {
+            finishTimes[hiker] = startTime + settings.stepSeconds - remaining;
+            return;
+        }
+        cursor.segment = static_cast<uint32_t>(segment + 1);
+    }
+}
+
+void HeadlessSimulation::appendTelemetry(size_t hiker, double time, std::string& text) const {
+    const PathCursor& cursor = cursors[hiker];
+    glm::vec3 position = cursor.getPosition(*tracks[hiker]);
+
+    appendNumber(text, time, 1);
+    text += ',';
+    appendCsvField(text, trackNames[hiker]);
+    text += ',';
+    appendNumber(text, cursor.distance, 2);
+    text += ',';
+    appendNumber(text, position.x, 2);
+    text += ',';
+    appendNumber(text, position.y, 2);
+    text += ',';
+    appendNumber(text, position.z, 2);
+    text += ',';
+    appendNumber(text, segmentSpeeds[hiker][cursor.segment], 3);
+    text += ',';
+    appendNumber(text, segmentGrades[hiker][cursor.segment], 4);
+    text += '\n';
+}
+
+bool HeadlessSimulation::run(Result& result) {
+    result = Result();
+    result.hikerCount = tracks.size();
+
+    std::ofstream telemetry(settings.telemetryFile, std::ios::binary);
+    if (!telemetry.is_open()) {
+        std::cerr << "ERROR::HEADLESS::FAILED_TO_OPEN_TELEMETRY_FILE: " << settings.telemetryFile << std::endl;
+        return false;
+    }
+    telemetry << "time,track,distance,x,y,z,speed,grade\n";
+
+    // Fixed chunks written in order keep the telemetry identical however many workers there are
+    ThreadPool& pool = ThreadPool::getInstance();
+    size_t chunkCount = std::min(tracks.size(), (pool.getThreadCount() + 1) * 4);
+    std::vector<std::string> chunkText(chunkCount);
+    std::vector<size_t> chunkRows(chunkCount);
+    std::vector<size_t> chunkFinished(chunkCount);
+
+    uint64_t maxSteps = static_cast<uint64_t>(std::ceil(settings.maxHours * 3600.0f / settings.stepSeconds));
+    uint64_t stepsPerRow = std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(settings.telemetryInterval / settings.stepSeconds)));
+    size_t walking = tracks.size();
+
+    auto wallStart = std::chrono::steady_clock::now();
+    for (uint64_t step = 0; step < maxSteps && walking > 0; ++step) {
+        float startTime = static_cast<float>(step * static_cast<double>(settings.stepSeconds));
+        double endTime = (step + 1) * static_cast<double>(settings.stepSeconds);
+        bool writeRows = (step + 1) % stepsPerRow == 0;
+
+        pool.parallelFor(chunkCount, [&](size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; ++chunk) {
+                size_t first = chunk * tracks.size() / chunkCount;
+                size_t last = (chunk + 1) * tracks.size() / chunkCount;
+                std::string& text = chunkText[chunk];
+                text.clear();
+                chunkRows[chunk] = 0;
+                chunkFinished[chunk] = 0;
+
+                for (size_t hiker = first; hiker < last; ++hiker) {
+                    if (finishTimes[hiker] >= 0.0f) {
+                        continue;
+                    }
+                    stepHiker(hiker, startTime);
+
+                    // A hiker's last row is written on the step it finishes
+                    bool finished = finishTimes[hiker] >= 0.0f;
+                    chunkFinished[chunk] += finished ? 1 : 0;
+                    if (writeRows || finished) {
+                        appendTelemetry(hiker, finished ? finishTimes[hiker] : endTime, text);
+                        ++chunkRows[chunk];
+                    }
+                }
+            }
+        });
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            telemetry.write(chunkText[chunk].data(), static_cast<std::streamsize>(chunkText[chunk].size()));
+            result.telemetryRows += chunkRows[chunk];
+            walking -= chunkFinished[chunk];
+        }
+        result.stepCount = step + 1;
+    }
+    telemetry.close();
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    result.simulatedSeconds = result.stepCount * static_cast<double>(settings.stepSeconds);
+    for (float finishTime : finishTimes) {
+        result.finishedCount += finishTime >= 0.0f ? 1 : 0;
+        result.hikerSeconds += finishTime >= 0.0f ? finishTime : result.simulatedSeconds;
+    }
+
+    double wallSeconds = std::max(result.wallSeconds, 1e-9);
+    std::cout << "INFO: Headless simulation walked " << result.finishedCount << " of " << result.hikerCount
+        << " tracks in " << result.stepCount << " steps (" << result.simulatedSeconds / 3600.0 << " simulated hours) in "
+        << result.wallSeconds << " s: " << result.simulatedSeconds / 3600.0 / wallSeconds << " simulated hours/s, "
+        << result.hikerSeconds / 3600.0 / wallSeconds << " hiker-hours/s, "
+        << result.telemetryRows << " telemetry rows." << std::endl;
+    return true;
+}
@@ -0,0 +1,119 @@
+// HeadlessSimulation.h
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PathData.h"
+#include "Terrain.h"
+#include "TrackLibrary.h"
+
+/**
+ * @class HeadlessSimulation
+ * @brief Walks hikers over every library track without a window or GL context, for batch studies.
+ *
+ * Each track gets one hiker that walks it once from start to end at the pace given by Tobler's
+ * hiking function for the grade of the segment it is on. Steps run back to back as fast as the CPU
+ * allows, spread over the thread pool, and a CSV row per walking hiker is written every
+ * telemetry interval of simulated time.
+ */
+class HeadlessSimulation {
+public:
+    /**
+     * @brief Inputs and limits of a run.
+     */
+    struct Settings {
+        std::string heightmapFile = "data/terrain.png";   ///< Heightmap the tracks are draped over.
+        std::string trackArchive = "data/tracks.pak";     ///< Packed tracks, tried first.
+        std::string trackDirectory = "data/";             ///< Imported when the archive cannot be opened or is out of date with it.
+        std::string telemetryFile = "telemetry.csv";      ///< CSV output.
+        float heightScale = 50.0f;                        ///< Terrain height scale.
+        float horizontalScale = 1.0f;                     ///< Terrain and track horizontal scale.
+        float stepSeconds = 1.0f;                         ///< Fixed simulated timestep.
+        float telemetryInterval = 10.0f;                  ///< Simulated seconds between telemetry rows.
+        float maxHours = 48.0f;                           ///< Simulated time after which the run stops.
+    };
+
+    /**
+     * @brief Summary of a finished run.
+     */
+    struct Result {
+        size_t hikerCount = 0;          ///< Hikers simulated, one per usable track.
+        size_t finishedCount = 0;       ///< Hikers that reached the end of their track.
+        uint64_t stepCount = 0;         ///< Steps simulated.
+        double simulatedSeconds = 0.0;  ///< Simulated clock at the end of the run.
+        double hikerSeconds = 0.0;      ///< Walking time summed over all hikers.
+        double wallSeconds = 0.0;       ///< Real time spent stepping and writing telemetry.
+        size_t telemetryRows = 0;       ///< Rows written to the telemetry file.
+    };
+
+    /**
+     * @brief Reads headless options from the command line.
+     * Recognises --heightmap, --tracks, --telemetry, --step, --interval and --hours, each followed by a value.
+     * @param argc Argument count.
+     * @param argv Arguments.
+     * @param settings Settings to overwrite.
+     * @return False if a value is missing or not a number.
+     */
+    static bool parseArguments(int argc, char** argv, Settings& settings);
+
+    /**
+     * @brief Walking speed from Tobler's hiking function.
+     * @param grade Rise over run of the ground walked on.
+     * @return Speed in metres per second, 1.4 on flat ground.
+     */
+    static float toblerSpeed(float grade);
+
+    /**
+     * @brief Loads the terrain heights and the tracks and places one hiker at the start of each track.
+     * @param settings Inputs of the run.
+     * @return True if the terrain and at least one track were loaded.
+     */
+    bool load(const Settings& settings);
+
+    /**
+     * @brief Steps until every hiker has finished or the time limit is reached, writing telemetry.
+     * @param result Receives the run summary.
+     * @return False if the telemetry file could not be written.
+     */
+    bool run(Result& result);
+
+private:
+    Settings settings;
+    Terrain terrain;
+    TrackLibrary library;
+
+    // Per track
+    std::vector<std::shared_ptr<const PathData>> tracks;  ///< Tracks placed on the terrain.
+    std::vector<std::string> trackNames;                  ///< Library file name of each track.
+    std::vector<std::vector<float>> segmentGrades;        ///< Rise over run of each segment.
+    std::vector<std::vector<float>> segmentSpeeds;        ///< Tobler speed on each segment.
+
+    // Per hiker, one per track
+    std::vector<PathCursor> cursors;                      ///< Position along the track.
+    std::vector<float> finishTimes;                       ///< Simulated time the end was reached, negative while walking.
+
+    /**
+     * @brief Places a library track on the terrain and precomputes its grades and speeds.
+     * @param points Track points in the library frame.
+     * @param name Track name used in the telemetry.
+     */
+    void addTrack(std::vector<glm::vec3> points, std::string name);
+
+    /**
+     * @brief Advances one hiker by one step, crossing as many segments as the step covers.
+     * @param hiker Hiker index.
+     * @param startTime Simulated time at the start of the step.
+     */
+    void stepHiker(size_t hiker, float startTime);
+
+    /**
+     * @brief Appends the telemetry row of one hiker.
+     * @param hiker Hiker index.
+     * @param time Simulated time of the row.
+     * @param text Output buffer.
+     */
+    void appendTelemetry(size_t hiker, double time, std::string& text) const;
+};
@@ -1,6 +1,8 @@
 // Hiker.cpp
 
 #include "Hiker.h"
+#include "GLStateCache.h"
+#include "TrackLibrary.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <fstream>
@@ -8,10 +10,9 @@
 
 Hiker::Hiker(const std::string& pathFile)
     : terrainRef(nullptr), pathFile(pathFile),
-    totalPathLength(0.0f), currentDistance(0.0f), currentSegmentIndex(0),
-    speed(5.0f), horizontalScale(1.0f), heightScale(1.0f),
-    position(glm::vec3(0.0f)), pathVAO(0), pathVBO(0),
-    movingForward(true)
+    speed(5.0f), replayTime(0.0f), playbackRate(1.0f), scrubbing(false),
+    movingForward(true), horizontalScale(1.0f), heightScale(1.0f),
+    position(glm::vec3(0.0f)), pathVAO(0), pathVBO(0), pathWidth(2.0f)
 {
 }
 
@@ -29,6 +30,10 @@ void Hiker::setSpeed(float newSpeed) {
     speed = newSpeed;
 }
 
+void Hiker::setPathWidth(float width) {
+    pathWidth = width;
+}
+
 void Hiker::setTerrain(const Terrain* terrain) {
     terrainRef = terrain;
 }
@@ -41,41 +46,53 @@ bool Hiker::loadPathData(const Terrain& terrain) {
     }
 
     float x, y, z;
-    pathPoints.clear();
+    std::vector<glm::vec3> points;
 
     // Load path points from file
     while (file >> x >> y >> z) {
-        pathPoints.emplace_back(x, y, z);
+        points.emplace_back(x, y, z);
     }
     file.close();
 
-    if (pathPoints.empty()) {
+    return loadPathData(points, terrain);
+}
+
+bool Hiker::loadPathData(const std::vector<glm::vec3>& points, const Terrain& terrain) {
+    if (points.empty()) {
         std::cerr << "ERROR::HIKER::NO_PATH_POINTS_LOADED" << std::endl;
         return false;
     }
 
     // Validate and adjust the path points against the terrain
-    validatePath(terrain);
+    std::vector<glm::vec3> validatedPoints = points;
+    validatePath(validatedPoints, terrain);
 
-    // Calculate segment distances and total path length
-    calculateSegmentDistances();
+    // Segment distances and bounds are computed once; timestamps belong to the previous path, if any
+    path = PathData::create(std::move(validatedPoints));
 
-    position = pathPoints[0];
-    currentDistance = 0.0f;
-    currentSegmentIndex = 0;
+    position = path->getPoints()[0];
+    cursor = PathCursor();
+    trailCursor = PathCursor();
+    replayTime = 0.0f;
 
     // Setup OpenGL buffers for rendering the path
     setupPathVAO();
 
-    return true;
-}
+    // Drape the trail over the terrain; the line strip stays as a fallback
+    pathRibbon.build(path->getPoints(), terrain, pathWidth, 0.5f);
 
-void Hiker::validatePath(const Terrain& terrain) {
-    if (pathPoints.empty()) return;
+    // The walked trail fills in from the ribbon's samples as the hiker goes, so it starts empty
+    if (pathRibbon.isBuilt()) {
+        walkedTrail.initialize(pathRibbon.getSampleParameters().size());
+    }
+    else {
+        walkedTrail.cleanup();
+    }
 
-    std::vector<glm::vec3> validatedPath;
-    validatedPath.reserve(pathPoints.size());
+    return true;
+}
 
+void Hiker::validatePath(std::vector<glm::vec3>& points, const Terrain& terrain) const {
     float terrainWidth = terrain.getWidth() * terrain.getHorizontalScale();
     float terrainDepth = terrain.getHeight() * terrain.getHorizontalScale();
     float minX = -terrainWidth * 0.5f;
@@ -84,33 +101,18 @@ void Hiker::validatePath(const Terrain& terrain) {
     float maxZ = terrainDepth * 0.5f;
 
     // Scale and adjust points
-    for (auto& point : pathPoints) {
+    for (auto& point : points) {
         point.x = glm::clamp(point.x * horizontalScale, minX, maxX);
         point.z = glm::clamp(point.z * horizontalScale, minZ, maxZ);
         float terrainHeight = terrain.getHeightAtPosition(point.x, point.z);
         point.y = terrainHeight + 0.5f; // Small offset above terrain
-        validatedPath.push_back(point);
-    }
-
-    pathPoints = std::move(validatedPath);
-}
-
-void Hiker::calculateSegmentDistances() {
-    segmentDistances.clear();
-    segmentDistances.push_back(0.0f);
-    totalPathLength = 0.0f;
-
-    for (size_t i = 1; i < pathPoints.size(); ++i) {
-        float segmentLength = glm::distance(pathPoints[i - 1], pathPoints[i]);
-        totalPathLength += segmentLength;
-        segmentDistances.push_back(totalPathLength);
     }
 }
 
 void Hiker::setupPathVAO() {
     // Cleanup previous buffers if any
     if (pathVAO != 0) {
-        glDeleteVertexArrays(1, &pathVAO);
+        GLStateCache::getInstance().deleteVertexArray(pathVAO);
         glDeleteBuffers(1, &pathVBO);
     }
 
@@ -118,67 +120,91 @@ void Hiker::setupPathVAO() {
     glGenVertexArrays(1, &pathVAO);
     glGenBuffers(1, &pathVBO);
 
-    glBindVertexArray(pathVAO);
+    GLStateCache::getInstance().bindVertexArray(pathVAO);
     glBindBuffer(GL_ARRAY_BUFFER, pathVBO);
-    glBufferData(GL_ARRAY_BUFFER, pathPoints.size() * sizeof(glm::vec3), pathPoints.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, path->getPointCount() * sizeof(glm::vec3), path->getPoints().data(), GL_STATIC_DRAW);
 
     // Vertex attribute setup
     glEnableVertexAttribArray(0); // Position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
 
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 }
 
 void Hiker::updatePosition(float deltaTime, const Terrain& terrain) {
+    if (scrubbing || !hasPath()) {
+        return;
+    }
+
+    if (hasTimestamps()) {
+        // Replay the recording at its own pace, bouncing at both ends
+        float timeToMove = playbackRate * deltaTime;
+        float totalDuration = path->getTotalDuration();
+
+        if (movingForward) {
+            replayTime += timeToMove;
+            if (replayTime >= totalDuration) {
+                replayTime = totalDuration;
+                movingForward = false;
+            }
+        }
+        else {
+            replayTime -= timeToMove;
+            if (replayTime <= 0.0f) {
+                replayTime = 0.0f;
+                movingForward = true;
+            }
+        }
+
+        placeAtDistance(path->distanceAtTime(replayTime), &terrain);
+        return;
+    }
+
     // Advance along the path based on speed and deltaTime
     float distanceToMove = speed * deltaTime;
+    float totalPathLength = path->getTotalLength();
+    float distance = cursor.distance + distanceToMove;
 
-    currentDistance += distanceToMove;
-
-    if (currentDistance >= totalPathLength) {
-        currentDistance = 0.0f; // Reset to start for looping
-        currentSegmentIndex = 0;
+    if (distance >= totalPathLength) {
+        distance = 0.0f; // Reset to start for looping
     }
 
     if (movingForward) {
-        currentDistance += distanceToMove;
-        if (currentDistance >= totalPathLength) {
-            currentDistance = totalPathLength;
+        distance += distanceToMove;
+        if (distance >= totalPathLength) {
+            distance = totalPathLength;
             movingForward = false; // Change direction or stop at the end
         }
     }
     else {
-        currentDistance -= distanceToMove;
-        if (currentDistance <= 0.0f) {
-            currentDistance = 0.0f;
+        distance -= distanceToMove;
+        if (distance <= 0.0f) {
+            distance = 0.0f;
             movingForward = true; // Change direction or stop at the start
         }
     }
 
-    // Find the segment of the path we're currently on
-    while (currentSegmentIndex < segmentDistances.size() - 1 &&
-        currentDistance > segmentDistances[currentSegmentIndex + 1]) {
-        currentSegmentIndex++;
-    }
-    while (currentSegmentIndex > 0 &&
-        currentDistance < segmentDistances[currentSegmentIndex]) {
-        currentSegmentIndex--;
-    }
+    placeAtDistance(distance, &terrain);
+}
+
+bool Hiker::hasPath() const {
+    return path && path->getSegmentCount() > 0;
+}
 
-    // Calculate the interpolation factor 't' for the current segment
-    float segmentStartDistance = segmentDistances[currentSegmentIndex];
-    float segmentEndDistance = segmentDistances[currentSegmentIndex + 1];
-    float segmentLength = segmentEndDistance - segmentStartDistance;
-    float t = (currentDistance - segmentStartDistance) / segmentLength;
+void Hiker::placeAtDistance(float distance, const Terrain* terrain) {
+    if (!hasPath()) {
+        return;
+    }
 
-    // Interpolate between the start and end points of the segment
-    glm::vec3 startPoint = pathPoints[currentSegmentIndex];
-    glm::vec3 endPoint = pathPoints[currentSegmentIndex + 1];
-    glm::vec3 interpolatedPosition = glm::mix(startPoint, endPoint, t);
+    // The cursor finds the segment, usually without searching, and interpolates on it
+    cursor.moveTo(*path, distance);
+    glm::vec3 interpolatedPosition = cursor.getPosition(*path);
 
     // Get the terrain height at the current (X, Z) position
-    float terrainHeight = terrain.getHeightAtPosition(interpolatedPosition.x, interpolatedPosition.z);
-    interpolatedPosition.y = terrainHeight + 0.5f; // Small offset above terrain
+    if (terrain) {
+        float terrainHeight = terrain->getHeightAtPosition(interpolatedPosition.x, interpolatedPosition.z);
+        interpolatedPosition.y = terrainHeight + 0.5f; // Small offset above terrain
+    }
 
     // Update the hiker's position
     position = interpolatedPosition;
@@ -199,45 +225,222 @@ void Hiker::moveBackward(float deltaTime) {
 }
 
 void Hiker::resetPath() {
-    currentDistance = 0.0f;
-    currentSegmentIndex = 0;
+    cursor = PathCursor();
+    replayTime = 0.0f;
     movingForward = true;
-    if (!pathPoints.empty()) {
-        position = pathPoints[0];
+    if (path && path->getPointCount() > 0) {
+        position = path->getPoints()[0];
     }
 }
 
 const std::vector<glm::vec3>& Hiker::getPathPoints() const {
-    return pathPoints;
+    static const std::vector<glm::vec3> noPoints;
+    return path ? path->getPoints() : noPoints;
+}
+
+std::shared_ptr<const PathData> Hiker::getPathData() const {
+    return path;
+}
+
+bool Hiker::loadTimestamps(const std::string& gpxFile) {
+    std::ifstream file(gpxFile);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::HIKER::FAILED_TO_OPEN_GPX_FILE: " << gpxFile << std::endl;
+        return false;
+    }
+
+    // Only <time> elements inside <trkpt> belong to points; the one in <metadata> does not
+    std::vector<double> absoluteTimes;
+    absoluteTimes.reserve(path ? path->getPointCount() : 0);
+    bool insideTrackPoint = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find("<trkpt") != std::string::npos) {
+            insideTrackPoint = true;
+        }
+
+        size_t timeStart = line.find("<time>");
+        if (insideTrackPoint && timeStart != std::string::npos) {
+            size_t valueStart = timeStart + 6;
+            size_t valueEnd = line.find("</time>", valueStart);
+            double seconds;
+            if (valueEnd != std::string::npos &&
+                TrackLibrary::parseIsoTimestamp(line.substr(valueStart, valueEnd - valueStart), seconds)) {
+                absoluteTimes.push_back(seconds);
+            }
+        }
+
+        if (line.find("</trkpt>") != std::string::npos) {
+            insideTrackPoint = false;
+        }
+    }
+    file.close();
+
+    if (absoluteTimes.empty()) {
+        std::cerr << "ERROR::HIKER::NO_TIMESTAMPS_IN_GPX_FILE: " << gpxFile << std::endl;
+        return false;
+    }
+
+    // Store as offsets from the first point
+    std::vector<float> times(absoluteTimes.size());
+    for (size_t i = 0; i < absoluteTimes.size(); ++i) {
+        times[i] = static_cast<float>(absoluteTimes[i] - absoluteTimes[0]);
+    }
+    return setTimestamps(times);
+}
+
+bool Hiker::setTimestamps(const std::vector<float>& times) {
+    size_t pointCount = path ? path->getPointCount() : 0;
+    if (times.size() != pointCount || pointCount < 2) {
+        std::cerr << "ERROR::HIKER::TIMESTAMP_COUNT_MISMATCH: " << times.size()
+            << " timestamps for " << pointCount << " path points" << std::endl;
+        return false;
+    }
+
+    // The path is immutable, so it is rebuilt with the times; movers holding the old one keep it
+    path = PathData::create(path->getPoints(), times);
+    replayTime = path->timeAtDistance(cursor.distance, cursor.segment);
+
+    std::cout << "INFO: Loaded " << times.size() << " timestamps spanning "
+        << path->getTotalDuration() << " seconds." << std::endl;
+    return true;
+}
+
+const std::vector<float>& Hiker::getPointTimes() const {
+    static const std::vector<float> noTimes;
+    return path ? path->getTimes() : noTimes;
+}
+
+bool Hiker::hasTimestamps() const {
+    return path && path->hasTimes();
 }
 
-void Hiker::renderPath(const glm::mat4& view, const glm::mat4& projection, Shader& shader) {
+void Hiker::seekToDistance(float distance) {
+    if (!hasPath()) {
+        return;
+    }
+
+    placeAtDistance(distance, terrainRef);
+    if (hasTimestamps()) {
+        replayTime = path->timeAtDistance(cursor.distance, cursor.segment);
+    }
+}
+
+void Hiker::seekToTime(float time) {
+    if (!hasPath()) {
+        return;
+    }
+
+    if (!hasTimestamps()) {
+        seekToDistance(time * speed);
+        return;
+    }
+
+    replayTime = glm::clamp(time, 0.0f, path->getTotalDuration());
+    placeAtDistance(path->distanceAtTime(replayTime), terrainRef);
+}
+
+void Hiker::setScrubbing(bool enabled) {
+    scrubbing = enabled;
+}
+
+bool Hiker::isScrubbing() const {
+    return scrubbing;
+}
+
+void Hiker::setPlaybackRate(float rate) {
+    playbackRate = rate;
+}
+
+float Hiker::getCurrentDistance() const {
+    return cursor.distance;
+}
+
+float Hiker::getCurrentTime() const {
+    if (hasTimestamps()) {
+        return replayTime;
+    }
+    return speed > 0.0f ? cursor.distance / speed : 0.0f;
+}
+
+float Hiker::getTotalPathLength() const {
+    return path ? path->getTotalLength() : 0.0f;
+}
+
+float Hiker::getTotalDuration() const {
+    return path ? path->getTotalDuration() : 0.0f;
+}
+
+void Hiker::renderPath(Shader& shader) {
     shader.use();
     shader.setMat4("model", glm::mat4(1.0f));
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
 
     // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
+    GLStateCache::getInstance().setEnabled(GL_DEPTH_TEST, true);
 
-    // Draw the path
-    glLineWidth(2.0f);
+    // Draw the path as one terrain-following strip; its width does not depend on glLineWidth limits
     shader.setVec3("pathColor", glm::vec3(1.0f, 0.0f, 0.0f));
-    glBindVertexArray(pathVAO);
-    glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(pathPoints.size()));
+    if (pathRibbon.isBuilt()) {
+        // Pushed back a little, so the walked trail drawn along the same surface wins the depth test
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+        pathRibbon.render();
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        return;
+    }
+
+    GLStateCache::getInstance().bindVertexArray(pathVAO);
+    glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(path ? path->getPointCount() : 0));
+}
+
+void Hiker::renderWalkedTrail(Shader& shader, float distance) {
+    if (!hasPath() || !pathRibbon.isBuilt()) {
+        return;
+    }
+
+    // The render thread keeps its own cursor; the simulation one may be moving under it
+    trailCursor.moveTo(*path, distance);
+    float parameter = static_cast<float>(trailCursor.segment) + trailCursor.getSegmentFraction(*path);
+
+    // Ribbon samples are only ever appended; seeking back just draws a shorter prefix
+    const std::vector<float>& parameters = pathRibbon.getSampleParameters();
+    const std::vector<glm::vec3>& edges = pathRibbon.getVertices();
+    size_t reached = std::upper_bound(parameters.begin(), parameters.end(), parameter) - parameters.begin();
+    reached = std::max<size_t>(reached, 1);
+    while (walkedTrail.getAppendedCount() < reached) {
+        size_t sample = walkedTrail.getAppendedCount();
+        walkedTrail.append(edges[sample * 2], edges[sample * 2 + 1]);
+    }
+
+    shader.use();
+    shader.setVec3("pathColor", glm::vec3(1.0f, 0.85f, 0.1f));
+    if (reached == parameters.size()) {
+        walkedTrail.render(shader, reached);
+        return;
+    }
 
-    glLineWidth(1.0f);
-    glBindVertexArray(0);
+    // End the trail at the hiker, between the last reached sample and the next
+    size_t last = reached - 1;
+    float fraction = (parameter - parameters[last]) / (parameters[reached] - parameters[last]);
+    glm::vec3 tip[2] = {
+        glm::mix(edges[last * 2], edges[reached * 2], fraction),
+        glm::mix(edges[last * 2 + 1], edges[reached * 2 + 1], fraction)
+    };
+    walkedTrail.render(shader, reached, tip);
 }
 
 void Hiker::cleanup() {
     if (pathVAO != 0) {
-        glDeleteVertexArrays(1, &pathVAO);
+        GLStateCache::getInstance().deleteVertexArray(pathVAO);
         glDeleteBuffers(1, &pathVBO);
         pathVAO = 0;
         pathVBO = 0;
     }
-    pathPoints.clear();
+    pathRibbon.cleanup();
+    walkedTrail.cleanup();
+    path.reset();
+    cursor = PathCursor();
+    trailCursor = PathCursor();
 }
 
 glm::vec3 Hiker::getPosition() const {
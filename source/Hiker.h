@@ -3,10 +3,14 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include <string>
+#include "PathData.h"
 #include "Shader.h"
 #include "Terrain.h"
+#include "TrailRibbon.h"
+#include "TrailBuffer.h"
 
 /**
  * @brief Class representing a hiker moving along a path on the terrain.
@@ -33,6 +37,12 @@ public:
      */
     void setSpeed(float newSpeed);
 
+    /**
+     * @brief Sets the width of the rendered trail ribbon. Takes effect on the next loadPathData.
+     * @param width Ribbon width in world units.
+     */
+    void setPathWidth(float width);
+
     /**
      * @brief Loads path data from the file and validates it against the terrain.
      * @param terrain Reference to the terrain object.
@@ -40,6 +50,14 @@ public:
      */
     bool loadPathData(const Terrain& terrain);
 
+    /**
+     * @brief Loads path data from points already in memory, such as a track library entry.
+     * @param points Path points in the same frame as the path file.
+     * @param terrain Reference to the terrain object.
+     * @return True if the path data was loaded successfully, false otherwise.
+     */
+    bool loadPathData(const std::vector<glm::vec3>& points, const Terrain& terrain);
+
     /**
      * @brief Updates the hiker's position based on deltaTime.
      * @param deltaTime Time elapsed since the last update.
@@ -49,11 +67,18 @@ public:
 
     /**
      * @brief Renders the hiker's path.
-     * @param view View matrix.
-     * @param projection Projection matrix.
      * @param shader Shader used for rendering the path.
      */
-    void renderPath(const glm::mat4& view, const glm::mat4& projection, Shader& shader);
+    void renderPath(Shader& shader);
+
+    /**
+     * @brief Renders the part of the path ribbon walked so far, ending exactly at the hiker.
+     * Ribbon samples are appended to the trail buffer as the hiker first reaches them. Draws
+     * nothing if the path has no ribbon.
+     * @param shader Shader built from trailVert.glsl.
+     * @param distance Distance along the path to end at, from a simulation snapshot.
+     */
+    void renderWalkedTrail(Shader& shader, float distance);
 
     /**
      * @brief Cleans up OpenGL resources.
@@ -95,18 +120,105 @@ public:
      */
     const std::vector<glm::vec3>& getPathPoints() const;
 
+    /**
+     * @brief Gets the shared path, for other movers to follow without copying it.
+     * @return Immutable path, or nullptr before loadPathData.
+     */
+    std::shared_ptr<const PathData> getPathData() const;
+
+    /**
+     * @brief Loads the recorded timestamp of every path point from a GPX file.
+     * @param gpxFile Path to the GPX file the path was exported from.
+     * @return True if exactly one timestamp was read per path point, false otherwise.
+     */
+    bool loadTimestamps(const std::string& gpxFile);
+
+    /**
+     * @brief Sets the recorded time of every path point.
+     * @param times Seconds since the first point, one per path point.
+     * @return True if the count matched the path, false otherwise.
+     */
+    bool setTimestamps(const std::vector<float>& times);
+
+    /**
+     * @brief Gets the recorded time of each path point.
+     * @return Seconds since the first point, empty without timestamps.
+     */
+    const std::vector<float>& getPointTimes() const;
+
+    /**
+     * @brief Checks if recorded timestamps are available for replay.
+     * @return True if timestamps were loaded for the current path.
+     */
+    bool hasTimestamps() const;
+
+    /**
+     * @brief Jumps the hiker to a distance along the path in O(log n).
+     * @param distance Distance from the start of the path, clamped to the path length.
+     */
+    void seekToDistance(float distance);
+
+    /**
+     * @brief Jumps the hiker to a recorded time in O(log n).
+     * Without timestamps the time is converted to distance using the constant speed.
+     * @param time Seconds since the first recorded point.
+     */
+    void seekToTime(float time);
+
+    /**
+     * @brief Enables or disables scrubbing. While scrubbing, updatePosition does not advance the hiker.
+     * @param enabled True to enter scrubbing mode.
+     */
+    void setScrubbing(bool enabled);
+
+    /**
+     * @brief Checks if the hiker is in scrubbing mode.
+     * @return True if scrubbing.
+     */
+    bool isScrubbing() const;
+
+    /**
+     * @brief Sets how many recorded seconds are replayed per real second.
+     * @param rate Playback rate multiplier.
+     */
+    void setPlaybackRate(float rate);
+
+    /**
+     * @brief Gets the current distance along the path.
+     * @return Distance from the start of the path.
+     */
+    float getCurrentDistance() const;
+
+    /**
+     * @brief Gets the current replay time.
+     * @return Seconds since the first recorded point.
+     */
+    float getCurrentTime() const;
+
+    /**
+     * @brief Gets the length of the path.
+     * @return Total path length.
+     */
+    float getTotalPathLength() const;
+
+    /**
+     * @brief Gets the recorded duration of the path.
+     * @return Seconds between the first and last point, or 0 without timestamps.
+     */
+    float getTotalDuration() const;
+
 private:
     // References
     const Terrain* terrainRef;    ///< Pointer to the terrain object.
 
     // Path data
     std::string pathFile;                 ///< Path to the file containing path data.
-    std::vector<glm::vec3> pathPoints;    ///< List of points representing the path.
-    std::vector<float> segmentDistances;  ///< Cumulative distances along the path.
-    float totalPathLength;                ///< Total length of the path.
-    float currentDistance;                ///< Current distance along the path.
-    int currentSegmentIndex;              ///< Current segment index.
+    std::shared_ptr<const PathData> path; ///< Validated path points, distances and timestamps.
+    PathCursor cursor;                    ///< Current distance and segment along the path.
     float speed;                          ///< Hiker's speed along the path.
+    float replayTime;                     ///< Current replay time when timestamps are available.
+    float playbackRate;                   ///< Recorded seconds replayed per real second.
+    bool scrubbing;                       ///< True while the hiker is positioned by seeking only.
 
     bool movingForward;                   ///< Direction of movement
 
@@ -120,9 +232,14 @@ private:
     // OpenGL resources
     GLuint pathVAO;                       ///< Vertex Array Object for the path.
     GLuint pathVBO;                       ///< Vertex Buffer Object for the path.
+    TrailRibbon pathRibbon;               ///< Terrain-draped mesh drawn instead of the line strip.
+    float pathWidth;                      ///< Width of the trail ribbon.
+    TrailBuffer walkedTrail;              ///< Ribbon samples reached so far, appended as the hiker walks.
+    PathCursor trailCursor;               ///< End of the walked trail, owned by the render thread.
 
     // Helper functions
-    void validatePath(const Terrain& terrain);
+    void validatePath(std::vector<glm::vec3>& points, const Terrain& terrain) const;
     void setupPathVAO();
-    void calculateSegmentDistances();
+    bool hasPath() const;
+    void placeAtDistance(float distance, const Terrain* terrain);
 };
@@ -0,0 +1,207 @@
+// HikerCrowd.cpp
+
+#include "HikerCrowd.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+
+HikerCrowd::HikerCrowd()
+    : VAO(0), cubeVBO(0), instanceVBO(0), instanceCapacity(0) {}
+
+HikerCrowd::~HikerCrowd() {
+    cleanup();
+}
+
+int HikerCrowd::addTrack(const std::vector<glm::vec3>& pathPoints) {
+    if (pathPoints.size() < 2) {
+        std::cerr << "ERROR::CROWD::TRACK_TOO_SHORT" << std::endl;
+        return -1;
+    }
+
+    return addTrack(PathData::create(pathPoints));
+}
+
+int HikerCrowd::addTrack(std::shared_ptr<const PathData> path) {
+    if (!path || path->getSegmentCount() == 0) {
+        std::cerr << "ERROR::CROWD::TRACK_TOO_SHORT" << std::endl;
+        return -1;
+    }
+
+    if (path->getTotalLength() <= 0.0f) {
+        std::cerr << "ERROR::CROWD::TRACK_HAS_ZERO_LENGTH" << std::endl;
+        return -1;
+    }
+
+    tracks.push_back(std::move(path));
+    return static_cast<int>(tracks.size()) - 1;
+}
+
+void HikerCrowd::spawn(size_t count, unsigned int seed) {
+    trackIds.clear();
+    cursors.clear();
+    speeds.clear();
+    positions.clear();
+
+    if (tracks.empty()) {
+        std::cerr << "ERROR::CROWD::NO_TRACKS" << std::endl;
+        return;
+    }
+
+    trackIds.resize(count);
+    cursors.resize(count);
+    speeds.resize(count);
+    positions.resize(count);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> walkingSpeed(1.0f, 3.0f);
+    for (size_t i = 0; i < count; ++i) {
+        trackIds[i] = static_cast<uint32_t>(i % tracks.size());
+        const PathData& track = *tracks[trackIds[i]];
+        cursors[i].moveTo(track, unit(random) * track.getTotalLength());
+        speeds[i] = walkingSpeed(random);
+        positions[i] = track.getPoints()[0];
+    }
+
+    if (VAO == 0) {
+        setupBuffers();
+    }
+
+    std::cout << "INFO: Spawned crowd of " << count << " hikers over " << tracks.size() << " tracks." << std::endl;
+}
+
+void HikerCrowd::setupBuffers() {
+    // Unit cube standing on the ground
+    float cubeVertices[] = {
+        -0.5f, 0.0f, -0.5f,   0.5f, 0.0f, -0.5f,   0.5f, 1.0f, -0.5f,
+         0.5f, 1.0f, -0.5f,  -0.5f, 1.0f, -0.5f,  -0.5f, 0.0f, -0.5f,
+
+        -0.5f, 0.0f,  0.5f,   0.5f, 0.0f,  0.5f,   0.5f, 1.0f,  0.5f,
+         0.5f, 1.0f,  0.5f,  -0.5f, 1.0f,  0.5f,  -0.5f, 0.0f,  0.5f,
+
+        -0.5f, 1.0f,  0.5f,  -0.5f, 1.0f, -0.5f,  -0.5f, 0.0f, -0.5f,
+        -0.5f, 0.0f, -0.5f,  -0.5f, 0.0f,  0.5f,  -0.5f, 1.0f,  0.5f,
+
+         0.5f, 1.0f,  0.5f,   0.5f, 1.0f, -0.5f,   0.5f, 0.0f, -0.5f,
+         0.5f, 0.0f, -0.5f,   0.5f, 0.0f,  0.5f,   0.5f, 1.0f,  0.5f,
+
+        -0.5f, 0.0f, -0.5f,   0.5f, 0.0f, -0.5f,   0.5f, 0.0f,  0.5f,
+         0.5f, 0.0f,  0.5f,  -0.5f, 0.0f,  0.5f,  -0.5f, 0.0f, -0.5f,
+
+        -0.5f, 1.0f, -0.5f,   0.5f, 1.0f, -0.5f,   0.5f, 1.0f,  0.5f,
+         0.5f, 1.0f,  0.5f,  -0.5f, 1.0f,  0.5f,  -0.5f, 1.0f, -0.5f
+    };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &cubeVBO);
+    glGenBuffers(1, &instanceVBO);
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+
+    // Position attribute
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+
+    // Instance offset attribute, advanced once per hiker
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glVertexAttribDivisor(1, 1);
+
+    GLStateCache::getInstance().bindVertexArray(0);
+}
+
+void HikerCrowd::update(float deltaTime, const Terrain& terrain) {
+    size_t count = trackIds.size();
+
+    ThreadPool::getInstance().parallelFor(count, [&](size_t begin, size_t end) {
+        std::vector<glm::vec2> groundPositions(end - begin);
+        std::vector<float> groundHeights(end - begin);
+
+        for (size_t i = begin; i < end; ++i) {
+            const PathData& track = *tracks[trackIds[i]];
+            PathCursor& cursor = cursors[i];
+
+            // Loop back to the start of the track at the end
+            float distance = cursor.distance + speeds[i] * deltaTime;
+            if (distance >= track.getTotalLength()) {
+                distance = std::fmod(distance, track.getTotalLength());
+                cursor.segment = 0;
+            }
+
+            // Hikers move a fraction of a segment per frame, so the cursor rarely has to search
+            cursor.moveTo(track, distance);
+            glm::vec3 position = cursor.getPosition(track);
+
+            positions[i] = position;
+            groundPositions[i - begin] = glm::vec2(position.x, position.z);
+        }
+
+        // Snap the whole chunk to the terrain in one batch
+        terrain.getHeightsAtPositions(groundPositions.data(), groundPositions.size(), groundHeights.data());
+        for (size_t i = begin; i < end; ++i) {
+            positions[i].y = groundHeights[i - begin] + 0.5f;
+        }
+    });
+}
+
+void HikerCrowd::render(Shader& shader) {
+    render(shader, positions);
+}
+
+void HikerCrowd::render(Shader& shader, const std::vector<glm::vec3>& instancePositions) {
+    if (instancePositions.empty() || VAO == 0) return;
+
+    shader.use();
+    shader.setFloat("scale", 2.0f);
+    shader.setVec3("pathColor", glm::vec3(1.0f, 0.6f, 0.0f));
+
+    // Orphan the instance buffer so the driver never waits on last frame's draw
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instancePositions.size() > instanceCapacity) {
+        instanceCapacity = instancePositions.size();
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(glm::vec3), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instancePositions.size() * sizeof(glm::vec3), instancePositions.data());
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<GLsizei>(instancePositions.size()));
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void HikerCrowd::cleanup() {
+    if (VAO) {
+        GLStateCache::getInstance().deleteVertexArray(VAO);
+        VAO = 0;
+    }
+    if (cubeVBO) {
+        glDeleteBuffers(1, &cubeVBO);
+        cubeVBO = 0;
+    }
+    if (instanceVBO) {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+    instanceCapacity = 0;
+
+    tracks.clear();
+    trackIds.clear();
+    cursors.clear();
+    speeds.clear();
+    positions.clear();
+}
+
+size_t HikerCrowd::getHikerCount() const {
+    return trackIds.size();
+}
+
+const std::vector<glm::vec3>& HikerCrowd::getPositions() const {
+    return positions;
+}
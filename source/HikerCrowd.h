@@ -0,0 +1,111 @@
+// HikerCrowd.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "PathData.h"
+#include "Shader.h"
+#include "Terrain.h"
+
+/**
+ * @class HikerCrowd
+ * @brief Thousands of hikers looping over recorded tracks, updated in parallel and drawn with one instanced call.
+ *
+ * Hiker state is kept as one array per field so the update streams through memory
+ * and the positions array can be uploaded as the instance buffer without repacking.
+ * Tracks are shared PathData, so a hiker costs a cursor, a speed and a position however long its track is.
+ */
+class HikerCrowd {
+public:
+    /**
+     * @brief Constructor.
+     */
+    HikerCrowd();
+
+    /**
+     * @brief Destructor that cleans up OpenGL resources.
+     */
+    ~HikerCrowd();
+
+    /**
+     * @brief Adds a track that hikers can replay.
+     * @param pathPoints Track points in world space.
+     * @return Track id, or -1 if the track has fewer than two points or zero length.
+     */
+    int addTrack(const std::vector<glm::vec3>& pathPoints);
+
+    /**
+     * @brief Adds a path that hikers can replay, shared with its other users rather than copied.
+     * @param path Shared path in world space.
+     * @return Track id, or -1 if the path has fewer than two points or zero length.
+     */
+    int addTrack(std::shared_ptr<const PathData> path);
+
+    /**
+     * @brief Replaces the crowd with hikers spread over all tracks at random distances and speeds.
+     * @param count Number of hikers.
+     * @param seed Seed for the random start distances and speeds.
+     */
+    void spawn(size_t count, unsigned int seed);
+
+    /**
+     * @brief Advances every hiker along its track and snaps it to the terrain.
+     * @param deltaTime Time elapsed since the last update.
+     * @param terrain Reference to the terrain object.
+     */
+    void update(float deltaTime, const Terrain& terrain);
+
+    /**
+     * @brief Renders all hikers with a single instanced draw call.
+     * @param shader Shader taking a per-instance offset at attribute location 1.
+     */
+    void render(Shader& shader);
+
+    /**
+     * @brief Renders hikers at the given positions, such as a simulation snapshot, with a single instanced draw call.
+     * @param shader Shader taking a per-instance offset at attribute location 1.
+     * @param instancePositions One position per hiker to draw.
+     */
+    void render(Shader& shader, const std::vector<glm::vec3>& instancePositions);
+
+    /**
+     * @brief Cleans up OpenGL resources and removes all hikers and tracks.
+     */
+    void cleanup();
+
+    /**
+     * @brief Gets the number of hikers.
+     * @return Hiker count.
+     */
+    size_t getHikerCount() const;
+
+    /**
+     * @brief Gets the hiker positions, one per hiker.
+     * @return Reference to the positions array.
+     */
+    const std::vector<glm::vec3>& getPositions() const;
+
+private:
+    std::vector<std::shared_ptr<const PathData>> tracks;  ///< Tracks available to the crowd.
+
+    // Hiker state, structure of arrays
+    std::vector<uint32_t> trackIds;         ///< Track each hiker replays.
+    std::vector<PathCursor> cursors;        ///< Distance and segment along the track.
+    std::vector<float> speeds;              ///< Walking speed.
+    std::vector<glm::vec3> positions;       ///< World position, also the instance data.
+
+    // OpenGL resources
+    GLuint VAO;                             ///< Vertex Array Object with the cube and instance attributes.
+    GLuint cubeVBO;                         ///< Cube vertices shared by all instances.
+    GLuint instanceVBO;                     ///< Per-frame instance positions.
+    size_t instanceCapacity;                ///< Number of positions the instance buffer holds.
+
+    /**
+     * @brief Creates the cube and instance buffers.
+     */
+    void setupBuffers();
+};
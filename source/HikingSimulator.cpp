@@ -1,7 +1,11 @@
 #include "HikingSimulator.h"
 #include "Skybox.h"
+#include "AssetCache.h"
+#include "GLStateCache.h"
+#include "ProgramCache.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
+#include <filesystem>
 #include <iostream>
 #include <cmath>
 
@@ -41,12 +45,41 @@ void HikingSimulator::setWindowDimensions(int width, int height) {
 bool HikingSimulator::initialize() {
     std::cout << "INFO: Initializing HikingSimulator..." << std::endl;
 
+    // Every program is submitted here and compiles while the data below loads; each one is only
+    // waited on when it is first checked or used
+    Shader::setAsyncBuild(true);
+    terrainShader = std::make_unique<ShaderVariants>("A:/Taief/semProVR/shaders/terrainVert.glsl", "A:/Taief/semProVR/shaders/terrainFrag.glsl",
+        Terrain::getShaderDefines());
+    terrainShader->get(Terrain::FEATURE_HEATMAP | Terrain::FEATURE_SNOW);   // The layers set up below, unless one fails
+    pathShader = std::make_unique<Shader>("A:/Taief/semProVR/shaders/pathVert.glsl", "A:/Taief/semProVR/shaders/pathFrag.glsl");
+    trailShader = std::make_unique<Shader>("A:/Taief/semProVR/shaders/trailVert.glsl", "A:/Taief/semProVR/shaders/pathFrag.glsl");
+    crowdShader = std::make_unique<Shader>("A:/Taief/semProVR/shaders/crowdVert.glsl", "A:/Taief/semProVR/shaders/pathFrag.glsl");
+    Skybox& skybox = Skybox::getInstance();
+
+    // Every texture decodes on the workers while the heightmap loads here
+    AssetCache::TextureRequest terrainColor, snowfall;
+    terrainColor.paths = { "A:/Taief/semProVR/textures/Terrain/Terrain005_1K_Color.png" };
+    snowfall.paths = { "textures/Terrain/Terrain005_1K_Snowfall.png" };
+
+    bool heightmapLoaded = false;
+    std::vector<TextureHandle> textures = AssetCache::getInstance().loadTextures({ terrainColor, snowfall },
+        [&]() { heightmapLoaded = terrain.loadHeightmap("data/terrain_heightmap.png"); });
+
     // Load terrain heightmap
-    if (!terrain.loadHeightmap("data/terrain_heightmap.png")) {
+    if (!heightmapLoaded) {
         std::cerr << "ERROR: Failed to load terrain heightmap" << std::endl;
         return false;
     }
 
+    snowfallTexture = textures[1];
+    terrain.setTexture(textures[0]);
+    if (!textures[0]) {
+        std::cerr << "ERROR: Failed to load terrain texture" << std::endl;
+        return false;
+    }
+
+    terrain.setShader(terrainShader.get());
+
     // Set scales and terrain reference for the hiker
     hiker.setScales(1.0f);
     hiker.setTerrain(&terrain);
@@ -65,15 +98,26 @@ bool HikingSimulator::initialize() {
 
     hiker.setScales(terrain.getHorizontalScale(), terrain.getHeightScale());
 
-    // Initialize skybox
-    Skybox& skybox = Skybox::getInstance();
-    if (!skybox.initialize("textures/skybox/")) {
+    // Initialize skybox; the sky and the terrain share the sun from here on
+    lighting.setTimeOfDay(timeOfDay);
+    if (!skybox.initialize()) {
         std::cerr << "ERROR: Failed to initialize skybox!" << std::endl;
         return false;
     }
 
-    // Load hiker path data
-    if (!hiker.loadPathData(terrain)) {
+    // Reopen the packed track archive, or ingest the data directory and pack it for next time when any track file changed
+    const std::string trackDirectory = "A:/Taief/semProVR/data/";
+    const std::string trackArchive = trackDirectory + "tracks.pak";
+    if (!trackLibrary.openArchive(trackArchive, trackDirectory) && trackLibrary.importDirectory(trackDirectory)) {
+        trackLibrary.writeArchive(trackArchive);
+    }
+
+    // Load hiker path data, from the library when it holds the hiker's track
+    int hikerTrack = trackLibrary.findTrack("Afternoon_Run3.txt");
+    bool pathLoaded = hikerTrack >= 0
+        ? hiker.loadPathData(trackLibrary.getTrack(hikerTrack).getPoints(), terrain)
+        : hiker.loadPathData(terrain);
+    if (!pathLoaded) {
         std::cerr << "ERROR: Failed to load hiker path!" << std::endl;
         return false;
     }
@@ -81,22 +125,102 @@ bool HikingSimulator::initialize() {
         std::cout << "INFO: Hiker path loaded successfully." << std::endl;
     }
 
-    // Load shaders
-    pathShader = std::make_unique<Shader>("A:/Taief/semProVR/shaders/pathVert.glsl", "A:/Taief/semProVR/shaders/pathFrag.glsl");
+    // Index the path segments so picks and snapping never scan every point
+    trackIndex.clear();
+    trackIndex.addTrack(hiker.getPathPoints());
+    trackIndex.build();
+
+    // Recorded timestamps drive real-time replay; without them the hiker falls back to constant speed
+    int timedTrack = trackLibrary.findTrack("Afternoon_Run.gpx");
+    bool timesLoaded = timedTrack >= 0
+        ? hiker.setTimestamps(trackLibrary.getTrack(timedTrack).getTimes())
+        : hiker.loadTimestamps("A:/Taief/semProVR/data/Afternoon_Run.gpx");
+    if (!timesLoaded) {
+        std::cerr << "WARNING: No timestamps for hiker path, replaying at constant speed." << std::endl;
+    }
+
+    // Check the path shaders submitted at the start
     if (!pathShader || !pathShader->isLoaded()) {
         std::cerr << "ERROR: Failed to load path shader during initialization." << std::endl;
         return false;
     }
 
+    if (!trailShader || !trailShader->isLoaded()) {
+        std::cerr << "ERROR: Failed to load trail shader during initialization." << std::endl;
+        return false;
+    }
+
     // Initialize seasonal effect
     seasonalEffect.initialize(SeasonalEffect::Season::NONE);
     setupMatrices();
 
-    // Load animated character path data
-    animatedCharacter.loadPathData(hiker.getPathPoints());
+    // The animated character follows the hiker's path without copying it
+    animatedCharacter.setPath(hiker.getPathData());
+
+    // Crowd replaying the loaded track in both directions
+    if (!crowdShader || !crowdShader->isLoaded()) {
+        std::cerr << "ERROR: Failed to load crowd shader during initialization." << std::endl;
+        return false;
+    }
+    std::vector<glm::vec3> reversedPath(hiker.getPathPoints().rbegin(), hiker.getPathPoints().rend());
+    crowd.addTrack(hiker.getPathData());
+    crowd.addTrack(reversedPath);
+    crowd.spawn(1000, 1234u);
+
+    // Density of every library track over the terrain; library tracks share the hiker path frame
+    if (trackHeatmap.initialize(terrain)) {
+        std::vector<std::vector<glm::vec3>> heatmapTracks;
+        for (size_t i = 0; i < trackLibrary.getTrackCount(); ++i) {
+            std::vector<glm::vec3> track = trackLibrary.getTrack(i).getPoints();
+            for (glm::vec3& point : track) {
+                point.x *= terrain.getHorizontalScale();
+                point.z *= terrain.getHorizontalScale();
+            }
+            heatmapTracks.push_back(std::move(track));
+        }
+        if (heatmapTracks.empty()) {
+            heatmapTracks.push_back(hiker.getPathPoints());
+        }
+
+        trackHeatmap.addTracks(heatmapTracks);
+        trackHeatmap.upload();
+        terrain.setHeatmap(trackHeatmap.getTexture(), trackHeatmap.getMaxDensity());
+    }
+
+    // Aerial imagery, when a page file has been built for it, streams in over the whole terrain
+    const std::string orthophotoFile = "data/orthophoto.vtex";
+    if (std::filesystem::exists(orthophotoFile) && orthophoto.open(orthophotoFile)) {
+        glm::vec3 boundsMin, boundsMax;
+        terrain.getBounds(boundsMin, boundsMax);
+        orthophoto.setBounds(boundsMin, boundsMax);
+        terrain.setVirtualTexture(&orthophoto);
+    }
+
+    // Snow builds up on the terrain while the season is snow and melts away otherwise
+    if (snowCover.initialize(terrain, SnowAccumulation::Settings())) {
+        terrain.setSnow(snowCover.getTexture(), snowfallTexture ? snowfallTexture->texture : 0, snowCover.getSettings().maxDepth * 0.5f);
+    }
+
+    // The permutation for the layers that came up; other ones build when a layer changes
+    if (!terrainShader->get(terrain.getShaderFeatures()).isLoaded()) {
+        std::cerr << "ERROR: Failed to load terrain shader during initialization." << std::endl;
+        return false;
+    }
+
+    // Permutations built later are needed by the frame that asks for them, so deferring would only move the wait
+    Shader::setAsyncBuild(false);
+
+    // Movers advance on the simulation thread from here on; rendering only reads its snapshots
+    simulation.start(simulationStep,
+        [this](float stepSeconds) { stepSimulation(stepSeconds); },
+        [this](SimulationSnapshot& snapshot) { captureSnapshot(snapshot); });
 
     lastFrameTime = static_cast<float>(glfwGetTime());
 
+    const ProgramCache::Statistics& programs = ProgramCache::getInstance().getStatistics();
+    std::cout << "INFO: Program cache: " << programs.hits << " hits, " << programs.misses << " misses, "
+        << programs.rejected << " rejected" << std::endl;
+
     std::cout << "INFO: HikingSimulator initialized successfully." << std::endl;
     return true;
 }
@@ -130,7 +254,7 @@ void HikingSimulator::updateViewMatrix() {
         break;
     }
     case CameraMode::FOLLOW: {
-        glm::vec3 hikerPos = hiker.getPosition();
+        glm::vec3 hikerPos = frameState.hikerPosition;
         float cameraHeight = maxTerrainHeight * 0.2f;
         float cameraDistance = 50.0f;
 
@@ -140,7 +264,7 @@ void HikingSimulator::updateViewMatrix() {
         break;
     }
     case CameraMode::FIRST_PERSON: {
-        glm::vec3 hikerPos = hiker.getPosition();
+        glm::vec3 hikerPos = frameState.hikerPosition;
         cameraPosition = hikerPos + glm::vec3(0.0f, 2.0f, 0.0f);
         viewMatrix = glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
         break;
@@ -184,17 +308,16 @@ void HikingSimulator::processInput(GLFWwindow* window) {
         updateViewMatrix();
     }
 
-    // Movement controls
+    // Movement controls; W/S are held states the simulation applies once per step
+    int direction = 0;
     if (cameraMode != CameraMode::OVERVIEW) {
         float moveSpeed = 20.0f * deltaTime;
 
         if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-            animatedCharacter.moveForward(deltaTime);
-            hiker.moveForward(deltaTime);
+            direction = 1;
         }
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-            animatedCharacter.moveBackward(deltaTime);
-            hiker.moveBackward(deltaTime);
+        else if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+            direction = -1;
         }
 
         // Strafe controls
@@ -208,19 +331,71 @@ void HikingSimulator::processInput(GLFWwindow* window) {
         }
     }
 
+    moveDirection = direction;
+
     // Other controls
     if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
-        animatedCharacter.resetHike();
-        hiker.resetPath();
+        simulation.post([this] {
+            animatedCharacter.resetHike();
+            hiker.resetPath();
+        });
     }
     if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS) {
         isMouseEnabled = !isMouseEnabled;
     }
 
+    // Time of day: [ turns the sun back, ] moves it on
+    if (glfwGetKey(window, GLFW_KEY_LEFT_BRACKET) == GLFW_PRESS) {
+        timeOfDay -= timeOfDaySpeed * deltaTime;
+        lighting.setTimeOfDay(timeOfDay);
+    }
+    if (glfwGetKey(window, GLFW_KEY_RIGHT_BRACKET) == GLFW_PRESS) {
+        timeOfDay += timeOfDaySpeed * deltaTime;
+        lighting.setTimeOfDay(timeOfDay);
+    }
+
+    // Timeline scrubbing: T toggles, arrows scrub, Home/End jump to either end
+    bool scrubKeyDown = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+    if (scrubKeyDown && !scrubKeyWasDown) {
+        simulation.post([this] {
+            hiker.setScrubbing(!hiker.isScrubbing());
+            std::cout << "INFO: Scrubbing " << (hiker.isScrubbing() ? "enabled" : "disabled") << std::endl;
+        });
+    }
+    scrubKeyWasDown = scrubKeyDown;
+
+    // Seeks run on the simulation thread, which owns the hiker
+    bool scrubForward = glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS;
+    bool scrubBackward = glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS;
+    bool jumpToStart = glfwGetKey(window, GLFW_KEY_HOME) == GLFW_PRESS;
+    bool jumpToEnd = glfwGetKey(window, GLFW_KEY_END) == GLFW_PRESS;
+    if (scrubForward || scrubBackward || jumpToStart || jumpToEnd) {
+        float scrubStep = scrubSpeed * deltaTime;
+        simulation.post([=, this] {
+            if (!hiker.isScrubbing()) {
+                return;
+            }
+            if (scrubForward) {
+                hiker.seekToTime(hiker.getCurrentTime() + scrubStep);
+            }
+            if (scrubBackward) {
+                hiker.seekToTime(hiker.getCurrentTime() - scrubStep);
+            }
+            if (jumpToStart) {
+                hiker.seekToDistance(0.0f);
+            }
+            if (jumpToEnd) {
+                hiker.seekToDistance(hiker.getTotalPathLength());
+            }
+        });
+    }
+
     updateViewMatrix();
 }
 
 void HikingSimulator::processMouseMovement(float xpos, float ypos) {
+    cursorX = xpos;
+    cursorY = ypos;
     if (!isMouseEnabled) return;
 
     if (firstMouse) {
@@ -255,63 +430,91 @@ void HikingSimulator::render(float deltaTime) {
     glClearColor(0.2f, 0.3f, 0.4f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
-
-    // Render skybox first
-    glDepthFunc(GL_LEQUAL);
-    glm::mat4 skyboxView = glm::mat4(glm::mat3(viewMatrix)); // Remove translation
-    Skybox::getInstance().render(skyboxView, projectionMatrix);
-    glDepthFunc(GL_LESS);
+    // Resync once a frame, in case anything outside the cache touched the state it shadows
+    GLStateCache::getInstance().invalidate();
 
-    // Enable face culling for terrain
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-
-    // Update positions
-    hiker.updatePosition(deltaTime, terrain);
-    animatedCharacter.updatePosition(deltaTime, terrain);
+    // Movers are advanced by the simulation thread; draw its two newest steps blended to this frame
+    simulation.getSnapshot(frameState, terrain.getHorizontalScale() * 25.0f);
 
     if (cameraMode != CameraMode::OVERVIEW) {
         updateViewMatrix();
     }
 
-    // Render terrain
-    terrain.render(modelMatrix, viewMatrix, projectionMatrix, cameraPosition);
-
-    // Disable face culling for transparent objects
-    glDisable(GL_CULL_FACE);
-
-    // Render path
+    // Upload the camera, light and time once; every shader reads them from the FrameData block
+    FrameData frameData = {};
+    frameData.view = viewMatrix;
+    frameData.projection = projectionMatrix;
+    frameData.viewProjection = projectionMatrix * viewMatrix;
+    frameData.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+    lighting.apply(frameData);
+    frameData.time = static_cast<float>(glfwGetTime());
+    frameData.deltaTime = deltaTime;
+    frameUniforms.update(frameData);
+
+    // Advance a few snow tiles and upload only those that changed
+    snowCover.update(deltaTime, seasonalEffect.getSeason() == SeasonalEffect::Season::SNOW);
+    snowCover.upload();
+    orthophoto.update(viewMatrix, projectionMatrix, cameraPosition, windowHeight);
+    seasonalEffect.update(deltaTime, cameraPosition);
+
+    // Queue the frame's draws; the queue orders them by pass, program and depth
+    renderQueue.begin(viewMatrix);
+    glm::vec3 terrainCenter = glm::vec3(modelMatrix[3]);
+
+    const Shader* terrainProgram = terrain.getShader() ? &terrain.getShader()->get(terrain.getShaderFeatures()) : nullptr;
+    renderQueue.submit(RenderQueue::Pass::SOLID, terrainProgram, terrainCenter, true,
+        [this]() { terrain.render(modelMatrix); });
+    renderQueue.submit(RenderQueue::Pass::SOLID, pathShader.get(), frameState.characterPosition, false,
+        [this]() { animatedCharacter.render(*pathShader, frameState.characterPosition); });
+    renderQueue.submit(RenderQueue::Pass::SOLID, crowdShader.get(), terrainCenter, false,
+        [this]() { crowd.render(*crowdShader, frameState.crowdPositions); });
+
+    // The walked trail covers the path ribbon, which renderPath pushes back with a polygon offset;
+    // both stay in one packet so the trail is always drawn after the path
     if (pathShader && pathShader->isLoaded()) {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glDepthMask(GL_FALSE);
+        renderQueue.submit(RenderQueue::Pass::SOLID, pathShader.get(), frameState.hikerPosition, false, [this]() {
+            pathShader->setMat4("model", modelMatrix);
+            pathShader->setFloat("heightOffset", 0.05f); // Minimal height offset
+            pathShader->setVec3("pathColor", glm::vec3(1.0f, 0.0f, 0.0f));
+            hiker.renderPath(*pathShader);
+            hiker.renderWalkedTrail(*trailShader, frameState.hikerDistance);
+        });
+    }
 
-        pathShader->use();
-        pathShader->setMat4("model", modelMatrix);
-        pathShader->setMat4("view", viewMatrix);
-        pathShader->setMat4("projection", projectionMatrix);
-        pathShader->setFloat("heightOffset", 0.05f); // Minimal height offset
-        pathShader->setVec3("pathColor", glm::vec3(1.0f, 0.0f, 0.0f));
+    Skybox::getInstance().setSunDirection(lighting.getSunDirection());
+    renderQueue.submit(RenderQueue::Pass::SKY, nullptr, cameraPosition, false,
+        []() { Skybox::getInstance().render(); });
 
-        hiker.renderPath(viewMatrix, projectionMatrix, *pathShader);
+    renderQueue.submit(RenderQueue::Pass::BLENDED, nullptr, cameraPosition, false,
+        [this]() { seasonalEffect.render(); });
 
-        glDepthMask(GL_TRUE);
-        glDisable(GL_BLEND);
-    }
-
-    // Render character and effects
-    animatedCharacter.render(viewMatrix, projectionMatrix, *pathShader);
-    seasonalEffect.render(viewMatrix, projectionMatrix);
+    renderQueue.execute();
 }
 
 void HikingSimulator::cleanup() {
+    // The simulation thread touches the movers, so it has to stop before they are torn down
+    simulation.stop();
     terrain.cleanup();
     hiker.cleanup();
     animatedCharacter.cleanup();
+    crowd.cleanup();
+    trackHeatmap.cleanup();
+    snowCover.cleanup();
+    snowfallTexture.reset();
+    orthophoto.cleanup();
     Skybox::getInstance().cleanup();
     seasonalEffect.cleanup();
+    frameUniforms.cleanup();
+
+    const GLStateCache::Statistics& stateChanges = GLStateCache::getInstance().getStatistics();
+    std::cout << "INFO: GL state cache: " << stateChanges.issued << " calls issued, "
+        << stateChanges.filtered << " filtered as redundant" << std::endl;
+    const RenderQueue::Statistics& queue = renderQueue.getStatistics();
+    std::cout << "INFO: Render queue, last frame: " << queue.packets << " packets, "
+        << queue.programChanges << " program changes, " << queue.passChanges << " pass changes" << std::endl;
+
+    // Textures nobody holds any more are still cached; drop them while the context is alive
+    AssetCache::getInstance().clear();
     std::cout << "INFO: HikingSimulator cleaned up successfully." << std::endl;
 }
 
@@ -341,5 +544,82 @@ CameraMode HikingSimulator::getCameraMode() const {
 }
 
 void HikingSimulator::processMouseButton(int button, int action) {
-    // Implement mouse button processing if needed
+    // Clicking near the trail with a free cursor moves the hiker to that point of the track
+    if (button != GLFW_MOUSE_BUTTON_LEFT || action != GLFW_PRESS || isMouseEnabled) {
+        return;
+    }
+
+    glm::vec3 groundPoint;
+    if (!pickTerrain(cursorX, cursorY, groundPoint)) {
+        return;
+    }
+
+    TrackSpatialIndex::Hit hit;
+    float snapDistance = terrain.getHorizontalScale() * 50.0f;
+    if (trackIndex.findNearest(groundPoint, hit, snapDistance)) {
+        float distance = hit.trackDistance;
+        simulation.post([this, distance] { hiker.seekToDistance(distance); });
+    }
+}
+
+void HikingSimulator::stepSimulation(float stepSeconds) {
+    // Held movement keys push the movers on top of their own motion, as before
+    int direction = moveDirection;
+    if (direction > 0) {
+        animatedCharacter.moveForward(stepSeconds);
+        hiker.moveForward(stepSeconds);
+    }
+    else if (direction < 0) {
+        animatedCharacter.moveBackward(stepSeconds);
+        hiker.moveBackward(stepSeconds);
+    }
+
+    hiker.updatePosition(stepSeconds, terrain);
+    animatedCharacter.updatePosition(stepSeconds, terrain);
+    crowd.update(stepSeconds, terrain);
+}
+
+void HikingSimulator::captureSnapshot(SimulationSnapshot& snapshot) const {
+    snapshot.hikerPosition = hiker.getPosition();
+    snapshot.hikerDistance = hiker.getCurrentDistance();
+    snapshot.characterPosition = animatedCharacter.getCurrentPosition();
+    snapshot.crowdPositions = crowd.getPositions();
+}
+
+bool HikingSimulator::pickTerrain(float xpos, float ypos, glm::vec3& hitPoint) const {
+    // Unproject the cursor into a world-space ray
+    glm::vec2 ndc(2.0f * xpos / windowWidth - 1.0f, 1.0f - 2.0f * ypos / windowHeight);
+    glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 end = glm::vec3(farPoint) / farPoint.w;
+
+    // March the ray in steps of one terrain cell, then bisect the step that went below ground
+    float rayLength = glm::distance(origin, end);
+    glm::vec3 direction = (end - origin) / rayLength;
+    float step = terrain.getHorizontalScale();
+    float previous = 0.0f;
+    for (float t = step; t < rayLength; t += step) {
+        glm::vec3 point = origin + direction * t;
+        if (point.y > terrain.getHeightAtPosition(point.x, point.z)) {
+            previous = t;
+            continue;
+        }
+
+        float above = previous, below = t;
+        for (int i = 0; i < 16; ++i) {
+            float middle = 0.5f * (above + below);
+            glm::vec3 probe = origin + direction * middle;
+            if (probe.y > terrain.getHeightAtPosition(probe.x, probe.z)) {
+                above = middle;
+            }
+            else {
+                below = middle;
+            }
+        }
+        hitPoint = origin + direction * below;
+        return true;
+    }
+    return false;
 }
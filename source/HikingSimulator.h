@@ -4,7 +4,18 @@
 #include "Terrain.h"
 #include "Hiker.h"
 #include "AnimatedCharacter.h"
+#include "HikerCrowd.h"
+#include "TrackSpatialIndex.h"
+#include "TrackLibrary.h"
+#include "TrackHeatmap.h"
 #include "SeasonalEffect.h"
+#include "SnowAccumulation.h"
+#include "AssetCache.h"
+#include "VirtualTexture.h"
+#include "FrameUniforms.h"
+#include "RenderQueue.h"
+#include "SimulationThread.h"
+#include <atomic>
 #include <memory>
 #include "Lighting.h"
 #include "Shader.h"
@@ -38,21 +49,43 @@ private:
     void updateProjectionMatrix();
     void updateViewMatrix();
     void renderSkybox();
+    bool pickTerrain(float xpos, float ypos, glm::vec3& hitPoint) const;
+    void stepSimulation(float stepSeconds);
+    void captureSnapshot(SimulationSnapshot& snapshot) const;
 
     float yaw = -90.0f;
     float pitch = 0.0f;
     float lastX = 0.0f;
     float lastY = 0.0f;
+    float cursorX = 0.0f;
+    float cursorY = 0.0f;
     bool firstMouse = true;
     bool isMouseEnabled = false;
+    bool scrubKeyWasDown = false;
+    float scrubSpeed = 120.0f;  // Recorded seconds scrubbed per real second
+    float timeOfDay = 14.0f;  // Hours since midnight, sets the sun for the sky and the terrain
+    float timeOfDaySpeed = 2.0f;  // Hours per real second while [ or ] is held
+    float simulationStep = 1.0f / 60.0f;  // Fixed simulation timestep in seconds
+    std::atomic<int> moveDirection{ 0 };  // Held W/S: 1 forward, -1 backward, applied every step
     glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
     glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
 
     Terrain terrain;
     Hiker hiker;
     AnimatedCharacter animatedCharacter;
+    HikerCrowd crowd;
+    TrackSpatialIndex trackIndex;
+    TrackLibrary trackLibrary;
+    TrackHeatmap trackHeatmap;
     SeasonalEffect seasonalEffect;
+    SnowAccumulation snowCover;
+    TextureHandle snowfallTexture;  // Ground texture the terrain blends toward under snow
+    VirtualTexture orthophoto;  // Aerial imagery streamed from disk, used when data/orthophoto.vtex exists
     Lighting lighting;
+    FrameUniforms frameUniforms;  // Camera, light and time shared by every shader, uploaded once per frame
+    RenderQueue renderQueue;  // The frame's draws, sorted by pass, program and depth before submission
+    SimulationThread simulation;
+    SimulationSnapshot frameState;  // Simulation state blended for the frame being drawn
 
     int width;
     int height;
@@ -64,7 +97,10 @@ private:
     glm::mat4 modelMatrix;
     glm::vec3 cameraPosition;
 
+    std::unique_ptr<ShaderVariants> terrainShader;  // Permutations for the terrain layers in use
     std::unique_ptr<Shader> pathShader;
+    std::unique_ptr<Shader> trailShader;
+    std::unique_ptr<Shader> crowdShader;
     float lastFrameTime;
     CameraMode cameraMode;
 };
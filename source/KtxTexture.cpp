@@ -0,0 +1,221 @@
+// KtxTexture.cpp
+
+#include "KtxTexture.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    struct FileHeader {
+        unsigned char identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(FileHeader) == 80, "KTX2 header must match the file layout");
+
+    struct LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    // Basic data format descriptor for one BC1 or BC3 block, as the KTX2 spec requires in every file
+    std::vector<uint32_t> buildDataFormatDescriptor(KtxTexture::Format format) {
+        const uint32_t MODEL_BC1A = 128;
+        const uint32_t MODEL_BC3 = 130;
+        const uint32_t CHANNEL_COLOR = 0;
+        const uint32_t CHANNEL_BC3_ALPHA = 15;
+        const uint32_t PRIMARIES_BT709 = 1;
+        const uint32_t TRANSFER_LINEAR = 1;
+
+        bool hasAlpha = format == KtxTexture::Format::BC3;
+        uint32_t sampleCount = hasAlpha ? 2 : 1;
+        uint32_t blockSize = 24 + 16 * sampleCount;
+        uint32_t blockBytes = static_cast<uint32_t>(KtxTexture::getBlockBytes(format));
+
+        std::vector<uint32_t> words = {
+            4 + blockSize,                                                  // Total size, this word included
+            0,                                                              // Khronos vendor, basic descriptor
+            2u | (blockSize << 16),                                         // Version 2 and block size
+            (hasAlpha ? MODEL_BC3 : MODEL_BC1A) | (PRIMARIES_BT709 << 8) | (TRANSFER_LINEAR << 16),
+            3u | (3u << 8),                                                 // 4x4 texel blocks
+            blockBytes,                                                     // Bytes in plane 0
+            0
+        };
+        auto addSample = [&](uint32_t bitOffset, uint32_t channel) {
+            words.push_back(bitOffset | (63u << 16) | (channel << 24));
+            words.push_back(0);
+            words.push_back(0);
+            words.push_back(0xFFFFFFFFu);
+        };
+        if (hasAlpha) {
+            addSample(0, CHANNEL_BC3_ALPHA);
+            addSample(64, CHANNEL_COLOR);
+        }
+        else {
+            addSample(0, CHANNEL_COLOR);
+        }
+        return words;
+    }
+}
+
+KtxTexture::KtxTexture()
+    : format(Format::BC1), width(0), height(0) {}
+
+bool KtxTexture::load(const std::string& path) {
+    levels.clear();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<unsigned char> contents(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    if (!file.good() || contents.size() < sizeof(FileHeader)) {
+        std::cerr << "ERROR::KTX::TRUNCATED_FILE: " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, contents.data(), sizeof(FileHeader));
+    bool supported = std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0 &&
+        (header.vkFormat == static_cast<uint32_t>(Format::BC1) || header.vkFormat == static_cast<uint32_t>(Format::BC3)) &&
+        header.pixelWidth > 0 && header.pixelHeight > 0 && header.pixelDepth == 0 && header.layerCount == 0 &&
+        header.faceCount == 1 && header.levelCount > 0 && header.levelCount <= 32 && header.supercompressionScheme == 0;
+    size_t indexEnd = sizeof(FileHeader) + header.levelCount * sizeof(LevelIndex);
+    if (!supported || contents.size() < indexEnd) {
+        std::cerr << "ERROR::KTX::UNSUPPORTED_FILE: " << path << std::endl;
+        return false;
+    }
+
+    format = static_cast<Format>(header.vkFormat);
+    width = static_cast<int>(header.pixelWidth);
+    height = static_cast<int>(header.pixelHeight);
+
+    // Each level must hold exactly the blocks its size needs, inside the file
+    size_t blockBytes = getBlockBytes(format);
+    levels.resize(header.levelCount);
+    for (uint32_t level = 0; level < header.levelCount; ++level) {
+        LevelIndex index;
+        std::memcpy(&index, contents.data() + sizeof(FileHeader) + level * sizeof(LevelIndex), sizeof(LevelIndex));
+        size_t levelWidth = std::max(1, width >> level);
+        size_t levelHeight = std::max(1, height >> level);
+        size_t expected = ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockBytes;
+        if (index.byteLength != expected || index.byteOffset > contents.size() || contents.size() - index.byteOffset < index.byteLength) {
+            std::cerr << "ERROR::KTX::BAD_LEVEL: " << path << " level " << level << std::endl;
+            levels.clear();
+            return false;
+        }
+        levels[level].assign(contents.begin() + static_cast<std::ptrdiff_t>(index.byteOffset),
+            contents.begin() + static_cast<std::ptrdiff_t>(index.byteOffset + index.byteLength));
+    }
+    return true;
+}
+
+bool KtxTexture::save(const std::string& path) const {
+    if (levels.empty()) {
+        return false;
+    }
+
+    std::vector<uint32_t> descriptor = buildDataFormatDescriptor(format);
+    uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    size_t dfdOffset = sizeof(FileHeader) + levelCount * sizeof(LevelIndex);
+    size_t dfdBytes = descriptor.size() * sizeof(uint32_t);
+
+    FileHeader header = {};
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = static_cast<uint32_t>(format);
+    header.typeSize = 1;
+    header.pixelWidth = static_cast<uint32_t>(width);
+    header.pixelHeight = static_cast<uint32_t>(height);
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(dfdOffset);
+    header.dfdByteLength = static_cast<uint32_t>(dfdBytes);
+
+    // Smallest level first, each aligned to a whole block
+    size_t alignment = getBlockBytes(format);
+    std::vector<LevelIndex> index(levelCount);
+    size_t offset = dfdOffset + dfdBytes;
+    for (size_t level = levels.size(); level-- > 0;) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        index[level] = { offset, levels[level].size(), levels[level].size() };
+        offset += levels[level].size();
+    }
+
+    std::vector<unsigned char> contents(offset, 0);
+    std::memcpy(contents.data(), &header, sizeof(FileHeader));
+    std::memcpy(contents.data() + sizeof(FileHeader), index.data(), index.size() * sizeof(LevelIndex));
+    std::memcpy(contents.data() + dfdOffset, descriptor.data(), dfdBytes);
+    for (size_t level = 0; level < levels.size(); ++level) {
+        std::memcpy(contents.data() + index[level].byteOffset, levels[level].data(), levels[level].size());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::KTX::FAILED_TO_OPEN_FILE: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    return file.good();
+}
+
+void KtxTexture::setLevels(Format format, int width, int height, std::vector<std::vector<unsigned char>> levels) {
+    this->format = format;
+    this->width = width;
+    this->height = height;
+    this->levels = std::move(levels);
+}
+
+KtxTexture::Format KtxTexture::getFormat() const {
+    return format;
+}
+
+int KtxTexture::getWidth() const {
+    return width;
+}
+
+int KtxTexture::getHeight() const {
+    return height;
+}
+
+size_t KtxTexture::getLevelCount() const {
+    return levels.size();
+}
+
+const std::vector<unsigned char>& KtxTexture::getLevel(size_t level) const {
+    return levels[level];
+}
+
+size_t KtxTexture::getDataSize() const {
+    size_t bytes = 0;
+    for (const std::vector<unsigned char>& level : levels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
+
+GLenum KtxTexture::getGLFormat() const {
+    return format == Format::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+}
+
+size_t KtxTexture::getBlockBytes(Format format) {
+    return format == Format::BC3 ? 16 : 8;
+}
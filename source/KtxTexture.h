@@ -0,0 +1,120 @@
+// KtxTexture.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// S3TC is not core OpenGL, so the loader header does not define its enums
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+/**
+ * @class KtxTexture
+ * @brief Block-compressed 2D image with its whole mip chain, read from and written to a KTX2 file.
+ *
+ * Only what the texture pipeline produces is supported: one face, one layer, no supercompression,
+ * and BC1 or BC3 blocks. The file stores the smallest level first, as KTX2 requires; in memory
+ * the levels are kept largest first, the order they are uploaded in.
+ */
+class KtxTexture {
+public:
+    /**
+     * @brief Block formats, valued as their Vulkan format numbers in the file header.
+     */
+    enum class Format : uint32_t {
+        BC1 = 131,  ///< VK_FORMAT_BC1_RGB_UNORM_BLOCK, 8 bytes per 4x4 block, no alpha.
+        BC3 = 137   ///< VK_FORMAT_BC3_UNORM_BLOCK, 16 bytes per 4x4 block with alpha.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    KtxTexture();
+
+    /**
+     * @brief Reads a KTX2 file.
+     * @param path File to read.
+     * @return False if the file is missing, truncated or uses something this class does not support.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Writes the texture as a KTX2 file.
+     * @param path File to write.
+     * @return True if the file was written.
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Replaces the contents with newly encoded levels.
+     * @param format Block format of every level.
+     * @param width Width of level 0 in pixels.
+     * @param height Height of level 0 in pixels.
+     * @param levels Block data per level, largest first.
+     */
+    void setLevels(Format format, int width, int height, std::vector<std::vector<unsigned char>> levels);
+
+    /**
+     * @brief Gets the block format.
+     * @return BC1 or BC3.
+     */
+    Format getFormat() const;
+
+    /**
+     * @brief Gets the width of level 0.
+     * @return Width in pixels.
+     */
+    int getWidth() const;
+
+    /**
+     * @brief Gets the height of level 0.
+     * @return Height in pixels.
+     */
+    int getHeight() const;
+
+    /**
+     * @brief Gets the number of mip levels.
+     * @return Level count, 0 when nothing is loaded.
+     */
+    size_t getLevelCount() const;
+
+    /**
+     * @brief Gets the blocks of one level.
+     * @param level Level index, 0 is the largest.
+     * @return Block data in row-major block order.
+     */
+    const std::vector<unsigned char>& getLevel(size_t level) const;
+
+    /**
+     * @brief Gets the bytes of all levels together.
+     * @return Total block data size.
+     */
+    size_t getDataSize() const;
+
+    /**
+     * @brief Gets the OpenGL internal format to upload the blocks with.
+     * @return GL_COMPRESSED_RGB_S3TC_DXT1_EXT or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT.
+     */
+    GLenum getGLFormat() const;
+
+    /**
+     * @brief Gets the size of one 4x4 block.
+     * @param format Block format.
+     * @return 8 for BC1, 16 for BC3.
+     */
+    static size_t getBlockBytes(Format format);
+
+private:
+    Format format;
+    int width;
+    int height;
+    std::vector<std::vector<unsigned char>> levels;  ///< Block data per level, largest first.
+};
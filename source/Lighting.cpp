@@ -1,17 +1,40 @@
 #include "Lighting.h"
+#include <cmath>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace {
+    const float kSunDistance = 100000.0f;                 // Far beyond the terrain, so light rays are parallel
+    const float kLatitude = glm::radians(60.0f);          // Latitude the sun path is computed for
+    const float kDeclination = glm::radians(15.0f);       // Late spring
+}
+
 Lighting::Lighting(const glm::vec3& pos, const glm::vec3& col)
-    : position(pos), color(col) {
+    : position(pos), color(col), baseColor(col), sunDirection(glm::normalize(pos)), timeOfDay(-1.0f) {
+}
+
+void Lighting::setSunDirection(const glm::vec3& direction) {
+    sunDirection = glm::normalize(direction);
+    position = sunDirection * kSunDistance;
 }
 
-void Lighting::apply(Shader& shader) const {
-    shader.setVec3("lightPos", position);
-    shader.setVec3("lightColor", color);
+void Lighting::setTimeOfDay(float hours) {
+    timeOfDay = std::fmod(std::fmod(hours, 24.0f) + 24.0f, 24.0f);
 
-    // Add enhanced lighting parameters
-    shader.setVec3("light.position", position);
-    shader.setVec3("light.ambient", color * 0.3f);
-    shader.setVec3("light.diffuse", color);
-    shader.setVec3("light.specular", color * 0.5f);
-}
\ No newline at end of file
+    // Hour angle is 0 at solar noon; x points east, y up and z south
+    float hourAngle = glm::radians((timeOfDay - 12.0f) * 15.0f);
+    float up = std::sin(kLatitude) * std::sin(kDeclination) + std::cos(kLatitude) * std::cos(kDeclination) * std::cos(hourAngle);
+    float east = -std::cos(kDeclination) * std::sin(hourAngle);
+    float north = std::cos(kLatitude) * std::sin(kDeclination) - std::sin(kLatitude) * std::cos(kDeclination) * std::cos(hourAngle);
+    setSunDirection(glm::vec3(east, up, -north));
+
+    // Longer paths through the air near the horizon leave mostly red light, and none once the sun is down
+    float height = glm::smoothstep(-0.05f, 0.25f, sunDirection.y);
+    glm::vec3 horizonTint(1.0f, 0.55f, 0.3f);
+    color = baseColor * glm::mix(horizonTint, glm::vec3(1.0f), height) * glm::smoothstep(-0.1f, 0.02f, sunDirection.y);
+}
+
+void Lighting::apply(FrameData& data) const {
+    data.lightPosition = glm::vec4(position, 1.0f);
+    data.lightColor = glm::vec4(color, 1.0f);
+    data.sunDirection = glm::vec4(sunDirection, 0.0f);
+}
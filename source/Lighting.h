@@ -2,12 +2,15 @@
 #define LIGHTING_H
 
 #include <glm/glm.hpp>
-#include "Shader.h"
+#include "FrameUniforms.h"
 
 class Lighting {
 private:
     glm::vec3 position;
     glm::vec3 color;
+    glm::vec3 baseColor;      // Color of the sun high in the sky
+    glm::vec3 sunDirection;   // Unit vector towards the sun, shared with the sky
+    float timeOfDay;          // Hours since midnight, negative until setTimeOfDay is called
 
 public:
     // Constructor
@@ -17,9 +20,17 @@ public:
     // Inline getters
     glm::vec3 getPosition() const { return position; }
     glm::vec3 getColor() const { return color; }
+    glm::vec3 getSunDirection() const { return sunDirection; }
+    float getTimeOfDay() const { return timeOfDay; }
 
-    // Shader application
-    void apply(Shader& shader) const;
+    // Places the sun; the light position follows it far enough away to act as a directional light
+    void setSunDirection(const glm::vec3& direction);
+
+    // Moves the sun along its daily path and reddens it near the horizon
+    void setTimeOfDay(float hours);
+
+    // Fills the light and sun of the per-frame uniform block
+    void apply(FrameData& data) const;
 };
 
-#endif // LIGHTING_H
\ No newline at end of file
+#endif // LIGHTING_H
@@ -0,0 +1,70 @@
+// MappedFile.h
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The operating system pages data in on first touch, so opening a large file costs the same as a
+ * small one and unused parts are never read.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Constructor.
+     */
+    MappedFile();
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file, replacing any previous mapping.
+     * @param path File to map.
+     * @return True if the file was mapped.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Checks if a file is mapped.
+     * @return True if mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Gets the start of the mapped bytes.
+     * @return Pointer to the file contents, or nullptr when closed.
+     */
+    const unsigned char* getData() const;
+
+    /**
+     * @brief Gets the size of the mapped file.
+     * @return Size in bytes.
+     */
+    size_t getSize() const;
+
+private:
+    const unsigned char* data;  ///< Start of the mapping.
+    size_t size;                ///< Mapped size in bytes.
+
+#ifdef _WIN32
+    void* fileHandle;           ///< Windows file handle.
+    void* mappingHandle;        ///< Windows file mapping handle.
+#else
+    int fileDescriptor;         ///< POSIX file descriptor.
+#endif
+};
@@ -0,0 +1,194 @@
+// ParticleSystem.cpp
+
+#include "ParticleSystem.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // Moves one coordinate of every particle and wraps it into [center - size / 2, center + size / 2)
+    void advanceAxis(float* positions, const float* velocities, size_t count, float deltaTime, float center, float size) {
+        float low = center - size * 0.5f;
+        float high = center + size * 0.5f;
+        size_t i = 0;
+
+#ifdef PARTICLES_USE_SSE
+        __m128 dt = _mm_set1_ps(deltaTime);
+        __m128 lowBound = _mm_set1_ps(low);
+        __m128 highBound = _mm_set1_ps(high);
+        __m128 wrap = _mm_set1_ps(size);
+        for (; i + 4 <= count; i += 4) {
+            __m128 p = _mm_add_ps(_mm_loadu_ps(positions + i), _mm_mul_ps(_mm_loadu_ps(velocities + i), dt));
+            p = _mm_add_ps(p, _mm_and_ps(_mm_cmplt_ps(p, lowBound), wrap));
+            p = _mm_sub_ps(p, _mm_and_ps(_mm_cmpge_ps(p, highBound), wrap));
+            _mm_storeu_ps(positions + i, p);
+        }
+#endif
+
+        for (; i < count; ++i) {
+            float p = positions[i] + velocities[i] * deltaTime;
+            p += p < low ? size : 0.0f;
+            p -= p >= high ? size : 0.0f;
+            positions[i] = p;
+        }
+    }
+
+    // Full wrap for when the box moved further than one wrap can fix, such as a camera cut
+    void rewrapAxis(float* positions, size_t count, float center, float size) {
+        float low = center - size * 0.5f;
+        for (size_t i = 0; i < count; ++i) {
+            positions[i] = low + (positions[i] - low) - size * std::floor((positions[i] - low) / size);
+        }
+    }
+}
+
+ParticleSystem::ParticleSystem()
+    : VAO(0), instanceVBO(0), volumeCenter(0.0f) {}
+
+ParticleSystem::~ParticleSystem() {
+    cleanup();
+}
+
+bool ParticleSystem::initialize(const Settings& settings, const glm::vec3& center, uint32_t seed) {
+    cleanup();
+    this->settings = settings;
+    volumeCenter = center;
+
+    // Padding keeps the SIMD loops free of a remainder; padded particles are never drawn
+    size_t padded = (settings.count + 3) & ~static_cast<size_t>(3);
+    positionX.resize(padded);
+    positionY.resize(padded);
+    positionZ.resize(padded);
+    velocityX.resize(padded);
+    velocityY.resize(padded);
+    velocityZ.resize(padded);
+    phase.resize(padded);
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(-0.5f, 0.5f);
+    for (size_t i = 0; i < padded; ++i) {
+        positionX[i] = center.x + unit(random) * settings.volumeSize.x;
+        positionY[i] = center.y + unit(random) * settings.volumeSize.y;
+        positionZ[i] = center.z + unit(random) * settings.volumeSize.z;
+        velocityX[i] = settings.velocity.x + unit(random) * 2.0f * settings.velocityJitter.x;
+        velocityY[i] = settings.velocity.y + unit(random) * 2.0f * settings.velocityJitter.y;
+        velocityZ[i] = settings.velocity.z + unit(random) * 2.0f * settings.velocityJitter.z;
+        phase[i] = (unit(random) + 0.5f) * 6.2831853f;
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceVBO);
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, settings.count * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+
+    // Position and sway phase, advanced once per billboard; the quad corners come from gl_VertexID
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+    glVertexAttribDivisor(0, 1);
+
+    GLStateCache::getInstance().bindVertexArray(0);
+    return true;
+}
+
+void ParticleSystem::update(float deltaTime, const glm::vec3& center) {
+    size_t count = positionX.size();
+    if (count == 0) {
+        return;
+    }
+
+    // One wrap per frame only covers a camera that moved less than half the box since last frame
+    glm::vec3 moved = glm::abs(center - volumeCenter);
+    glm::vec3 halfSize = settings.volumeSize * 0.5f;
+    if (moved.x > halfSize.x || moved.y > halfSize.y || moved.z > halfSize.z) {
+        rewrapAxis(positionX.data(), count, center.x, settings.volumeSize.x);
+        rewrapAxis(positionY.data(), count, center.y, settings.volumeSize.y);
+        rewrapAxis(positionZ.data(), count, center.z, settings.volumeSize.z);
+    }
+    volumeCenter = center;
+
+    advanceAxis(positionX.data(), velocityX.data(), count, deltaTime, center.x, settings.volumeSize.x);
+    advanceAxis(positionY.data(), velocityY.data(), count, deltaTime, center.y, settings.volumeSize.y);
+    advanceAxis(positionZ.data(), velocityZ.data(), count, deltaTime, center.z, settings.volumeSize.z);
+}
+
+void ParticleSystem::render(Shader& shader) {
+    if (VAO == 0 || settings.count == 0) {
+        return;
+    }
+
+    // Orphan the buffer, then interleave the arrays straight into the mapped storage
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    GLsizeiptr bufferSize = static_cast<GLsizeiptr>(settings.count * sizeof(glm::vec4));
+    glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    float* mapped = static_cast<float*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bufferSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!mapped) {
+        std::cerr << "ERROR::PARTICLES::FAILED_TO_MAP_INSTANCE_BUFFER" << std::endl;
+        return;
+    }
+
+    size_t i = 0;
+#ifdef PARTICLES_USE_SSE
+    for (; i + 4 <= settings.count; i += 4) {
+        __m128 x = _mm_loadu_ps(positionX.data() + i);
+        __m128 y = _mm_loadu_ps(positionY.data() + i);
+        __m128 z = _mm_loadu_ps(positionZ.data() + i);
+        __m128 w = _mm_loadu_ps(phase.data() + i);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(mapped + i * 4, x);
+        _mm_storeu_ps(mapped + i * 4 + 4, y);
+        _mm_storeu_ps(mapped + i * 4 + 8, z);
+        _mm_storeu_ps(mapped + i * 4 + 12, w);
+    }
+#endif
+    for (; i < settings.count; ++i) {
+        mapped[i * 4] = positionX[i];
+        mapped[i * 4 + 1] = positionY[i];
+        mapped[i * 4 + 2] = positionZ[i];
+        mapped[i * 4 + 3] = phase[i];
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+
+    shader.use();
+    shader.setVec3("velocity", settings.velocity);
+    shader.setFloat("size", settings.size);
+    shader.setFloat("streak", settings.streak);
+    shader.setFloat("sway", settings.sway);
+    shader.setVec4("particleColor", settings.color);
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(settings.count));
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void ParticleSystem::cleanup() {
+    if (VAO) {
+        GLStateCache::getInstance().deleteVertexArray(VAO);
+        VAO = 0;
+    }
+    if (instanceVBO) {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+    velocityX.clear();
+    velocityY.clear();
+    velocityZ.clear();
+    phase.clear();
+}
+
+size_t ParticleSystem::getCount() const {
+    return positionX.empty() ? 0 : settings.count;
+}
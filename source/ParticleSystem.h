@@ -0,0 +1,100 @@
+// ParticleSystem.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Shader.h"
+
+/**
+ * @class ParticleSystem
+ * @brief Falling particles in a box that follows the camera, drawn as instanced billboards.
+ *
+ * Positions and velocities are stored as one array per component and advanced four particles at a
+ * time with SSE. A particle that leaves the box re-enters on the opposite face, so the box always
+ * looks full around the camera without spawning or killing anything. Each frame the positions are
+ * written straight into one orphaned instance buffer and drawn with a single instanced call, so the
+ * cost grows with the particle count and not with the screen resolution.
+ */
+class ParticleSystem {
+public:
+    /**
+     * @brief Appearance and motion of one kind of particle.
+     */
+    struct Settings {
+        size_t count = 100000;                        ///< Number of particles.
+        glm::vec3 volumeSize{ 120.0f, 60.0f, 120.0f }; ///< Size of the box around the camera.
+        glm::vec3 velocity{ 0.0f, -1.5f, 0.0f };      ///< Mean velocity in world units per second.
+        glm::vec3 velocityJitter{ 0.3f, 0.5f, 0.3f }; ///< Per-particle random spread of the velocity.
+        float size = 0.08f;                           ///< Billboard width in world units.
+        float streak = 0.0f;                          ///< Extra length along the velocity, 0 for round flakes.
+        float sway = 0.4f;                            ///< Side-to-side drift amplitude, applied in the vertex shader.
+        glm::vec4 color{ 1.0f, 1.0f, 1.0f, 0.8f };    ///< Particle color and opacity.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    ParticleSystem();
+
+    /**
+     * @brief Destructor.
+     */
+    ~ParticleSystem();
+
+    /**
+     * @brief Scatters particles through the box and allocates the instance buffer.
+     * @param settings Particle settings.
+     * @param center Initial center of the box, usually the camera position.
+     * @param seed Seed for positions and velocities.
+     * @return True if the buffers were created.
+     */
+    bool initialize(const Settings& settings, const glm::vec3& center, uint32_t seed = 1u);
+
+    /**
+     * @brief Moves every particle and wraps it back into the box around the camera.
+     * @param deltaTime Time elapsed since the last update.
+     * @param center Current center of the box.
+     */
+    void update(float deltaTime, const glm::vec3& center);
+
+    /**
+     * @brief Streams the particle positions to the GPU and draws them.
+     *
+     * Particles are hidden by the terrain but never hide each other, so blending has to be on and
+     * depth writes off, as in RenderQueue's blended pass.
+     * @param shader Shader built from particleVert.glsl and particleFrag.glsl. The sway follows the frame time.
+     */
+    void render(Shader& shader);
+
+    /**
+     * @brief Cleans up OpenGL resources.
+     */
+    void cleanup();
+
+    /**
+     * @brief Gets the number of particles.
+     * @return Particle count.
+     */
+    size_t getCount() const;
+
+private:
+    Settings settings;
+
+    // Particle state, structure of arrays, padded to a multiple of four
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> velocityZ;
+    std::vector<float> phase;       ///< Random sway phase, constant per particle.
+
+    // OpenGL resources
+    GLuint VAO;
+    GLuint instanceVBO;             ///< Streamed vec4 per particle: position and sway phase.
+    glm::vec3 volumeCenter;
+};
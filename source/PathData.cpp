@@ -0,0 +1,152 @@
+// PathData.cpp
+
+#include "PathData.h"
+#include <algorithm>
+
+std::shared_ptr<const PathData> PathData::create(std::vector<glm::vec3> points, std::vector<float> times) {
+    std::shared_ptr<PathData> path(new PathData());
+
+    path->points = std::move(points);
+    path->cumulativeDistances.reserve(path->points.size());
+    if (!path->points.empty()) {
+        path->boundsMin = path->points[0];
+        path->boundsMax = path->points[0];
+        path->cumulativeDistances.push_back(0.0f);
+    }
+    for (size_t i = 1; i < path->points.size(); ++i) {
+        path->cumulativeDistances.push_back(path->cumulativeDistances.back() + glm::distance(path->points[i - 1], path->points[i]));
+        path->boundsMin = glm::min(path->boundsMin, path->points[i]);
+        path->boundsMax = glm::max(path->boundsMax, path->points[i]);
+    }
+
+    // Relative to the first point; clock jumps backwards are flattened so the times stay sorted
+    if (times.size() == path->points.size() && times.size() >= 2) {
+        float start = times[0];
+        path->times.resize(times.size());
+        path->times[0] = 0.0f;
+        for (size_t i = 1; i < times.size(); ++i) {
+            path->times[i] = std::max(times[i] - start, path->times[i - 1]);
+        }
+    }
+
+    path->statistics.build(path->points, path->times);
+    return path;
+}
+
+const std::vector<glm::vec3>& PathData::getPoints() const {
+    return points;
+}
+
+const std::vector<float>& PathData::getCumulativeDistances() const {
+    return cumulativeDistances;
+}
+
+const std::vector<float>& PathData::getTimes() const {
+    return times;
+}
+
+const TrackStatistics& PathData::getStatistics() const {
+    return statistics;
+}
+
+bool PathData::hasTimes() const {
+    return !times.empty();
+}
+
+size_t PathData::getPointCount() const {
+    return points.size();
+}
+
+size_t PathData::getSegmentCount() const {
+    return points.size() < 2 ? 0 : points.size() - 1;
+}
+
+float PathData::getTotalLength() const {
+    return cumulativeDistances.empty() ? 0.0f : cumulativeDistances.back();
+}
+
+float PathData::getTotalDuration() const {
+    return times.empty() ? 0.0f : times.back();
+}
+
+glm::vec3 PathData::getBoundsMin() const {
+    return boundsMin;
+}
+
+glm::vec3 PathData::getBoundsMax() const {
+    return boundsMax;
+}
+
+float PathData::getSegmentLength(size_t segment) const {
+    return cumulativeDistances[segment + 1] - cumulativeDistances[segment];
+}
+
+size_t PathData::findSegment(float distance, size_t hint) const {
+    size_t lastSegment = getSegmentCount() - 1;
+
+    // Movers advance a fraction of a segment per frame, so the hint or the next segment usually matches
+    for (size_t segment = hint; segment <= std::min(hint + 1, lastSegment); ++segment) {
+        if (distance >= cumulativeDistances[segment] && distance <= cumulativeDistances[segment + 1]) {
+            return segment;
+        }
+    }
+
+    auto it = std::upper_bound(cumulativeDistances.begin(), cumulativeDistances.end(), distance);
+    std::ptrdiff_t index = (it - cumulativeDistances.begin()) - 1;
+    return static_cast<size_t>(glm::clamp<std::ptrdiff_t>(index, 0, static_cast<std::ptrdiff_t>(lastSegment)));
+}
+
+float PathData::distanceAtTime(float time) const {
+    auto it = std::upper_bound(times.begin(), times.end(), time);
+    std::ptrdiff_t index = (it - times.begin()) - 1;
+    size_t segment = static_cast<size_t>(glm::clamp<std::ptrdiff_t>(index, 0, static_cast<std::ptrdiff_t>(times.size()) - 2));
+
+    float segmentDuration = times[segment + 1] - times[segment];
+    float t = segmentDuration > 0.0f ? (time - times[segment]) / segmentDuration : 0.0f;
+    t = glm::clamp(t, 0.0f, 1.0f);
+
+    return glm::mix(cumulativeDistances[segment], cumulativeDistances[segment + 1], t);
+}
+
+float PathData::timeAtDistance(float distance, size_t segment) const {
+    float segmentLength = getSegmentLength(segment);
+    float t = segmentLength > 0.0f ? (distance - cumulativeDistances[segment]) / segmentLength : 0.0f;
+
+    return glm::mix(times[segment], times[segment + 1], t);
+}
+
+void PathCursor::moveTo(const PathData& path, float newDistance) {
+    if (path.getSegmentCount() == 0) {
+        return;
+    }
+
+    distance = glm::clamp(newDistance, 0.0f, path.getTotalLength());
+    segment = static_cast<uint32_t>(path.findSegment(distance, segment));
+}
+
+void PathCursor::moveToSegment(const PathData& path, size_t newSegment, float fraction) {
+    if (path.getSegmentCount() == 0) {
+        return;
+    }
+
+    segment = static_cast<uint32_t>(std::min(newSegment, path.getSegmentCount() - 1));
+    distance = path.getCumulativeDistances()[segment] + glm::clamp(fraction, 0.0f, 1.0f) * path.getSegmentLength(segment);
+}
+
+float PathCursor::getSegmentFraction(const PathData& path) const {
+    if (path.getSegmentCount() == 0) {
+        return 0.0f;
+    }
+
+    float segmentLength = path.getSegmentLength(segment);
+    return segmentLength > 0.0f ? (distance - path.getCumulativeDistances()[segment]) / segmentLength : 0.0f;
+}
+
+glm::vec3 PathCursor::getPosition(const PathData& path) const {
+    if (path.getSegmentCount() == 0) {
+        return path.getPointCount() == 1 ? path.getPoints()[0] : glm::vec3(0.0f);
+    }
+
+    const std::vector<glm::vec3>& points = path.getPoints();
+    return glm::mix(points[segment], points[segment + 1], getSegmentFraction(path));
+}
@@ -0,0 +1,115 @@
+// PathData.h
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TrackStatistics.h"
+
+/**
+ * @class PathData
+ * @brief Immutable path shared by everything that moves along it.
+ *
+ * Points, cumulative distances, optional timestamps, bounds and interval statistics are computed
+ * once when the path is created. Movers hold a shared pointer to it plus a PathCursor, so any
+ * number of movers on one path cost the path once and a few bytes each.
+ */
+class PathData {
+public:
+    /**
+     * @brief Creates a shared path.
+     * @param points Path points.
+     * @param times Optional recorded time of each point. Ignored unless it has one entry per point.
+     *              Stored relative to the first point, with backward clock jumps flattened.
+     * @return Path that can no longer be modified.
+     */
+    static std::shared_ptr<const PathData> create(std::vector<glm::vec3> points, std::vector<float> times = {});
+
+    const std::vector<glm::vec3>& getPoints() const;
+    const std::vector<float>& getCumulativeDistances() const;
+    const std::vector<float>& getTimes() const;   ///< Empty without timestamps.
+    const TrackStatistics& getStatistics() const;
+
+    bool hasTimes() const;
+    size_t getPointCount() const;
+    size_t getSegmentCount() const;               ///< Number of segments, 0 for fewer than two points.
+    float getTotalLength() const;
+    float getTotalDuration() const;               ///< 0 without timestamps.
+    glm::vec3 getBoundsMin() const;
+    glm::vec3 getBoundsMax() const;
+
+    /**
+     * @brief Gets the length of one segment.
+     * @param segment Segment index.
+     * @return Distance between its two points.
+     */
+    float getSegmentLength(size_t segment) const;
+
+    /**
+     * @brief Finds the segment containing a distance.
+     * The hint and the segment after it are checked first, so small forward moves are O(1);
+     * anything else is a binary search.
+     * @param distance Distance along the path, clamped to the path.
+     * @param hint Segment the caller was last on.
+     * @return Segment index.
+     */
+    size_t findSegment(float distance, size_t hint = 0) const;
+
+    /**
+     * @brief Converts a recorded time to a distance along the path in O(log n).
+     * @param time Seconds since the first point.
+     * @return Distance, interpolated within the segment.
+     */
+    float distanceAtTime(float time) const;
+
+    /**
+     * @brief Converts a distance along the path to a recorded time.
+     * @param distance Distance along the path.
+     * @param segment Segment containing the distance.
+     * @return Seconds since the first point, interpolated within the segment.
+     */
+    float timeAtDistance(float distance, size_t segment) const;
+
+private:
+    PathData() = default;
+
+    std::vector<glm::vec3> points;
+    std::vector<float> cumulativeDistances;
+    std::vector<float> times;
+    glm::vec3 boundsMin{ 0.0f };
+    glm::vec3 boundsMax{ 0.0f };
+    TrackStatistics statistics;
+};
+
+/**
+ * @brief Position of one mover along a PathData.
+ *
+ * Holds no reference to the path; the owner passes the path in, so a cursor is two numbers.
+ */
+struct PathCursor {
+    float distance = 0.0f;  ///< Distance from the start of the path.
+    uint32_t segment = 0;   ///< Segment containing distance.
+
+    /**
+     * @brief Moves to a distance, clamped to the path.
+     */
+    void moveTo(const PathData& path, float newDistance);
+
+    /**
+     * @brief Moves to a fraction of a given segment.
+     */
+    void moveToSegment(const PathData& path, size_t newSegment, float fraction);
+
+    /**
+     * @brief Gets how far along the current segment the cursor is, in [0, 1].
+     */
+    float getSegmentFraction(const PathData& path) const;
+
+    /**
+     * @brief Gets the interpolated point at the cursor.
+     */
+    glm::vec3 getPosition(const PathData& path) const;
+};
@@ -0,0 +1,195 @@
+// ProgramCache.cpp
+
+#include "ProgramCache.h"
+#include <GLFW/glfw3.h>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Program binary enums are GL 4.1 / ARB_get_program_binary, past what the loader header defines
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+    const char MAGIC[8] = { 'S', 'P', 'V', 'R', 'P', 'R', 'O', 'G' };
+    const uint32_t VERSION = 1;
+
+    uint64_t hashBytes(uint64_t value, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            value ^= bytes[i];
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+    uint64_t hashString(uint64_t value, const char* text) {
+        // The terminator goes into the hash too, so "ab" + "c" and "a" + "bc" differ
+        return hashBytes(value, text ? text : "", text ? std::strlen(text) + 1 : 1);
+    }
+}
+
+/**
+ * @brief Retrieves the singleton instance of the ProgramCache.
+ */
+ProgramCache& ProgramCache::getInstance() {
+    static ProgramCache instance;
+    return instance;
+}
+
+ProgramCache::ProgramCache()
+    : getProgramBinary(nullptr), programBinary(nullptr), programParameteri(nullptr),
+    checked(false), supported(false), directory("shadercache/") {}
+
+void ProgramCache::loadFunctions() {
+    checked = true;
+    getProgramBinary = reinterpret_cast<GetProgramBinaryFunction>(glfwGetProcAddress("glGetProgramBinary"));
+    programBinary = reinterpret_cast<ProgramBinaryFunction>(glfwGetProcAddress("glProgramBinary"));
+    programParameteri = reinterpret_cast<ProgramParameteriFunction>(glfwGetProcAddress("glProgramParameteri"));
+    if (!getProgramBinary || !programBinary || !programParameteri) {
+        return;
+    }
+
+    // A driver may export the functions and still offer no format to save in
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    while (glGetError() != GL_NO_ERROR) {}
+    supported = formats > 0;
+    if (!supported) {
+        std::cout << "INFO: Driver offers no program binary formats, shaders compile every run" << std::endl;
+    }
+}
+
+bool ProgramCache::isSupported() {
+    if (!checked) {
+        loadFunctions();
+    }
+    return supported;
+}
+
+void ProgramCache::setDirectory(const std::string& path) {
+    directory = path;
+}
+
+uint64_t ProgramCache::makeKey(const std::string& vertexSource, const std::string& fragmentSource) const {
+    uint64_t key = 14695981039346656037ull;
+    key = hashString(key, vertexSource.c_str());
+    key = hashString(key, fragmentSource.c_str());
+    key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+    key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    key = hashString(key, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    return key;
+}
+
+std::string ProgramCache::getPath(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+bool ProgramCache::load(uint64_t key, GLuint program) {
+    if (!isSupported()) {
+        return false;
+    }
+
+    std::string path = getPath(key);
+    std::ifstream file(path, std::ios::binary);
+    Header header;
+    if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.key != key) {
+        ++statistics.misses;
+        return false;
+    }
+
+    // A corrupted size must not reach the allocation, and the driver takes the length as a GLsizei
+    std::error_code error;
+    uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error || header.size == 0 || header.size > fileSize - sizeof(header) || header.size > INT_MAX) {
+        ++statistics.misses;
+        return false;
+    }
+
+    std::vector<char> binary(static_cast<size_t>(header.size));
+    if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) {
+        ++statistics.misses;
+        return false;
+    }
+
+    programBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        ++statistics.rejected;
+        return false;
+    }
+    ++statistics.hits;
+    return true;
+}
+
+void ProgramCache::prepare(GLuint program) {
+    if (isSupported()) {
+        programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ProgramCache::store(uint64_t key, GLuint program) {
+    if (!isSupported()) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum format = 0;
+    getProgramBinary(program, length, &length, &format, binary.data());
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.format = format;
+    header.key = key;
+    header.size = static_cast<uint64_t>(length);
+
+    // Written aside and renamed, so a crash mid-write never leaves a truncated binary behind
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string path = getPath(key);
+    std::string temporaryPath = path + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        written = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+            file.write(binary.data(), length);
+    }
+    // The stream is closed by now, so the partial file can be removed on every platform
+    if (!written) {
+        std::cerr << "ERROR::PROGRAM_CACHE::WRITE_FAILED: " << temporaryPath << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::cerr << "ERROR::PROGRAM_CACHE::WRITE_FAILED: " << path << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return;
+    }
+    ++statistics.stores;
+}
+
+const ProgramCache::Statistics& ProgramCache::getStatistics() const {
+    return statistics;
+}
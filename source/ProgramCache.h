@@ -0,0 +1,125 @@
+// ProgramCache.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class ProgramCache
+ * @brief Keeps linked shader programs on disk as driver binaries, so later runs skip GLSL compilation.
+ *
+ * A program is stored under a key hashed from its sources and the GL vendor, renderer and version
+ * strings, so a driver update or a shader edit misses instead of loading a stale binary. Drivers
+ * may still reject a binary they wrote themselves, for example after a change the version string
+ * does not show; Shader then compiles from source and stores the new binary over the old one.
+ * Does nothing on drivers that offer no program binary formats.
+ */
+class ProgramCache {
+public:
+    /**
+     * @brief Lookup counters since startup.
+     */
+    struct Statistics {
+        size_t hits = 0;        ///< Programs loaded from a binary.
+        size_t misses = 0;      ///< Programs with no binary on disk.
+        size_t rejected = 0;    ///< Binaries found on disk that the driver refused.
+        size_t stores = 0;      ///< Binaries written.
+    };
+
+    /**
+     * @brief Retrieves the singleton instance of the ProgramCache.
+     * @return Reference to the ProgramCache instance.
+     */
+    static ProgramCache& getInstance();
+
+    /**
+     * @brief Checks if the driver can save and load program binaries. Needs a current GL context.
+     * @return True if supported.
+     */
+    bool isSupported();
+
+    /**
+     * @brief Sets the directory the binaries are kept in.
+     * @param path Directory, created on the first store.
+     */
+    void setDirectory(const std::string& path);
+
+    /**
+     * @brief Builds the cache key of a program from its sources and the current driver.
+     * @param vertexSource Vertex shader source.
+     * @param fragmentSource Fragment shader source.
+     * @return Key.
+     */
+    uint64_t makeKey(const std::string& vertexSource, const std::string& fragmentSource) const;
+
+    /**
+     * @brief Loads a cached binary into a program.
+     * @param key Key from makeKey().
+     * @param program Program object with no shaders attached.
+     * @return True if the program is linked from the binary; false on a miss or if the driver refused it.
+     */
+    bool load(uint64_t key, GLuint program);
+
+    /**
+     * @brief Writes the binary of a linked program.
+     * @param key Key from makeKey().
+     * @param program Program linked with prepare() called before the link.
+     */
+    void store(uint64_t key, GLuint program);
+
+    /**
+     * @brief Asks the driver to keep the binary of a program retrievable. Call before linking.
+     * @param program Program object.
+     */
+    void prepare(GLuint program);
+
+    /**
+     * @brief Gets the hit and miss counters.
+     * @return Counters since startup.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+    // Private Constructor for Singleton
+    ProgramCache();
+
+    // Delete copy constructor and assignment operator
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    /**
+     * @brief Header written before each binary.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t format;        ///< Driver binary format.
+        uint64_t key;           ///< Key the binary was stored under.
+        uint64_t size;          ///< Bytes of binary after the header.
+    };
+
+    /**
+     * @brief Resolves the program binary entry points, which the GL 3.3 loader does not cover.
+     */
+    void loadFunctions();
+
+    /**
+     * @brief Gets the file a key is stored in.
+     */
+    std::string getPath(uint64_t key) const;
+
+    typedef void (APIENTRYP GetProgramBinaryFunction)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    typedef void (APIENTRYP ProgramBinaryFunction)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    typedef void (APIENTRYP ProgramParameteriFunction)(GLuint program, GLenum pname, GLint value);
+
+    GetProgramBinaryFunction getProgramBinary;
+    ProgramBinaryFunction programBinary;
+    ProgramParameteriFunction programParameteri;
+    bool checked;                   ///< Entry points and formats have been queried.
+    bool supported;
+    std::string directory;
+    Statistics statistics;
+};
@@ -0,0 +1,138 @@
+// RenderQueue.cpp
+
+#include "RenderQueue.h"
+#include "GLStateCache.h"
+#include <array>
+#include <cstring>
+
+uint64_t RenderQueue::makeKey(Pass pass, GLuint program, float depth) {
+    // The bits of a non-negative float order the same way as its value
+    uint32_t depthBits = 0;
+    if (depth > 0.0f) {
+        std::memcpy(&depthBits, &depth, sizeof(depthBits));
+    }
+
+    uint64_t key = static_cast<uint64_t>(pass) << 60;
+    uint64_t programBits = program & 0xFFFu;
+    if (pass == Pass::BLENDED) {
+        key |= static_cast<uint64_t>(~depthBits) << 12;
+        key |= programBits;
+    }
+    else {
+        key |= programBits << 32;
+        key |= depthBits;
+    }
+    return key;
+}
+
+void RenderQueue::begin(const glm::mat4& view) {
+    viewMatrix = view;
+    packets.clear();
+}
+
+void RenderQueue::submit(Pass pass, const Shader* shader, const glm::vec3& position, bool cullBackFaces, std::function<void()> draw) {
+    // The camera looks down -z in view space
+    float depth = -(viewMatrix * glm::vec4(position, 1.0f)).z;
+    GLuint program = shader ? shader->getProgramID() : 0;
+    packets.push_back({ makeKey(pass, program, depth), shader, cullBackFaces, std::move(draw) });
+}
+
+void RenderQueue::sortKeys() {
+    size_t count = packets.size();
+    keys.resize(count);
+    order.resize(count);
+    scratchKeys.resize(count);
+    scratchOrder.resize(count);
+
+    // One read of the keys builds the histograms of all eight bytes
+    std::array<std::array<uint32_t, 256>, 8> histograms = {};
+    for (size_t i = 0; i < count; ++i) {
+        keys[i] = packets[i].key;
+        order[i] = static_cast<uint32_t>(i);
+        for (int byte = 0; byte < 8; ++byte) {
+            ++histograms[byte][(keys[i] >> (byte * 8)) & 0xFF];
+        }
+    }
+    if (count < 2) {
+        return;
+    }
+
+    for (int byte = 0; byte < 8; ++byte) {
+        std::array<uint32_t, 256>& histogram = histograms[byte];
+        // Every key has the same value in this byte, so the pass would not move anything
+        if (histogram[(keys[0] >> (byte * 8)) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t& bucket : histogram) {
+            uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t& slot = histogram[(keys[i] >> (byte * 8)) & 0xFF];
+            scratchKeys[slot] = keys[i];
+            scratchOrder[slot] = order[i];
+            ++slot;
+        }
+        keys.swap(scratchKeys);
+        order.swap(scratchOrder);
+    }
+}
+
+void RenderQueue::applyPass(Pass pass) {
+    GLStateCache& state = GLStateCache::getInstance();
+    bool blended = pass == Pass::BLENDED;
+    state.setEnabled(GL_BLEND, blended);
+    if (blended) {
+        state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    state.setDepthMask(!blended);
+    state.setDepthFunc(pass == Pass::SKY ? GL_LEQUAL : GL_LESS);
+}
+
+void RenderQueue::execute() {
+    statistics = Statistics();
+    sortKeys();
+
+    GLStateCache& state = GLStateCache::getInstance();
+    state.setEnabled(GL_DEPTH_TEST, true);
+    state.setCullFace(GL_BACK);
+
+    bool first = true;
+    Pass currentPass = Pass::SOLID;
+    const Shader* currentShader = nullptr;
+    for (uint32_t index : order) {
+        const DrawPacket& packet = packets[index];
+        Pass pass = static_cast<Pass>(packet.key >> 60);
+        if (first || pass != currentPass) {
+            applyPass(pass);
+            currentPass = pass;
+            ++statistics.passChanges;
+        }
+        state.setEnabled(GL_CULL_FACE, packet.cullBackFaces);
+        if (packet.shader && packet.shader != currentShader) {
+            packet.shader->use();
+            ++statistics.programChanges;
+        }
+        first = false;
+
+        packet.draw();
+        // A callback without a shader binds one the queue does not know about, and runs draw code
+        // written without the queue in mind, so the pass state is put back after it
+        currentShader = packet.shader;
+        if (!packet.shader) {
+            applyPass(pass);
+        }
+        ++statistics.packets;
+    }
+
+    // glClear honours the depth mask, so next frame has to start from the solid state
+    applyPass(Pass::SOLID);
+    state.setEnabled(GL_CULL_FACE, false);
+}
+
+const RenderQueue::Statistics& RenderQueue::getStatistics() const {
+    return statistics;
+}
@@ -0,0 +1,108 @@
+// RenderQueue.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Shader.h"
+
+/**
+ * @class RenderQueue
+ * @brief Collects a frame's draws as packets, sorts them by a 64-bit key and submits them in that order.
+ *
+ * A key holds, from the top bit down, the pass, then for solid and sky packets the program and the
+ * view depth, so program changes are grouped and each group is drawn front to back. Blended packets
+ * put the inverted depth right after the pass instead, so they are drawn back to front whatever
+ * their program. Keys are sorted with a stable LSD radix sort, so the cost stays linear in the
+ * packet count. Draw callbacks that change blending, depth writes or the depth function have
+ * to put them back. Pass state and culling are set through GLStateCache only when they change.
+ */
+class RenderQueue {
+public:
+    /**
+     * @brief Passes in the order they are drawn.
+     */
+    enum class Pass : uint8_t {
+        SOLID,      ///< Opaque geometry, depth tested and written.
+        SKY,        ///< Drawn at the far plane after the solid pass, so it is only shaded where nothing covers it.
+        BLENDED     ///< Alpha blended, depth tested but not written.
+    };
+
+    /**
+     * @brief One draw: its sort key, the state it needs and the callback that issues it.
+     */
+    struct DrawPacket {
+        uint64_t key;
+        const Shader* shader;       ///< Made current before the draw; null if the callback binds its own.
+        bool cullBackFaces;
+        std::function<void()> draw;
+    };
+
+    /**
+     * @brief Counts of the last execute().
+     */
+    struct Statistics {
+        size_t packets = 0;         ///< Packets drawn.
+        size_t programChanges = 0;  ///< Times a packet's program differed from the previous packet's.
+        size_t passChanges = 0;     ///< Times the pass state was set.
+    };
+
+    /**
+     * @brief Builds a sort key.
+     * @param pass Pass of the draw.
+     * @param program Program ID; only the low 12 bits are used.
+     * @param depth View depth; negative depths count as 0.
+     * @return Key ordering the draw within the frame.
+     */
+    static uint64_t makeKey(Pass pass, GLuint program, float depth);
+
+    /**
+     * @brief Drops last frame's packets and sets the view that submit() measures depth in.
+     * @param view View matrix of the frame.
+     */
+    void begin(const glm::mat4& view);
+
+    /**
+     * @brief Queues a draw.
+     * @param pass Pass of the draw.
+     * @param shader Program the draw uses, or null if the callback binds its own.
+     * @param position World position the draw is sorted by.
+     * @param cullBackFaces True to draw with back faces culled.
+     * @param draw Callback issuing the draw; runs during execute().
+     */
+    void submit(Pass pass, const Shader* shader, const glm::vec3& position, bool cullBackFaces, std::function<void()> draw);
+
+    /**
+     * @brief Sorts the queued packets and draws them. Leaves the solid pass state set and culling off.
+     */
+    void execute();
+
+    /**
+     * @brief Gets the counts of the last execute().
+     * @return Counters of the last frame.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+    /**
+     * @brief Sorts the keys and fills order with packet indices, smallest key first.
+     */
+    void sortKeys();
+
+    /**
+     * @brief Sets the blend, depth write and depth function state of a pass.
+     */
+    static void applyPass(Pass pass);
+
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    std::vector<DrawPacket> packets;
+    std::vector<uint64_t> keys;             ///< Sort keys, permuted along with order.
+    std::vector<uint32_t> order;            ///< Packet indices in draw order after sortKeys().
+    std::vector<uint64_t> scratchKeys;
+    std::vector<uint32_t> scratchOrder;
+    Statistics statistics;
+};
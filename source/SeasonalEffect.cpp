@@ -4,111 +4,80 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
-#include <GLFW/glfw3.h>  // For glfwGetTime()
 
 /**
- * @brief Constructor initializes shaders.
+ * @brief Constructor. Shaders are loaded in initialize, once a GL context exists.
  */
 SeasonalEffect::SeasonalEffect()
-    : currentSeason(Season::NONE),
-    snowShader("shaders/snowVert.glsl", "shaders/snowFrag.glsl"),
-    rainShader("shaders/rainVert.glsl", "shaders/rainFrag.glsl"),
-    quadVAO(0), quadVBO(0) {}
+    : currentSeason(Season::NONE), lastCameraPosition(0.0f) {}
 
 /**
  * @brief Initializes the seasonal effect system.
  */
 void SeasonalEffect::initialize(Season initialSeason) {
-    currentSeason = initialSeason;
-    setupQuad();
+    particleShader = std::make_unique<Shader>("shaders/particleVert.glsl", "shaders/particleFrag.glsl");
+    setSeason(initialSeason);
 }
 
 /**
- * @brief Sets up a fullscreen quad for rendering effects.
+ * @brief Gets the particle settings used for a season.
  */
-void SeasonalEffect::setupQuad() {
-    // Setup a simple quad to render the effect
-    float quadVertices[] = {
-        // positions      // texture Coords
-        -1.0f,  1.0f,     0.0f, 1.0f, // Top-left
-        -1.0f, -1.0f,     0.0f, 0.0f, // Bottom-left
-         1.0f, -1.0f,     1.0f, 0.0f, // Bottom-right
-
-        -1.0f,  1.0f,     0.0f, 1.0f, // Top-left
-         1.0f, -1.0f,     1.0f, 0.0f, // Bottom-right
-         1.0f,  1.0f,     1.0f, 1.0f  // Top-right
-    };
-
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
-
-    glBindVertexArray(quadVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
-
-    // Position attribute
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    // Texture Coord attribute
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+ParticleSystem::Settings SeasonalEffect::getParticleSettings(Season season) {
+    ParticleSystem::Settings settings;
+    if (season == Season::RAIN) {
+        // Fast, nearly straight drops drawn as thin streaks
+        settings.count = 60000;
+        settings.velocity = glm::vec3(0.5f, -9.0f, 0.2f);
+        settings.velocityJitter = glm::vec3(0.1f, 1.0f, 0.1f);
+        settings.size = 0.02f;
+        settings.streak = 0.6f;
+        settings.sway = 0.0f;
+        settings.color = glm::vec4(0.6f, 0.65f, 0.8f, 0.5f);
+    }
+    else {
+        // Slow flakes drifting from side to side
+        settings.count = 100000;
+        settings.velocity = glm::vec3(0.0f, -1.2f, 0.0f);
+        settings.velocityJitter = glm::vec3(0.3f, 0.4f, 0.3f);
+        settings.size = 0.08f;
+        settings.streak = 0.0f;
+        settings.sway = 0.4f;
+        settings.color = glm::vec4(1.0f, 1.0f, 1.0f, 0.8f);
+    }
+    return settings;
+}
 
-    glBindVertexArray(0);
+/**
+ * @brief Advances the particles of the current effect.
+ */
+void SeasonalEffect::update(float deltaTime, const glm::vec3& cameraPosition) {
+    lastCameraPosition = cameraPosition;
+    if (currentSeason != Season::NONE) {
+        particles.update(deltaTime, cameraPosition);
+    }
 }
 
 /**
  * @brief Renders the current seasonal effect.
  */
-void SeasonalEffect::render(const glm::mat4& view, const glm::mat4& projection) {
+void SeasonalEffect::render() {
     if (currentSeason == Season::NONE)
         return;
 
-    Shader* shader = nullptr;
-    if (currentSeason == Season::SNOW) {
-        shader = &snowShader;
-    }
-    else if (currentSeason == Season::RAIN) {
-        shader = &rainShader;
-    }
-
-    if (!shader || !shader->isLoaded()) {
+    if (!particleShader || !particleShader->isLoaded()) {
         std::cerr << "ERROR: Seasonal effect shader not loaded." << std::endl;
         return;
     }
 
-    shader->use();
-
-    // Set uniforms
-    float time = static_cast<float>(glfwGetTime());
-    shader->setFloat("time", time);
-    shader->setMat4("view", view);
-    shader->setMat4("projection", projection);
-
-    // Disable depth test to render over the entire scene
-    glDisable(GL_DEPTH_TEST);
-
-    // Render the quad
-    glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-
-    // Re-enable depth test
-    glEnable(GL_DEPTH_TEST);
+    particles.render(*particleShader);
 }
 
 /**
  * @brief Cleans up OpenGL resources.
  */
 void SeasonalEffect::cleanup() {
-    if (quadVAO) {
-        glDeleteVertexArrays(1, &quadVAO);
-        quadVAO = 0;
-    }
-    if (quadVBO) {
-        glDeleteBuffers(1, &quadVBO);
-        quadVBO = 0;
-    }
+    particles.cleanup();
+    particleShader.reset();
 }
 
 /**
@@ -116,4 +85,18 @@ void SeasonalEffect::cleanup() {
  */
 void SeasonalEffect::setSeason(Season newSeason) {
     currentSeason = newSeason;
+
+    // Particles only exist while an effect is active
+    if (currentSeason == Season::NONE) {
+        particles.cleanup();
+        return;
+    }
+    particles.initialize(getParticleSettings(currentSeason), lastCameraPosition);
+}
+
+/**
+ * @brief Gets the current season/effect.
+ */
+SeasonalEffect::Season SeasonalEffect::getSeason() const {
+    return currentSeason;
 }
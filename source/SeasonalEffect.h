@@ -5,11 +5,16 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <memory>
+#include "ParticleSystem.h"
 #include "Shader.h"
 
 /**
  * @class SeasonalEffect
  * @brief Manages seasonal visual effects like snow and rain.
+ *
+ * Both are world-space particle systems in a box around the camera, so they are hidden by the
+ * terrain and their cost depends on the particle count rather than the resolution.
  */
 class SeasonalEffect {
 public:
@@ -35,11 +40,16 @@ public:
     void initialize(Season initialSeason);
 
     /**
-     * @brief Renders the current seasonal effect.
-     * @param view View matrix.
-     * @param projection Projection matrix.
+     * @brief Advances the particles of the current effect.
+     * @param deltaTime Time elapsed since the last update.
+     * @param cameraPosition Camera position the particle box follows.
      */
-    void render(const glm::mat4& view, const glm::mat4& projection);
+    void update(float deltaTime, const glm::vec3& cameraPosition);
+
+    /**
+     * @brief Renders the current seasonal effect. Expects the blend state of RenderQueue's blended pass.
+     */
+    void render();
 
     /**
      * @brief Cleans up OpenGL resources.
@@ -52,17 +62,24 @@ public:
      */
     void setSeason(Season newSeason);
 
-private:
-    Season currentSeason;       ///< Current season/effect.
-    Shader snowShader;          ///< Shader for snow effect.
-    Shader rainShader;          ///< Shader for rain effect.
-
-    GLuint quadVAO, quadVBO;    ///< VAO and VBO for rendering fullscreen quad.
+    /**
+     * @brief Gets the current season/effect.
+     * @return The active season.
+     */
+    Season getSeason() const;
 
     /**
-     * @brief Sets up a fullscreen quad for rendering effects.
+     * @brief Gets the particle settings used for a season.
+     * @param season Snow or rain.
+     * @return Particle count, motion and appearance.
      */
-    void setupQuad();
+    static ParticleSystem::Settings getParticleSettings(Season season);
+
+private:
+    Season currentSeason;                       ///< Current season/effect.
+    std::unique_ptr<Shader> particleShader;     ///< Billboard shader shared by snow and rain.
+    ParticleSystem particles;                   ///< Particles of the current season.
+    glm::vec3 lastCameraPosition;               ///< Where the particle box was last centered.
 };
 
 #endif // SEASONALEFFECT_H
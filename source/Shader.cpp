@@ -1,6 +1,12 @@
 #include "Shader.h"
+#include "FrameUniforms.h"
+#include "GLStateCache.h"
+#include "ProgramCache.h"
+#include <GLFW/glfw3.h>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <string_view>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <glm/gtc/type_ptr.hpp>
@@ -8,8 +14,11 @@
 // Enable shader debugging output
 constexpr bool SHADER_DEBUG = true;
 
-Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
-    : programID(0), loaded(false) {
+bool Shader::asyncBuild = false;
+bool Shader::parallelCompile = false;
+
+Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& defines)
+    : programID(0), loaded(false), pending(false), vertexShader(0), fragmentShader(0), cacheKey(0) {
 
     if (SHADER_DEBUG) {
         std::cout << "INFO::SHADER::CREATING_SHADER: Vertex(" << vertexPath
@@ -17,82 +26,178 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
     }
 
     // Load shader source code from files
-    std::string vertexCode = loadShaderSource(vertexPath);
-    std::string fragmentCode = loadShaderSource(fragmentPath);
+    std::string vertexCode = preprocess(vertexPath, defines);
+    std::string fragmentCode = preprocess(fragmentPath, defines);
 
     if (vertexCode.empty() || fragmentCode.empty()) {
         std::cerr << "ERROR::SHADER::FAILED_TO_LOAD_SHADER_SOURCE\n";
         return;
     }
 
-    // Compile shaders
-    GLuint vertexShader = compileShader(vertexCode.c_str(), GL_VERTEX_SHADER);
-    GLuint fragmentShader = compileShader(fragmentCode.c_str(), GL_FRAGMENT_SHADER);
-
-    if (!vertexShader || !fragmentShader) {
-        std::cerr << "ERROR::SHADER::SHADER_COMPILATION_FAILED\n";
+    // A binary saved by an earlier run links without compiling any GLSL
+    ProgramCache& programCache = ProgramCache::getInstance();
+    cacheKey = programCache.makeKey(vertexCode, fragmentCode);
+    programID = glCreateProgram();
+    if (programCache.load(cacheKey, programID)) {
+        setupProgram();
+        if (SHADER_DEBUG) {
+            std::cout << "INFO::SHADER::PROGRAM_LOADED_FROM_CACHE\n";
+        }
         return;
     }
 
-    // Link shaders into a program
-    programID = glCreateProgram();
+    // Submit the compile and link; nothing below waits on the driver
+    vertexShader = compileShader(vertexCode.c_str(), GL_VERTEX_SHADER);
+    fragmentShader = compileShader(fragmentCode.c_str(), GL_FRAGMENT_SHADER);
     glAttachShader(programID, vertexShader);
     glAttachShader(programID, fragmentShader);
+    programCache.prepare(programID);
     glLinkProgram(programID);
+    pending = true;
+
+    if (!asyncBuild) {
+        finishBuild();
+    }
+}
+
+Shader::~Shader() {
+    if (pending) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+    }
+    if (programID > 0) {
+        GLStateCache::getInstance().deleteProgram(programID);
+    }
+}
+
+void Shader::setAsyncBuild(bool enabled) {
+    asyncBuild = enabled;
+    if (!enabled || parallelCompile) {
+        return;
+    }
+
+    // KHR and ARB parallel_shader_compile share their entry point and enums
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount && !parallelCompile; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        std::string_view name = extension ? extension : "";
+        parallelCompile = name == "GL_KHR_parallel_shader_compile" || name == "GL_ARB_parallel_shader_compile";
+    }
+    if (!parallelCompile) {
+        std::cout << "INFO: No parallel shader compile, asynchronous builds only defer error checks" << std::endl;
+        return;
+    }
+
+    typedef void (APIENTRYP MaxShaderCompilerThreadsFunction)(GLuint count);
+    auto maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (!maxShaderCompilerThreads) {
+        maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxShaderCompilerThreads) {
+        maxShaderCompilerThreads(0xFFFFFFFFu);  // As many threads as the driver likes
+    }
+}
+
+void Shader::finishBuild() const {
+    pending = false;
+
+    // Any of these queries waits for the driver if it is still compiling
+    checkCompileErrors(vertexShader, "VERTEX");
+    checkCompileErrors(fragmentShader, "FRAGMENT");
     checkCompileErrors(programID, "PROGRAM");
 
+    GLint linked = GL_FALSE;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linked);
+
     // Delete shader objects after linking
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    vertexShader = 0;
+    fragmentShader = 0;
 
-    loaded = true;
+    if (!linked) {
+        std::cerr << "ERROR::SHADER::SHADER_COMPILATION_FAILED\n";
+        return;
+    }
+    ProgramCache::getInstance().store(cacheKey, programID);
+    setupProgram();
 
     if (SHADER_DEBUG) {
         std::cout << "INFO::SHADER::PROGRAM_CREATED_SUCCESSFULLY\n";
     }
 }
 
-Shader::~Shader() {
-    if (programID > 0) {
-        glDeleteProgram(programID);
+void Shader::setupProgram() const {
+    // Per-frame camera and light values come from the shared uniform buffer
+    GLuint frameBlock = glGetUniformBlockIndex(programID, "FrameData");
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(programID, frameBlock, FrameUniforms::BINDING);
     }
+
+    resolveUniforms();
+    loaded = true;
 }
 
 void Shader::use() const {
+    if (pending) {
+        finishBuild();
+    }
     if (loaded) {
-        glUseProgram(programID);
+        GLStateCache::getInstance().useProgram(programID);
     }
     else {
         std::cerr << "ERROR::SHADER::PROGRAM_NOT_LOADED\n";
     }
 }
 
+GLuint Shader::getProgramID() const {
+    return programID;
+}
+
 bool Shader::isLoaded() const {
+    if (pending) {
+        finishBuild();
+    }
     return loaded;
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& matrix) const {
+void Shader::setMat4(UniformId name, const glm::mat4& matrix) const {
     GLint location = getUniformLocation(name);
     if (location != -1) {
         glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
     }
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& vector) const {
+void Shader::setVec2(UniformId name, const glm::vec2& vector) const {
+    GLint location = getUniformLocation(name);
+    if (location != -1) {
+        glUniform2fv(location, 1, glm::value_ptr(vector));
+    }
+}
+
+void Shader::setVec3(UniformId name, const glm::vec3& vector) const {
     GLint location = getUniformLocation(name);
     if (location != -1) {
         glUniform3fv(location, 1, glm::value_ptr(vector));
     }
 }
 
-void Shader::setFloat(const std::string& name, float value) const {
+void Shader::setVec4(UniformId name, const glm::vec4& vector) const {
+    GLint location = getUniformLocation(name);
+    if (location != -1) {
+        glUniform4fv(location, 1, glm::value_ptr(vector));
+    }
+}
+
+void Shader::setFloat(UniformId name, float value) const {
     GLint location = getUniformLocation(name);
     if (location != -1) {
         glUniform1f(location, value);
     }
 }
 
-void Shader::setInt(const std::string& name, int value) const {
+void Shader::setInt(UniformId name, int value) const {
     GLint location = getUniformLocation(name);
     if (location != -1) {
         glUniform1i(location, value);
@@ -106,31 +211,106 @@ std::string Shader::loadShaderSource(const std::string& filepath) const {
         return "";
     }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
+    // Size the string once and read the whole file straight into it
+    std::string source;
+    file.seekg(0, std::ios::end);
+    source.resize(static_cast<size_t>(std::max<std::streamoff>(file.tellg(), 0)));
+    file.seekg(0, std::ios::beg);
+    file.read(source.data(), static_cast<std::streamsize>(source.size()));
+    source.resize(static_cast<size_t>(file.gcount()));
 
     if (SHADER_DEBUG) {
         std::cout << "INFO::SHADER::LOADED_SOURCE_FROM: " << filepath << "\n";
     }
 
-    return buffer.str();
+    return source;
 }
 
-GLuint Shader::compileShader(const char* source, GLenum shaderType) const {
-    GLuint shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
+bool Shader::expandIncludes(const std::string& filepath, std::string& output, std::vector<std::string>& includeStack) const {
+    if (std::find(includeStack.begin(), includeStack.end(), filepath) != includeStack.end()) {
+        std::cerr << "ERROR::SHADER::RECURSIVE_INCLUDE: " << filepath << "\n";
+        return false;
+    }
+    std::string source = loadShaderSource(filepath);
+    if (source.empty()) {
+        return false;
+    }
+    includeStack.push_back(filepath);
 
-    checkCompileErrors(shader, shaderType == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT");
+    // #line keeps compiler messages pointing at the right line of each file
+    std::string directory = std::filesystem::path(filepath).parent_path().generic_string();
+    size_t lineNumber = 0;
+    size_t start = 0;
+    while (start < source.size()) {
+        size_t end = source.find('\n', start);
+        if (end == std::string::npos) {
+            end = source.size();
+        }
+        std::string_view line(source.data() + start, end - start);
+        start = end + 1;
+        ++lineNumber;
 
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        // Compilation failed; delete shader
-        glDeleteShader(shader);
-        return 0;
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string_view::npos || line.substr(first, 8) != "#include") {
+            output.append(line);
+            output += '\n';
+            continue;
+        }
+
+        size_t open = line.find('"', first);
+        size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+        if (close == std::string_view::npos) {
+            std::cerr << "ERROR::SHADER::BAD_INCLUDE: " << filepath << "(" << lineNumber << ")\n";
+            includeStack.pop_back();
+            return false;
+        }
+        std::string included(line.substr(open + 1, close - open - 1));
+        if (!directory.empty()) {
+            included = directory + "/" + included;
+        }
+
+        output += "#line 1\n";
+        if (!expandIncludes(included, output, includeStack)) {
+            includeStack.pop_back();
+            return false;
+        }
+        output += "#line " + std::to_string(lineNumber + 1) + "\n";
+    }
+
+    includeStack.pop_back();
+    return true;
+}
+
+std::string Shader::preprocess(const std::string& filepath, const std::vector<std::string>& defines) const {
+    std::string source;
+    std::vector<std::string> includeStack;
+    if (!expandIncludes(filepath, source, includeStack)) {
+        return "";
+    }
+    if (defines.empty()) {
+        return source;
     }
 
+    // Defines have to follow #version, which must come first
+    size_t version = source.find("#version");
+    size_t insertAt = version == std::string::npos ? 0 : source.find('\n', version);
+    insertAt = insertAt == std::string::npos ? source.size() : insertAt + 1;
+    size_t versionLine = static_cast<size_t>(std::count(source.begin(), source.begin() + insertAt, '\n'));
+
+    std::string block;
+    for (const std::string& define : defines) {
+        block += "#define " + define + "\n";
+    }
+    block += "#line " + std::to_string(versionLine + 1) + "\n";
+    source.insert(insertAt, block);
+    return source;
+}
+
+GLuint Shader::compileShader(const char* source, GLenum shaderType) const {
+    // Errors are checked in finishBuild, so an asynchronous build does not wait here
+    GLuint shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
     return shader;
 }
 
@@ -157,20 +337,58 @@ void Shader::checkCompileErrors(GLuint shader, const std::string& type) const {
     }
 }
 
-GLint Shader::getUniformLocation(const std::string& name) const {
-    // Check if the uniform location is cached
-    auto it = uniformCache.find(name);
-    if (it != uniformCache.end()) {
-        return it->second;
+void Shader::resolveUniforms() const {
+    // Every active uniform is looked up once here, so setters never call glGetUniformLocation
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<GLchar> name(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(programID, static_cast<GLuint>(i), static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+        GLint location = glGetUniformLocation(programID, name.data());
+        if (location == -1) {
+            continue;  // Member of a uniform block
+        }
+        uniformLocations.emplace_back(UniformId::makeHash(name.data(), length), location);
+
+        // Arrays are reported as "name[0]" but are set by their plain name too
+        if (std::string_view(name.data(), length).ends_with("[0]")) {
+            uniformLocations.emplace_back(UniformId::makeHash(name.data(), length - 3), location);
+        }
     }
 
-    // Retrieve the location from OpenGL
-    GLint location = glGetUniformLocation(programID, name.c_str());
-    if (location == -1 && SHADER_DEBUG) {
-        std::cerr << "WARNING::SHADER::UNIFORM_NOT_FOUND: " << name << "\n";
+    std::sort(uniformLocations.begin(), uniformLocations.end());
+    for (size_t i = 1; i < uniformLocations.size(); ++i) {
+        if (uniformLocations[i].first == uniformLocations[i - 1].first) {
+            std::cerr << "ERROR::SHADER::UNIFORM_HASH_COLLISION\n";
+        }
     }
+}
 
-    // Cache the location for future use
-    uniformCache[name] = location;
-    return location;
+GLint Shader::getUniformLocation(UniformId name) const {
+    if (pending) {
+        finishBuild();
+    }
+    auto it = std::lower_bound(uniformLocations.begin(), uniformLocations.end(), name.getHash(),
+        [](const std::pair<uint64_t, GLint>& entry, uint64_t hash) { return entry.first < hash; });
+    if (it != uniformLocations.end() && it->first == name.getHash()) {
+        return it->second;
+    }
+
+    // Not active in this program; warn once and remember it as missing
+    if (SHADER_DEBUG) {
+        if (name.getName()) {
+            std::cerr << "WARNING::SHADER::UNIFORM_NOT_FOUND: " << name.getName() << "\n";
+        }
+        else {
+            std::cerr << "WARNING::SHADER::UNIFORM_NOT_FOUND: hash " << std::hex << name.getHash() << std::dec << "\n";
+        }
+    }
+    uniformLocations.insert(it, { name.getHash(), -1 });
+    return -1;
 }
@@ -1,10 +1,52 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+/**
+ * @brief Name of a uniform, hashed at compile time when it is a string literal.
+ *
+ * The Shader setters take a UniformId, so setMat4("model", ...) builds no std::string and hashes
+ * nothing at run time. A std::string is still accepted for names made at run time; it is hashed on
+ * each call and not kept, so the id stays valid after the string is gone but has no name to print.
+ */
+class UniformId {
+public:
+    template <size_t N>
+    consteval UniformId(const char (&text)[N])
+        : hash(makeHash(text, N - 1)), name(text) {}
+
+    UniformId(const std::string& text)
+        : hash(makeHash(text.data(), text.size())), name(nullptr) {}
+
+    uint64_t getHash() const { return hash; }
+    const char* getName() const { return name; }     // Null when built from a std::string
+
+    /**
+     * @brief 64-bit FNV-1a hash of a name.
+     * @param text Characters of the name.
+     * @param length Number of characters.
+     * @return Hash.
+     */
+    static constexpr uint64_t makeHash(const char* text, size_t length) {
+        uint64_t value = 14695981039346656037ull;
+        for (size_t i = 0; i < length; ++i) {
+            value ^= static_cast<unsigned char>(text[i]);
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+private:
+    uint64_t hash;
+    const char* name;   ///< String literal the id was built from, used for warnings; null otherwise.
+};
+
 /**
  * @brief A class that encapsulates OpenGL shader program creation and usage.
  */
@@ -12,10 +54,15 @@ class Shader {
 public:
     /**
      * @brief Constructs a Shader object by loading and compiling vertex and fragment shaders.
+     *
+     * Sources may pull in other files with #include "file", resolved relative to the including file.
+     * Each define is inserted after the #version line, so code behind #ifdef is compiled out of
+     * permutations that leave it off.
      * @param vertexPath Path to the vertex shader source file.
      * @param fragmentPath Path to the fragment shader source file.
+     * @param defines Macros for this permutation, "NAME" or "NAME value".
      */
-    Shader(const std::string& vertexPath, const std::string& fragmentPath);
+    Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& defines = {});
 
     /**
      * @brief Destructor that cleans up the shader program.
@@ -28,26 +75,56 @@ public:
     void use() const;
 
     /**
-     * @brief Checks if the shader program was loaded successfully.
+     * @brief Checks if the shader program was loaded successfully. Waits for an asynchronous build.
      * @return True if loaded successfully, false otherwise.
      */
     bool isLoaded() const;
 
+    /**
+     * @brief Switches asynchronous building on or off for shaders created afterwards. Needs a current GL context.
+     *
+     * An asynchronous build submits the compile and link and returns; errors are checked, and the
+     * driver waited on, the first time the program is used or queried. With KHR_parallel_shader_compile
+     * the driver compiles on its own threads, so the work overlaps with whatever loads meanwhile.
+     * @param enabled True to defer waiting on builds.
+     */
+    static void setAsyncBuild(bool enabled);
+
+    /**
+     * @brief Gets the program ID, e.g. to sort draws by program. Valid while the build is still pending.
+     * @return OpenGL program ID.
+     */
+    GLuint getProgramID() const;
+
     // Uniform setters
-    void setMat4(const std::string& name, const glm::mat4& matrix) const;
-    void setVec3(const std::string& name, const glm::vec3& vector) const;
-    void setFloat(const std::string& name, float value) const;
-    void setInt(const std::string& name, int value) const;
+    void setMat4(UniformId name, const glm::mat4& matrix) const;
+    void setVec2(UniformId name, const glm::vec2& vector) const;
+    void setVec3(UniformId name, const glm::vec3& vector) const;
+    void setVec4(UniformId name, const glm::vec4& vector) const;
+    void setFloat(UniformId name, float value) const;
+    void setInt(UniformId name, int value) const;
 
 private:
     GLuint programID;  ///< OpenGL ID for the shader program.
-    bool loaded;       ///< Flag indicating if the shader was loaded successfully.
-    mutable std::unordered_map<std::string, GLint> uniformCache; ///< Cache for uniform locations.
+    mutable bool loaded;    ///< Flag indicating if the shader was loaded successfully.
+    mutable bool pending;   ///< Compile and link submitted but not yet checked.
+    mutable GLuint vertexShader;
+    mutable GLuint fragmentShader;
+    uint64_t cacheKey;      ///< Program cache key of the sources.
+    mutable std::vector<std::pair<uint64_t, GLint>> uniformLocations; ///< Name hash to location, sorted by hash.
+
+    static bool asyncBuild;
+    static bool parallelCompile;    ///< Driver reports completion without blocking.
 
     // Helper functions
     std::string loadShaderSource(const std::string& filepath) const;
+    bool expandIncludes(const std::string& filepath, std::string& output, std::vector<std::string>& includeStack) const;
+    std::string preprocess(const std::string& filepath, const std::vector<std::string>& defines) const;
     GLuint compileShader(const char* source, GLenum shaderType) const;
     void checkCompileErrors(GLuint shader, const std::string& type) const;
-    GLint getUniformLocation(const std::string& name) const;
+    void finishBuild() const;
+    void setupProgram() const;
+    void resolveUniforms() const;
+    GLint getUniformLocation(UniformId name) const;
 };
 
@@ -0,0 +1,36 @@
+// ShaderVariants.cpp
+
+#include "ShaderVariants.h"
+#include <cassert>
+
+ShaderVariants::ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& featureDefines)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), featureDefines(featureDefines), definedFeatures(0) {
+    // Masks are 32 bits wide, and shifting by 32 or more is undefined
+    assert(featureDefines.size() <= 32);
+    for (size_t i = 0; i < featureDefines.size() && i < 32; ++i) {
+        definedFeatures |= 1u << i;
+    }
+}
+
+Shader& ShaderVariants::get(uint32_t features) {
+    // Bits with no define would compile the same program again under another key
+    features &= definedFeatures;
+    auto found = variants.find(features);
+    if (found != variants.end()) {
+        return *found->second;
+    }
+
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < featureDefines.size() && i < 32; ++i) {
+        if (features & (1u << i)) {
+            defines.push_back(featureDefines[i]);
+        }
+    }
+    std::unique_ptr<Shader>& variant = variants[features];
+    variant = std::make_unique<Shader>(vertexPath, fragmentPath, defines);
+    return *variant;
+}
+
+size_t ShaderVariants::getVariantCount() const {
+    return variants.size();
+}
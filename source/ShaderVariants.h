@@ -0,0 +1,52 @@
+// ShaderVariants.h
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.h"
+
+/**
+ * @class ShaderVariants
+ * @brief Compiles permutations of one shader pair on demand, one per combination of features.
+ *
+ * Each feature is a preprocessor define. A permutation is named by a bit mask whose bit i turns on
+ * the i-th define, so code for features that are off is compiled out instead of skipped by a
+ * uniform branch. Only the masks actually requested are ever compiled, and each is compiled once.
+ */
+class ShaderVariants {
+public:
+    /**
+     * @brief Constructor. Nothing is compiled until a permutation is requested.
+     * @param vertexPath Path to the vertex shader source file.
+     * @param fragmentPath Path to the fragment shader source file.
+     * @param featureDefines Define for each feature bit, bit 0 first; at most 32.
+     */
+    ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& featureDefines);
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    /**
+     * @brief Gets a permutation, building it on first request.
+     * @param features Bit mask of the features to compile in; bits with no define are ignored.
+     * @return The permutation's shader; check isLoaded() for build errors.
+     */
+    Shader& get(uint32_t features);
+
+    /**
+     * @brief Gets the number of permutations built so far.
+     * @return Permutation count.
+     */
+    size_t getVariantCount() const;
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::string> featureDefines;
+    uint32_t definedFeatures;       ///< Mask of the bits that have a define.
+    std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants;     ///< Feature mask to built permutation.
+};
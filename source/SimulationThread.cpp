@@ -0,0 +1,156 @@
+// SimulationThread.cpp
+
+#include "SimulationThread.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    glm::vec3 blendPosition(const glm::vec3& previous, const glm::vec3& current, float alpha, float maxMoveSquared) {
+        glm::vec3 move = current - previous;
+        if (glm::dot(move, move) > maxMoveSquared) {
+            return current;
+        }
+        return previous + move * alpha;
+    }
+}
+
+void SimulationSnapshot::interpolate(const SimulationSnapshot& previous, const SimulationSnapshot& current,
+    float alpha, float maxMove, SimulationSnapshot& result) {
+    float maxMoveSquared = maxMove * maxMove;
+
+    result.step = current.step;
+    result.time = previous.time + (current.time - previous.time) * alpha;
+    result.hikerPosition = blendPosition(previous.hikerPosition, current.hikerPosition, alpha, maxMoveSquared);
+    result.hikerDistance = std::abs(current.hikerDistance - previous.hikerDistance) > maxMove
+        ? current.hikerDistance
+        : glm::mix(previous.hikerDistance, current.hikerDistance, alpha);
+    result.characterPosition = blendPosition(previous.characterPosition, current.characterPosition, alpha, maxMoveSquared);
+
+    // Hikers spawned or removed between the two steps have nothing to blend with
+    result.crowdPositions.resize(current.crowdPositions.size());
+    size_t blended = std::min(previous.crowdPositions.size(), current.crowdPositions.size());
+    for (size_t i = 0; i < blended; ++i) {
+        result.crowdPositions[i] = blendPosition(previous.crowdPositions[i], current.crowdPositions[i], alpha, maxMoveSquared);
+    }
+    std::copy(current.crowdPositions.begin() + blended, current.crowdPositions.end(), result.crowdPositions.begin() + blended);
+}
+
+SimulationThread::SimulationThread()
+    : running(false), stepCount(0), stepSeconds(1.0f / 60.0f),
+    previousIndex(0), currentIndex(1), writeIndex(2), published(false) {}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start(float stepSeconds, StepFunction step, CaptureFunction capture) {
+    stop();
+
+    this->stepSeconds = stepSeconds;
+    this->step = std::move(step);
+    this->capture = std::move(capture);
+    stepCount = 0;
+
+    // The initial state fills both published slots so there is something to draw before the first step
+    this->capture(snapshots[previousIndex]);
+    snapshots[currentIndex] = snapshots[previousIndex];
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        published = true;
+        publishTime = Clock::now();
+    }
+
+    running = true;
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(commandMutex);
+    pendingCommands.clear();
+}
+
+void SimulationThread::post(std::function<void()> command) {
+    if (!running) {
+        command();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(commandMutex);
+    pendingCommands.push_back(std::move(command));
+}
+
+void SimulationThread::run() {
+    const auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(stepSeconds));
+    Clock::time_point nextStep = Clock::now();
+
+    while (running) {
+        runCommands();
+        step(stepSeconds);
+        ++stepCount;
+        publish();
+
+        // Catch up after a short stall, but drop the backlog after a long one instead of spiralling
+        nextStep += stepDuration;
+        Clock::time_point now = Clock::now();
+        if (now - nextStep > stepDuration * 10) {
+            nextStep = now;
+        }
+        std::this_thread::sleep_until(nextStep);
+    }
+}
+
+void SimulationThread::runCommands() {
+    std::vector<std::function<void()>> commands;
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        commands.swap(pendingCommands);
+    }
+    for (auto& command : commands) {
+        command();
+    }
+}
+
+void SimulationThread::publish() {
+    // Written without the lock: the render thread never reads the write slot
+    SimulationSnapshot& snapshot = snapshots[writeIndex];
+    capture(snapshot);
+    snapshot.step = stepCount;
+    snapshot.time = static_cast<double>(stepCount) * stepSeconds;
+
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    int freed = previousIndex;
+    previousIndex = currentIndex;
+    currentIndex = writeIndex;
+    writeIndex = freed;
+    publishTime = Clock::now();
+}
+
+bool SimulationThread::getSnapshot(SimulationSnapshot& snapshot, float maxMove) const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    if (!published) {
+        return false;
+    }
+
+    // Drawn up to one step behind the simulation, so the blend never extrapolates
+    float sincePublish = std::chrono::duration<float>(Clock::now() - publishTime).count();
+    float alpha = std::clamp(sincePublish / stepSeconds, 0.0f, 1.0f);
+    SimulationSnapshot::interpolate(snapshots[previousIndex], snapshots[currentIndex], alpha, maxMove, snapshot);
+    return true;
+}
+
+bool SimulationThread::isRunning() const {
+    return running;
+}
+
+float SimulationThread::getStepSeconds() const {
+    return stepSeconds;
+}
+
+uint64_t SimulationThread::getStepCount() const {
+    return stepCount;
+}
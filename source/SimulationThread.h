@@ -0,0 +1,147 @@
+// SimulationThread.h
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Everything the renderer needs from one simulation step.
+ */
+struct SimulationSnapshot {
+    uint64_t step = 0;                          ///< Steps simulated before this snapshot.
+    double time = 0.0;                          ///< Simulated seconds.
+    glm::vec3 hikerPosition{ 0.0f };            ///< Hiker position.
+    float hikerDistance = 0.0f;                 ///< Hiker distance along its path.
+    glm::vec3 characterPosition{ 0.0f };        ///< Animated character position.
+    std::vector<glm::vec3> crowdPositions;      ///< Crowd hiker positions.
+
+    /**
+     * @brief Blends two snapshots of consecutive steps.
+     * Anything that moved further than maxMove in one step jumped (a seek or a loop back to the
+     * start of a track) and is taken from the newer snapshot instead of being dragged across.
+     * @param previous Older snapshot.
+     * @param current Newer snapshot.
+     * @param alpha Blend factor, 0 for previous and 1 for current.
+     * @param maxMove Largest distance still treated as continuous motion.
+     * @param result Blended snapshot; its vectors are reused between calls.
+     */
+    static void interpolate(const SimulationSnapshot& previous, const SimulationSnapshot& current,
+        float alpha, float maxMove, SimulationSnapshot& result);
+};
+
+/**
+ * @class SimulationThread
+ * @brief Runs the simulation at a fixed timestep on its own thread, decoupled from the frame rate.
+ *
+ * Each step drains the queued commands, advances the simulation by exactly one timestep and
+ * captures a snapshot. The two newest snapshots are kept for the render thread, which blends them
+ * by the wall time elapsed since the newer one was published; a third buffer is written while
+ * those two are read, so neither thread waits for the other longer than a swap or a blend.
+ *
+ * Because every step has the same length and input is applied only between steps, a run is
+ * reproducible from its commands regardless of how fast frames are drawn.
+ */
+class SimulationThread {
+public:
+    using StepFunction = std::function<void(float stepSeconds)>;
+    using CaptureFunction = std::function<void(SimulationSnapshot& snapshot)>;
+
+    /**
+     * @brief Constructor.
+     */
+    SimulationThread();
+
+    /**
+     * @brief Destructor that stops the thread.
+     */
+    ~SimulationThread();
+
+    /**
+     * @brief Captures the initial state and starts stepping.
+     * @param stepSeconds Fixed timestep.
+     * @param step Advances the simulation by one step; runs on the simulation thread.
+     * @param capture Copies the simulation state into a snapshot; runs on the simulation thread.
+     */
+    void start(float stepSeconds, StepFunction step, CaptureFunction capture);
+
+    /**
+     * @brief Stops stepping and joins the thread. Queued commands that have not run are dropped.
+     */
+    void stop();
+
+    /**
+     * @brief Queues a command to run on the simulation thread before the next step.
+     * Runs the command immediately when the thread is not running.
+     * @param command Callable that changes simulation state.
+     */
+    void post(std::function<void()> command);
+
+    /**
+     * @brief Gets the simulation state for the current frame, blended between the two newest steps.
+     * @param snapshot Receives the blended state.
+     * @param maxMove Largest per-step move that is interpolated rather than snapped.
+     * @return False if no snapshot has been published yet.
+     */
+    bool getSnapshot(SimulationSnapshot& snapshot, float maxMove) const;
+
+    /**
+     * @brief Checks if the simulation thread is running.
+     * @return True between start and stop.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Gets the fixed timestep.
+     * @return Seconds per step.
+     */
+    float getStepSeconds() const;
+
+    /**
+     * @brief Gets the number of steps simulated since start.
+     * @return Step count.
+     */
+    uint64_t getStepCount() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> stepCount;
+    float stepSeconds;
+    StepFunction step;
+    CaptureFunction capture;
+
+    std::mutex commandMutex;                        ///< Guards pendingCommands.
+    std::vector<std::function<void()>> pendingCommands;
+
+    mutable std::mutex snapshotMutex;               ///< Guards the published indices and publishTime.
+    SimulationSnapshot snapshots[3];                ///< Previous, current and the one being written.
+    int previousIndex;
+    int currentIndex;
+    int writeIndex;
+    bool published;                                 ///< True once two snapshots exist.
+    Clock::time_point publishTime;                  ///< When the current snapshot was published.
+
+    /**
+     * @brief Main loop of the simulation thread.
+     */
+    void run();
+
+    /**
+     * @brief Runs and clears the queued commands.
+     */
+    void runCommands();
+
+    /**
+     * @brief Captures the written snapshot and makes it the current one.
+     */
+    void publish();
+};
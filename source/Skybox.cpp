@@ -1,9 +1,10 @@
 // Skybox.cpp
 
 #include "Skybox.h"
-#include "../Linker/include/stb/stb_image.h"
+#include "GLStateCache.h"
+#include <cmath>
 #include <iostream>
-#include <vector>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -22,8 +23,9 @@ Skybox& Skybox::getInstance() {
 
 // Constructor
 Skybox::Skybox()
-    : VAO(0), VBO(0), cubemapTexture(0), cubemapLoaded(false),
-    skyboxShader("shaders/skyboxVert.glsl", "shaders/skyboxFrag.glsl") {}
+    : VAO(0), VBO(0), initialized(false),
+    skyboxShader("shaders/skyboxVert.glsl", "shaders/skyboxFrag.glsl"),
+    sunDirection(glm::normalize(glm::vec3(1.0f))), turbidity(2.5f), skyDirty(true) {}
 
 // Destructor
 Skybox::~Skybox() {
@@ -31,44 +33,15 @@ Skybox::~Skybox() {
 }
 
 /**
- * @brief Initializes the Skybox with the directory containing cubemap textures.
+ * @brief Creates the sky geometry and checks the sky shader.
  */
-bool Skybox::initialize(const std::string& directory) {
-    if (cubemapLoaded) {
+bool Skybox::initialize() {
+    if (initialized) {
         std::cerr << "WARNING: Skybox already initialized. Skipping redundant initialization." << std::endl;
         return true;
     }
 
-    std::cout << "INFO: Initializing Skybox VAO, VBO, and cubemap textures." << std::endl;
-
-    // Validate and fix the directory path
-    std::string correctedDirectory = directory;
-    if (directory.back() != '/' && directory.back() != '\\') {
-        correctedDirectory += '/';
-    }
-
-    // Define the cubemap faces in the correct order
-    std::vector<std::string> faces = {
-        correctedDirectory + "px.png", // Right
-        correctedDirectory + "nx.png", // Left
-        correctedDirectory + "py.png", // Top
-        correctedDirectory + "ny.png", // Bottom
-        correctedDirectory + "pz.png", // Front
-        correctedDirectory + "nz.png"  // Back
-    };
-
-    // Debugging: Print paths to verify correctness
-    std::cout << "INFO: Constructed cubemap faces paths:" << std::endl;
-    for (const auto& face : faces) {
-        std::cout << face << std::endl;
-    }
-
-    // Load the cubemap textures
-    cubemapTexture = loadCubemap(faces);
-    if (cubemapTexture == 0) {
-        std::cerr << "ERROR: Failed to load cubemap textures. Skybox initialization aborted." << std::endl;
-        return false;
-    }
+    std::cout << "INFO: Initializing Skybox VAO and VBO." << std::endl;
 
     // Define skybox vertices (cube)
     float skyboxVertices[] = {
@@ -132,7 +105,7 @@ bool Skybox::initialize(const std::string& directory) {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    GLStateCache::getInstance().bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), skyboxVertices, GL_STATIC_DRAW);
 
@@ -140,7 +113,7 @@ bool Skybox::initialize(const std::string& directory) {
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 
     // Verify if shader is loaded
     if (!skyboxShader.isLoaded()) {
@@ -148,33 +121,22 @@ bool Skybox::initialize(const std::string& directory) {
         return false;
     }
 
-    // Set the texture unit for the skybox shader
-    skyboxShader.use();
-    skyboxShader.setInt("skybox", 0);
-
-    cubemapLoaded = true;
+    initialized = true;
+    skyDirty = true;
     std::cout << "INFO: Skybox initialized successfully." << std::endl;
     return true;
 }
 
-void Skybox::render(const glm::mat4& view, const glm::mat4& projection) {
-    if (!cubemapLoaded) return;
+void Skybox::render() {
+    if (!initialized) return;
 
-    glDepthFunc(GL_LEQUAL);
     skyboxShader.use();
+    if (skyDirty) {
+        updateSkyModel();
+    }
 
-    // Set uniforms
-    skyboxShader.setMat4("view", view);
-    skyboxShader.setMat4("projection", projection);
-    skyboxShader.setMat4("model", glm::mat4(1.0f));  // Add model matrix uniform
-
-    glBindVertexArray(VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+    GLStateCache::getInstance().bindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-
-    glDepthFunc(GL_LESS);
 }
 
 /**
@@ -182,69 +144,88 @@ void Skybox::render(const glm::mat4& view, const glm::mat4& projection) {
  */
 void Skybox::cleanup() {
     if (VAO) {
-        glDeleteVertexArrays(1, &VAO);
+        GLStateCache::getInstance().deleteVertexArray(VAO);
         VAO = 0;
     }
     if (VBO) {
         glDeleteBuffers(1, &VBO);
         VBO = 0;
     }
-    if (cubemapTexture) {
-        glDeleteTextures(1, &cubemapTexture);
-        cubemapTexture = 0;
-    }
+    initialized = false;
     std::cout << "INFO: Skybox resources cleaned up." << std::endl;
 }
 
 /**
- * @brief Helper function to load cubemap textures.
+ * @brief Moves the sun, recomputing the sky model when it changed.
  */
-GLuint Skybox::loadCubemap(const std::vector<std::string>& faces) {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(false); // Ensure correct orientation
-    for (GLuint i = 0; i < faces.size(); i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-            GLenum format;
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-            else {
-                std::cerr << "ERROR: Unknown number of channels in texture: " << faces[i] << std::endl;
-                stbi_image_free(data);
-                glDeleteTextures(1, &textureID);
-                return 0;
-            }
-
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-
-            stbi_image_free(data);
-        }
-        else {
-            std::cerr << "ERROR: Cubemap texture failed to load at path: " << faces[i]
-                << " with reason: " << stbi_failure_reason() << std::endl;
-            stbi_image_free(data);
-            glDeleteTextures(1, &textureID); // Clean up partially loaded texture
-            return 0;
-        }
+void Skybox::setSunDirection(const glm::vec3& direction) {
+    glm::vec3 normalized = glm::normalize(direction);
+    if (normalized != sunDirection) {
+        sunDirection = normalized;
+        skyDirty = true;
     }
+}
 
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+/**
+ * @brief Sets how hazy the air is.
+ */
+void Skybox::setTurbidity(float value) {
+    if (value != turbidity) {
+        turbidity = value;
+        skyDirty = true;
+    }
+}
 
-    // Prevent seams
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+namespace {
+    /**
+     * @brief Perez et al. luminance distribution, relative to the zenith.
+     * @param coefficients A to E of one channel.
+     * @param cosTheta Cosine of the angle between the view direction and the zenith.
+     * @param gamma Angle between the view direction and the sun.
+     */
+    float perez(const float coefficients[5], float cosTheta, float gamma) {
+        float cosGamma = std::cos(gamma);
+        return (1.0f + coefficients[0] * std::exp(coefficients[1] / cosTheta)) *
+            (1.0f + coefficients[2] * std::exp(coefficients[3] * gamma) + coefficients[4] * cosGamma * cosGamma);
+    }
+}
 
-    return textureID;
+/**
+ * @brief Computes the Perez distribution coefficients and the zenith color for the current sun and haze.
+ */
+void Skybox::updateSkyModel() {
+    // Preetham, Shirley and Smits, "A Practical Analytic Model for Daylight", fits for luminance Y
+    // and chromaticity x, y. The model is only fitted for a sun above the horizon, so a sun below it
+    // is evaluated at the horizon and the sky is darkened instead.
+    const float T = turbidity;
+    const float coefficientsLuminance[5] = { 0.1787f * T - 1.4630f, -0.3554f * T + 0.4275f, -0.0227f * T + 5.3251f, 0.1206f * T - 2.5771f, -0.0670f * T + 0.3703f };
+    const float coefficientsChromaX[5] = { -0.0193f * T - 0.2592f, -0.0665f * T + 0.0008f, -0.0004f * T + 0.2125f, -0.0641f * T - 0.8989f, -0.0033f * T + 0.0452f };
+    const float coefficientsChromaY[5] = { -0.0167f * T - 0.2608f, -0.0950f * T + 0.0092f, -0.0079f * T + 0.2102f, -0.0441f * T - 1.6537f, -0.0109f * T + 0.0529f };
+
+    float thetaSun = std::acos(glm::clamp(sunDirection.y, 0.0f, 1.0f));
+    float theta2 = thetaSun * thetaSun;
+    float theta3 = theta2 * thetaSun;
+
+    float chi = (4.0f / 9.0f - T / 120.0f) * (glm::pi<float>() - 2.0f * thetaSun);
+    float zenithLuminance = (4.0453f * T - 4.9710f) * std::tan(chi) - 0.2155f * T + 2.4192f;
+    float zenithChromaX = T * T * (0.00166f * theta3 - 0.00375f * theta2 + 0.00209f * thetaSun) +
+        T * (-0.02903f * theta3 + 0.06377f * theta2 - 0.03202f * thetaSun + 0.00394f) +
+        (0.11693f * theta3 - 0.21196f * theta2 + 0.06052f * thetaSun + 0.25886f);
+    float zenithChromaY = T * T * (0.00275f * theta3 - 0.00610f * theta2 + 0.00317f * thetaSun) +
+        T * (-0.04214f * theta3 + 0.08970f * theta2 - 0.04153f * thetaSun + 0.00516f) +
+        (0.15346f * theta3 - 0.26756f * theta2 + 0.06670f * thetaSun + 0.26688f);
+
+    // Dividing by the distribution at the zenith leaves the shader one multiply per channel
+    glm::vec3 zenith(zenithLuminance / perez(coefficientsLuminance, 1.0f, thetaSun),
+        zenithChromaX / perez(coefficientsChromaX, 1.0f, thetaSun),
+        zenithChromaY / perez(coefficientsChromaY, 1.0f, thetaSun));
+
+    skyboxShader.setVec3("perezA", glm::vec3(coefficientsLuminance[0], coefficientsChromaX[0], coefficientsChromaY[0]));
+    skyboxShader.setVec3("perezB", glm::vec3(coefficientsLuminance[1], coefficientsChromaX[1], coefficientsChromaY[1]));
+    skyboxShader.setVec3("perezC", glm::vec3(coefficientsLuminance[2], coefficientsChromaX[2], coefficientsChromaY[2]));
+    skyboxShader.setVec3("perezD", glm::vec3(coefficientsLuminance[3], coefficientsChromaX[3], coefficientsChromaY[3]));
+    skyboxShader.setVec3("perezE", glm::vec3(coefficientsLuminance[4], coefficientsChromaX[4], coefficientsChromaY[4]));
+    skyboxShader.setVec3("zenith", zenith);
+    skyboxShader.setFloat("daylight", glm::smoothstep(-0.15f, 0.02f, sunDirection.y));
+    skyDirty = false;
 }
@@ -3,15 +3,17 @@
 #ifndef SKYBOX_H
 #define SKYBOX_H
 
-#include <string>
-#include <vector>
 #include <glm/glm.hpp>
 #include "Shader.h"
 #include <glad/glad.h>
 
 /**
  * @class Skybox
- * @brief Manages the skybox, including loading textures and rendering.
+ * @brief Renders an analytic sky lit by the sun.
+ *
+ * The sky radiance comes from the Preetham model, evaluated per pixel in skyboxFrag.glsl. The
+ * per-sun coefficients are computed here whenever the sun moves, so no sky textures are loaded and
+ * the sky follows the time of day.
  */
 class Skybox {
 public:
@@ -22,18 +24,28 @@ public:
     static Skybox& getInstance();
 
     /**
-     * @brief Initializes the Skybox with the directory containing cubemap textures.
-     * @param directory Path to the skybox textures directory.
+     * @brief Creates the sky geometry and checks the sky shader.
      * @return True if successful, false otherwise.
      */
-    bool initialize(const std::string& directory);
+    bool initialize();
 
     /**
-     * @brief Renders the Skybox.
-     * @param view View matrix without translation.
-     * @param projection Projection matrix.
+     * @brief Moves the sun, recomputing the sky model when it changed.
+     * @param direction Vector towards the sun, as Lighting::getSunDirection() gives it.
      */
-    void render(const glm::mat4& view, const glm::mat4& projection);
+    void setSunDirection(const glm::vec3& direction);
+
+    /**
+     * @brief Sets how hazy the air is.
+     * @param value Preetham turbidity, 2 for a clear mountain sky up to about 10 for haze.
+     */
+    void setTurbidity(float value);
+
+    /**
+     * @brief Renders the Skybox with the camera from the FrameData uniform block.
+     * The depth function must be GL_LEQUAL, as set by RenderQueue's sky pass.
+     */
+    void render();
 
     /**
      * @brief Cleans up OpenGL resources.
@@ -51,18 +63,19 @@ private:
 
     // Member Variables
     GLuint VAO, VBO;              ///< Vertex Array Object and Vertex Buffer Object.
-    GLuint cubemapTexture;        ///< Cubemap Texture ID.
-    bool cubemapLoaded;           ///< Flag indicating if the cubemap was loaded successfully.
+    bool initialized;             ///< Flag indicating if the Skybox was set up successfully.
     Shader skyboxShader;          ///< Shader program for the Skybox.
 
+    glm::vec3 sunDirection;       ///< Unit vector towards the sun.
+    float turbidity;              ///< Haze of the atmosphere.
+    bool skyDirty;                ///< The model coefficients need recomputing.
+
     static Skybox* instance;      ///< Singleton instance.
 
     /**
-     * @brief Helper function to load cubemap textures.
-     * @param faces Vector containing paths to the cubemap faces.
-     * @return Cubemap texture ID.
+     * @brief Computes the Perez distribution coefficients and the zenith color for the current sun and haze.
      */
-    GLuint loadCubemap(const std::vector<std::string>& faces);
+    void updateSkyModel();
 };
 
 #endif // SKYBOX_H
@@ -0,0 +1,238 @@
+// SnowAccumulation.cpp
+
+#include "SnowAccumulation.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+SnowAccumulation::SnowAccumulation()
+    : gridWidth(0), gridHeight(0), tileSize(64), tilesX(0), tilesZ(0),
+    snowTime(0.0), meltTime(0.0), nextTile(0), textureID(0) {}
+
+SnowAccumulation::~SnowAccumulation() {
+    cleanup();
+}
+
+bool SnowAccumulation::initialize(const Terrain& terrain, const Settings& settings, int tileSize) {
+    cleanup();
+
+    this->settings = settings;
+    this->tileSize = std::max(tileSize, 1);
+    gridWidth = terrain.getWidth();
+    gridHeight = terrain.getHeight();
+    if (gridWidth <= 0 || gridHeight <= 0) {
+        std::cerr << "ERROR::SNOW::TERRAIN_NOT_LOADED" << std::endl;
+        return false;
+    }
+
+    tilesX = (gridWidth + this->tileSize - 1) / this->tileSize;
+    tilesZ = (gridHeight + this->tileSize - 1) / this->tileSize;
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesZ;
+    depth.assign(static_cast<size_t>(gridWidth) * gridHeight, 0.0f);
+    tileSnowTime.assign(tileCount, 0.0);
+    tileMeltTime.assign(tileCount, 0.0);
+    tileStates.assign(tileCount, TileState::BARE);
+    dirtyTiles.assign(tileCount, 0);
+    snowTime = 0.0;
+    meltTime = 0.0;
+    nextTile = 0;
+
+    computeSnowfall(terrain);
+
+    glGenTextures(1, &textureID);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, gridWidth, gridHeight, 0, GL_RED, GL_FLOAT, depth.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+void SnowAccumulation::computeSnowfall(const Terrain& terrain) {
+    const std::vector<float>& heights = terrain.getHeights();
+    size_t stride = static_cast<size_t>(gridWidth) + 1;
+
+    // Summed-area table, so the mean height around every cell costs four lookups
+    std::vector<double> areaSums(stride * (gridHeight + 1), 0.0);
+    for (int z = 0; z < gridHeight; ++z) {
+        double rowSum = 0.0;
+        for (int x = 0; x < gridWidth; ++x) {
+            rowSum += heights[static_cast<size_t>(z) * gridWidth + x];
+            areaSums[(z + 1) * stride + x + 1] = areaSums[z * stride + x + 1] + rowSum;
+        }
+    }
+
+    snowfall.assign(depth.size(), 0.0f);
+    float spacing = 2.0f * terrain.getHorizontalScale();
+    int radius = std::max(settings.exposureRadius, 1);
+
+    ThreadPool::getInstance().parallelFor(static_cast<size_t>(gridHeight), [&](size_t begin, size_t end) {
+        for (int z = static_cast<int>(begin); z < static_cast<int>(end); ++z) {
+            int z0 = std::max(z - 1, 0);
+            int z1 = std::min(z + 1, gridHeight - 1);
+            int top = std::max(z - radius, 0);
+            int bottom = std::min(z + radius + 1, gridHeight);
+
+            for (int x = 0; x < gridWidth; ++x) {
+                int x0 = std::max(x - 1, 0);
+                int x1 = std::min(x + 1, gridWidth - 1);
+                float h = heights[static_cast<size_t>(z) * gridWidth + x];
+
+                // Central differences; edge cells reuse their own height, which only flattens the border
+                float dx = (heights[static_cast<size_t>(z) * gridWidth + x1] - heights[static_cast<size_t>(z) * gridWidth + x0]) / spacing;
+                float dz = (heights[static_cast<size_t>(z1) * gridWidth + x] - heights[static_cast<size_t>(z0) * gridWidth + x]) / spacing;
+                float slope = std::sqrt(dx * dx + dz * dz);
+                float sticking = 1.0f - std::clamp(slope / settings.maxSlope, 0.0f, 1.0f);
+
+                // Ground above the local mean is exposed to the wind, ground below it is sheltered
+                int left = std::max(x - radius, 0);
+                int right = std::min(x + radius + 1, gridWidth);
+                double sum = areaSums[bottom * stride + right] - areaSums[top * stride + right]
+                    - areaSums[bottom * stride + left] + areaSums[top * stride + left];
+                float mean = static_cast<float>(sum / ((bottom - top) * (right - left)));
+                float shelter = std::clamp(1.0f - (h - mean) * settings.exposureScale, 0.0f, 2.0f);
+
+                snowfall[static_cast<size_t>(z) * gridWidth + x] = sticking * sticking * shelter;
+            }
+        }
+    });
+}
+
+void SnowAccumulation::advanceTile(size_t tile) {
+    double snowing = snowTime - tileSnowTime[tile];
+    double melting = meltTime - tileMeltTime[tile];
+    tileSnowTime[tile] = snowTime;
+    tileMeltTime[tile] = meltTime;
+
+    // Snow on a full tile or melt on a bare one changes nothing
+    TileState state = tileStates[tile];
+    bool gains = snowing > 0.0 && state != TileState::FULL;
+    bool loses = melting > 0.0 && state != TileState::BARE;
+    if (!gains && !loses) {
+        return;
+    }
+
+    // The snowfall and melt since the last visit are applied in one go, snowfall first; clamping
+    // between them makes this approximate when both happened and a cell hits either limit
+    float gain = static_cast<float>(snowing * settings.snowfallRate);
+    float loss = static_cast<float>(melting * settings.meltRate);
+    int tileX = static_cast<int>(tile % tilesX);
+    int tileZ = static_cast<int>(tile / tilesX);
+    int xBegin = tileX * tileSize;
+    int zBegin = tileZ * tileSize;
+    int xEnd = std::min(xBegin + tileSize, gridWidth);
+    int zEnd = std::min(zBegin + tileSize, gridHeight);
+
+    bool changed = false;
+    bool covered = false;
+    bool growing = false;
+    for (int z = zBegin; z < zEnd; ++z) {
+        size_t row = static_cast<size_t>(z) * gridWidth;
+        for (int x = xBegin; x < xEnd; ++x) {
+            float previous = depth[row + x];
+            float share = snowfall[row + x];
+            float next = std::max(std::min(previous + gain * share, settings.maxDepth) - loss, 0.0f);
+            depth[row + x] = next;
+
+            changed |= next != previous;
+            covered |= next > 0.0f;
+            growing |= share > 0.0f && next < settings.maxDepth;
+        }
+    }
+
+    tileStates[tile] = !covered ? TileState::BARE : (growing ? TileState::PARTIAL : TileState::FULL);
+    if (changed) {
+        dirtyTiles[tile] = 1;
+    }
+}
+
+void SnowAccumulation::update(float deltaTime, bool snowing) {
+    if (depth.empty() || deltaTime <= 0.0f) {
+        return;
+    }
+    (snowing ? snowTime : meltTime) += deltaTime;
+
+    // Tiles are disjoint, so each task writes only its own cells
+    size_t tileCount = tileStates.size();
+    size_t batch = std::min(static_cast<size_t>(std::max(settings.tilesPerUpdate, 1)), tileCount);
+    size_t first = nextTile;
+    ThreadPool::getInstance().parallelFor(batch, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            advanceTile((first + i) % tileCount);
+        }
+    });
+    nextTile = (first + batch) % tileCount;
+}
+
+void SnowAccumulation::upload() {
+    if (textureID == 0) {
+        return;
+    }
+
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, textureID);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, gridWidth);
+
+    // Sub-rectangles are read straight out of the full grid
+    for (int tileZ = 0; tileZ < tilesZ; ++tileZ) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            uint8_t& dirty = dirtyTiles[static_cast<size_t>(tileZ) * tilesX + tileX];
+            if (!dirty) {
+                continue;
+            }
+            dirty = 0;
+
+            int x = tileX * tileSize;
+            int z = tileZ * tileSize;
+            int w = std::min(tileSize, gridWidth - x);
+            int h = std::min(tileSize, gridHeight - z);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, z, w, h, GL_RED, GL_FLOAT, depth.data() + static_cast<size_t>(z) * gridWidth + x);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void SnowAccumulation::reset() {
+    std::fill(depth.begin(), depth.end(), 0.0f);
+    std::fill(tileSnowTime.begin(), tileSnowTime.end(), snowTime);
+    std::fill(tileMeltTime.begin(), tileMeltTime.end(), meltTime);
+    std::fill(tileStates.begin(), tileStates.end(), TileState::BARE);
+    std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void SnowAccumulation::cleanup() {
+    if (textureID) {
+        GLStateCache::getInstance().deleteTexture(textureID);
+        textureID = 0;
+    }
+    depth.clear();
+    snowfall.clear();
+    tileSnowTime.clear();
+    tileMeltTime.clear();
+    tileStates.clear();
+    dirtyTiles.clear();
+}
+
+GLuint SnowAccumulation::getTexture() const {
+    return textureID;
+}
+
+float SnowAccumulation::getDepth(int x, int z) const {
+    if (x < 0 || z < 0 || x >= gridWidth || z >= gridHeight) {
+        return 0.0f;
+    }
+    return depth[static_cast<size_t>(z) * gridWidth + x];
+}
+
+const SnowAccumulation::Settings& SnowAccumulation::getSettings() const {
+    return settings;
+}
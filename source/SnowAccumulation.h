@@ -0,0 +1,143 @@
+// SnowAccumulation.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "Terrain.h"
+
+/**
+ * @class SnowAccumulation
+ * @brief Snow depth per heightmap cell that builds up while it snows and melts otherwise.
+ *
+ * The grid has one texel per heightmap vertex, like TrackHeatmap, so Terrain samples it from world
+ * position and blends toward the snowfall texture. How fast each cell gathers snow is worked out
+ * once from the heights: steep cells shed it and ridges standing above their surroundings are
+ * blown bare, while hollows collect more. Each update then only advances a few tiles, round robin,
+ * on the thread pool. A tile catches up on all the snowfall and melt since its last visit, so the
+ * result depends only loosely on how often it is visited: the two are applied one after the other
+ * rather than interleaved, so where a cell hits maxDepth or bare ground in between, a rarely visited
+ * tile ends up with somewhat more or less snow than an often visited one. Only tiles that changed
+ * are re-uploaded.
+ */
+class SnowAccumulation {
+public:
+    /**
+     * @brief How snow builds up and melts.
+     */
+    struct Settings {
+        float snowfallRate = 0.02f;     ///< Depth gained per second on flat, sheltered ground.
+        float meltRate = 0.01f;         ///< Depth lost per second while it is not snowing.
+        float maxDepth = 1.0f;          ///< Deepest the snow gets.
+        float maxSlope = 1.0f;          ///< Rise over run at which snow no longer sticks.
+        int exposureRadius = 8;         ///< Cells around a vertex its height is compared with.
+        float exposureScale = 0.15f;    ///< Change in snowfall per unit the ground stands above or below its surroundings.
+        int tilesPerUpdate = 32;        ///< Tiles advanced per update.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    SnowAccumulation();
+
+    /**
+     * @brief Destructor.
+     */
+    ~SnowAccumulation();
+
+    /**
+     * @brief Sizes the grid to match the terrain, works out the snowfall per cell and creates the texture.
+     * @param terrain Terrain whose heightmap grid the snow aligns with.
+     * @param settings Snowfall and melt settings.
+     * @param tileSize Edge length of the tiles the grid is updated and uploaded in.
+     * @return True if the texture was created.
+     */
+    bool initialize(const Terrain& terrain, const Settings& settings, int tileSize = 64);
+
+    /**
+     * @brief Advances the next batch of tiles. Call upload() to update the texture.
+     * @param deltaTime Time elapsed since the last update.
+     * @param snowing True while snow is falling, false while it melts.
+     */
+    void update(float deltaTime, bool snowing);
+
+    /**
+     * @brief Uploads the tiles changed since the last upload.
+     */
+    void upload();
+
+    /**
+     * @brief Clears all snow from the grid and the texture.
+     */
+    void reset();
+
+    /**
+     * @brief Cleans up OpenGL resources and the grid.
+     */
+    void cleanup();
+
+    /**
+     * @brief Gets the depth texture, one float depth per texel.
+     * @return OpenGL texture ID, 0 before initialize.
+     */
+    GLuint getTexture() const;
+
+    /**
+     * @brief Gets the snow depth of one cell.
+     * @param x Heightmap column.
+     * @param z Heightmap row.
+     * @return Snow depth, 0 outside the grid.
+     */
+    float getDepth(int x, int z) const;
+
+    /**
+     * @brief Gets the settings in use.
+     * @return Snowfall and melt settings.
+     */
+    const Settings& getSettings() const;
+
+private:
+    /**
+     * @brief What a tile held after its last visit, so settled tiles can be skipped.
+     */
+    enum class TileState : uint8_t {
+        BARE,       ///< No snow anywhere in the tile.
+        PARTIAL,    ///< Some cells can still gain or lose snow.
+        FULL        ///< Every cell that holds snow is at the maximum depth.
+    };
+
+    Settings settings;
+    int gridWidth;                      ///< Grid columns, the heightmap width.
+    int gridHeight;                     ///< Grid rows, the heightmap height.
+    int tileSize;                       ///< Tile edge length in cells.
+    int tilesX;                         ///< Tiles along x.
+    int tilesZ;                         ///< Tiles along z.
+
+    std::vector<float> depth;           ///< Snow depth per cell, row-major.
+    std::vector<float> snowfall;        ///< Share of the snowfall each cell keeps, from slope and exposure.
+
+    // Per tile
+    std::vector<double> tileSnowTime;   ///< Snowing clock when the tile was last advanced.
+    std::vector<double> tileMeltTime;   ///< Melting clock when the tile was last advanced.
+    std::vector<TileState> tileStates;
+    std::vector<uint8_t> dirtyTiles;    ///< Tiles changed since the last upload.
+
+    double snowTime;                    ///< Total seconds it has snowed.
+    double meltTime;                    ///< Total seconds it has not snowed.
+    size_t nextTile;                    ///< First tile of the next batch.
+
+    GLuint textureID;
+
+    /**
+     * @brief Works out the share of the snowfall each cell keeps.
+     * @param terrain Terrain to read the heights from.
+     */
+    void computeSnowfall(const Terrain& terrain);
+
+    /**
+     * @brief Applies the snowfall and melt since the tile's last visit.
+     * @param tile Tile index.
+     */
+    void advanceTile(size_t tile);
+};
@@ -1,13 +1,17 @@
 // Terrain.cpp
 
 #include "Terrain.h"
+#include "GLStateCache.h"
 #include "../Linker/include/stb/stb_image.h"
+#include <algorithm>
 #include <iostream>
 
 
 Terrain::Terrain()
     : width(0), height(0), heightScale(1.0f), horizontalScale(1.0f),
-    terrainVAO(0), terrainVBO(0), terrainEBO(0), textureID(0),
+    terrainVAO(0), terrainVBO(0), terrainEBO(0),
+    heatmapTexture(0), heatmapMaxDensity(0.0f), heatmapOpacity(0.6f),
+    snowDepthTexture(0), snowTexture(0), snowFullDepth(1.0f), virtualTexture(nullptr),
     textureRepeat(10.0f), maxHeight(0.0f), terrainShader(nullptr)
 {
 }
@@ -19,20 +23,44 @@ Terrain::~Terrain() {
 }
 
 
-void Terrain::setShader(Shader* shader) {
-    terrainShader = shader;
+void Terrain::setShader(ShaderVariants* shaders) {
+    terrainShader = shaders;
 }
 
-Shader* Terrain::getShader() const {
+ShaderVariants* Terrain::getShader() const {
     return terrainShader;
 }
 
+void Terrain::setHeatmap(GLuint texture, float maxDensity, float opacity) {
+    heatmapTexture = texture;
+    heatmapMaxDensity = maxDensity;
+    heatmapOpacity = opacity;
+}
+
+void Terrain::setSnow(GLuint depthTexture, GLuint snowTexture, float fullDepth) {
+    snowDepthTexture = depthTexture;
+    this->snowTexture = snowTexture;
+    snowFullDepth = fullDepth;
+}
+
+
+void Terrain::setVirtualTexture(const VirtualTexture* texture) {
+    virtualTexture = texture;
+}
+
+void Terrain::getBounds(glm::vec3& min, glm::vec3& max) const {
+    float halfWidth = (width - 1) * horizontalScale * 0.5f;
+    float halfDepth = (height - 1) * horizontalScale * 0.5f;
+    min = glm::vec3(-halfWidth, 0.0f, -halfDepth);
+    max = glm::vec3(halfWidth, maxHeight, halfDepth);
+}
+
 
 float Terrain::getMaxHeight() const {
     return maxHeight;
 }
 
-bool Terrain::loadHeightmap(const std::string& heightmapFile) {
+bool Terrain::loadHeightmap(const std::string& heightmapFile, bool createMesh) {
     // Load heightmap image
     int nrComponents;
     unsigned char* data = stbi_load(heightmapFile.c_str(), &width, &height, &nrComponents, 1);
@@ -80,8 +108,11 @@ bool Terrain::loadHeightmap(const std::string& heightmapFile) {
         }
     }
 
-    calculateNormals();
-    setupMesh();
+    // Headless runs only sample heights, so the normals and GL buffers can be skipped
+    if (createMesh) {
+        calculateNormals();
+        setupMesh();
+    }
 
     return true;
 }
@@ -90,40 +121,21 @@ bool Terrain::loadHeightmap(const std::string& heightmapFile) {
 // (For brevity, I will not repeat the code here, but make sure to include the full Terrain.cpp code from the previous response)
 
 
+void Terrain::setTexture(TextureHandle texture) {
+    colorTexture = std::move(texture);
+}
+
 bool Terrain::loadTexture(const std::string& textureFile) {
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // Texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Repeat wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // Repeat wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // Minification filter
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Magnification filter
-
-    // Load image using stb_image
-    int texWidth, texHeight, nrChannels;
-    unsigned char* data = stbi_load(textureFile.c_str(), &texWidth, &texHeight, &nrChannels, 0);
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        stbi_image_free(data);
-        std::cout << "INFO: Terrain texture loaded successfully." << std::endl;
-        return true;
-    }
-    else {
+    // Uses the precompressed .ktx2 next to the image when there is one
+    TextureHandle texture = AssetCache::getInstance().loadTexture(textureFile);
+    if (!texture) {
         std::cerr << "ERROR::TERRAIN::FAILED_TO_LOAD_TEXTURE: " << textureFile << std::endl;
-        stbi_image_free(data);
         return false;
     }
+
+    setTexture(std::move(texture));
+    std::cout << "INFO: Terrain texture loaded successfully." << std::endl;
+    return true;
 }
 
 void Terrain::calculateNormals() {
@@ -188,7 +200,7 @@ void Terrain::setupMesh() {
     glGenBuffers(1, &terrainVBO);
     glGenBuffers(1, &terrainEBO);
 
-    glBindVertexArray(terrainVAO);
+    GLStateCache::getInstance().bindVertexArray(terrainVAO);
 
     // Create vertex data
     struct Vertex {
@@ -222,38 +234,79 @@ void Terrain::setupMesh() {
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
 
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 }
 
 // Terrain.cpp
-void Terrain::render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition) {
+const std::vector<std::string>& Terrain::getShaderDefines() {
+    static const std::vector<std::string> defines = { "HEATMAP", "SNOW", "VIRTUAL_TEXTURE" };
+    return defines;
+}
+
+uint32_t Terrain::getShaderFeatures() const {
+    uint32_t features = 0;
+    if (heatmapTexture != 0 && heatmapOpacity > 0.0f) {
+        features |= FEATURE_HEATMAP;
+    }
+    if (snowDepthTexture != 0 && snowTexture != 0) {
+        features |= FEATURE_SNOW;
+    }
+    if (virtualTexture && virtualTexture->isOpen()) {
+        features |= FEATURE_VIRTUAL_TEXTURE;
+    }
+    return features;
+}
+
+void Terrain::render(const glm::mat4& model) {
     if (!terrainShader) {
         std::cerr << "ERROR: Terrain shader not set." << std::endl;
         return;
     }
 
-    // Use the terrain shader
-    terrainShader->use();
+    // Layers that are off are compiled out of the permutation rather than branched over
+    uint32_t features = getShaderFeatures();
+    Shader& shader = terrainShader->get(features);
+    shader.use();
 
     // Set uniforms
-    terrainShader->setMat4("model", model);
-    terrainShader->setMat4("view", view);
-    terrainShader->setMat4("projection", projection);
-    terrainShader->setVec3("viewPos", cameraPosition);
+    shader.setMat4("model", model);
+    shader.setFloat("shininess", 32.0f); // Adjust shininess
 
-    // Set lighting uniforms
-    terrainShader->setVec3("lightPos", glm::vec3(0.0f, 100.0f, 0.0f)); // Adjust light position
-    terrainShader->setFloat("shininess", 32.0f); // Adjust shininess
+    if (features & FEATURE_VIRTUAL_TEXTURE) {
+        virtualTexture->bind(shader, 4, 5);
+    }
+    else {
+        GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, colorTexture ? colorTexture->texture : 0);
+        shader.setInt("terrainTexture", 0);
+    }
 
-    // Bind texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    terrainShader->setInt("terrainTexture", 0);
+    // Heatmap and snow texel (x, z) sit on heightmap vertex (x, z), so they are addressed from world position
+    if (features & (FEATURE_HEATMAP | FEATURE_SNOW)) {
+        float halfWidth = (width - 1) * horizontalScale * 0.5f;
+        float halfDepth = (height - 1) * horizontalScale * 0.5f;
+        glm::vec2 texelsPerUnit(1.0f / (horizontalScale * width), 1.0f / (horizontalScale * height));
+        shader.setVec2("gridScale", texelsPerUnit);
+        shader.setVec2("gridOffset", glm::vec2(halfWidth, halfDepth) * texelsPerUnit + glm::vec2(0.5f / width, 0.5f / height));
+    }
+
+    if (features & FEATURE_HEATMAP) {
+        GLStateCache::getInstance().bindTexture(1, GL_TEXTURE_2D, heatmapTexture);
+        shader.setInt("heatmapTexture", 1);
+        shader.setFloat("heatmapMaxDensity", std::max(heatmapMaxDensity, 1.0f));
+        shader.setFloat("heatmapOpacity", heatmapOpacity);
+    }
+
+    if (features & FEATURE_SNOW) {
+        GLStateCache::getInstance().bindTexture(2, GL_TEXTURE_2D, snowDepthTexture);
+        shader.setInt("snowDepthTexture", 2);
+        GLStateCache::getInstance().bindTexture(3, GL_TEXTURE_2D, snowTexture);
+        shader.setInt("snowTexture", 3);
+        shader.setFloat("snowFullDepth", std::max(snowFullDepth, 1e-4f));
+    }
 
     // Draw the terrain
-    glBindVertexArray(terrainVAO);
+    GLStateCache::getInstance().bindVertexArray(terrainVAO);
     glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 
@@ -308,19 +361,54 @@ float Terrain::getHeightAtPosition(float x, float z) const {
     return interpolatedHeight;
 }
 
+void Terrain::getHeightsAtPositions(const glm::vec2* positions, size_t count, float* outHeights) const {
+    // Same bilinear lookup as getHeightAtPosition, with the grid constants hoisted out of the loop
+    // and the heights read from the packed height array instead of the interleaved positions
+    float invScale = 1.0f / horizontalScale;
+    float halfWidth = (width - 1) * horizontalScale * 0.5f;
+    float halfDepth = (height - 1) * horizontalScale * 0.5f;
+    float maxX = static_cast<float>(width - 1);
+    float maxZ = static_cast<float>(height - 1);
+
+    for (size_t i = 0; i < count; ++i) {
+        float localX = glm::clamp((positions[i].x + halfWidth) * invScale, 0.0f, maxX);
+        float localZ = glm::clamp((positions[i].y + halfDepth) * invScale, 0.0f, maxZ);
+
+        int x0 = static_cast<int>(localX);
+        int z0 = static_cast<int>(localZ);
+        int x1 = glm::min(x0 + 1, width - 1);
+        int z1 = glm::min(z0 + 1, height - 1);
+
+        float fx = localX - x0;
+        float fz = localZ - z0;
+
+        float h0 = glm::mix(heights[z0 * width + x0], heights[z0 * width + x1], fx);
+        float h1 = glm::mix(heights[z1 * width + x0], heights[z1 * width + x1], fx);
+        outHeights[i] = glm::mix(h0, h1, fz);
+    }
+}
+
+const std::vector<float>& Terrain::getHeights() const {
+    return heights;
+}
+
+glm::vec2 Terrain::worldToGrid(float x, float z) const {
+    float halfWidth = (width - 1) * horizontalScale * 0.5f;
+    float halfDepth = (height - 1) * horizontalScale * 0.5f;
+
+    return glm::vec2((x + halfWidth) / horizontalScale, (z + halfDepth) / horizontalScale);
+}
+
 void Terrain::cleanup() {
     if (terrainVAO != 0) {
-        glDeleteVertexArrays(1, &terrainVAO);
+        GLStateCache::getInstance().deleteVertexArray(terrainVAO);
         glDeleteBuffers(1, &terrainVBO);
         glDeleteBuffers(1, &terrainEBO);
         terrainVAO = 0;
         terrainVBO = 0;
         terrainEBO = 0;
     }
-    if (textureID != 0) {
-        glDeleteTextures(1, &textureID);
-        textureID = 0;
-    }
+    colorTexture.reset();
     positions.clear();
     normals.clear();
     indices.clear();
@@ -6,15 +6,25 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <vector>
-#include "Shader.h"
+#include "ShaderVariants.h"
+#include "AssetCache.h"
+#include "VirtualTexture.h"
 
 class Terrain {
 public:
+    // Permutation bits of the terrain shader, in the order of getShaderDefines()
+    enum ShaderFeature : uint32_t {
+        FEATURE_HEATMAP = 1u << 0,
+        FEATURE_SNOW = 1u << 1,
+        FEATURE_VIRTUAL_TEXTURE = 1u << 2
+    };
+
     Terrain();
     ~Terrain();
 
-    bool loadHeightmap(const std::string& heightmapFile);
+    bool loadHeightmap(const std::string& heightmapFile, bool createMesh = true); // createMesh false keeps only the height lookups, no GL context needed
     bool loadTexture(const std::string& textureFile);
+    void setTexture(TextureHandle texture); // Color texture shared through the asset cache
 
     void setHeightScale(float scale);
     void setHorizontalScale(float scale);
@@ -22,19 +32,29 @@ public:
     float getHorizontalScale() const;
 
     float getHeightAtPosition(float x, float z) const;
+    void getHeightsAtPositions(const glm::vec2* positions, size_t count, float* outHeights) const; // Batched lookup, positions are world (x, z)
+    glm::vec2 worldToGrid(float x, float z) const; // World (x, z) to fractional heightmap cell coordinates
+    const std::vector<float>& getHeights() const; // Scaled heightmap samples, row-major, width x height
 
-    void render(const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition);
+    void render(const glm::mat4& model); // Camera and light come from the FrameData uniform block
 
     void cleanup();
 
     int getWidth() const;
     int getHeight() const;
 
-    void setShader(Shader* shader); // Accept a pointer
-    Shader* getShader() const;      // Return a pointer
+    void setShader(ShaderVariants* shaders); // Permutations of terrainVert/terrainFrag built with getShaderDefines()
+    ShaderVariants* getShader() const;
+    static const std::vector<std::string>& getShaderDefines(); // Define of each ShaderFeature bit
+    uint32_t getShaderFeatures() const; // Permutation the layers set right now need
 
     float getMaxHeight() const; // Added getter for maximum height
 
+    void setHeatmap(GLuint texture, float maxDensity, float opacity = 0.6f); // Track density overlay aligned with the heightmap, texture 0 disables it
+    void setSnow(GLuint depthTexture, GLuint snowTexture, float fullDepth); // Snow depth aligned with the heightmap, blended toward snowTexture; depth texture 0 disables it
+    void setVirtualTexture(const VirtualTexture* texture); // Streamed image draped over the whole terrain in place of the color texture, nullptr disables it
+    void getBounds(glm::vec3& min, glm::vec3& max) const; // World box of the mesh
+
 private:
     int width;
     int height;
@@ -51,9 +71,19 @@ private:
     GLuint terrainVBO;
     GLuint terrainEBO;
 
-    GLuint textureID;
+    TextureHandle colorTexture;
+
+    GLuint heatmapTexture;
+    float heatmapMaxDensity;
+    float heatmapOpacity;
+
+    GLuint snowDepthTexture;
+    GLuint snowTexture;
+    float snowFullDepth; // Depth at which the ground is fully white
+
+    const VirtualTexture* virtualTexture;
 
-    Shader* terrainShader;
+    ShaderVariants* terrainShader;
 
     float maxHeight; // Stores the maximum height value
 
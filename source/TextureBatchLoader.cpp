@@ -0,0 +1,354 @@
+// TextureBatchLoader.cpp
+
+#include "TextureBatchLoader.h"
+#include "GLStateCache.h"
+#include "TextureCompressor.h"
+#include "ThreadPool.h"
+#include "../Linker/include/stb/stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    GLenum formatForChannels(int channels) {
+        switch (channels) {
+        case 1: return GL_RED;
+        case 2: return GL_RG;
+        case 3: return GL_RGB;
+        case 4: return GL_RGBA;
+        default: return 0;
+        }
+    }
+
+    bool supportsS3tc() {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount; ++i) {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+TextureBatchLoader::TextureBatchLoader()
+    : decodeSeconds(0.0), started(false), useCompressed(false) {}
+
+TextureBatchLoader::~TextureBatchLoader() {
+    // Workers write into this object, so none may still be running when it goes away
+    for (std::future<void>& decodeTask : decodes) {
+        decodeTask.wait();
+    }
+    for (Image& image : images) {
+        stbi_image_free(image.data);
+    }
+}
+
+size_t TextureBatchLoader::addTexture(const std::string& path, GLenum wrap) {
+    Request request;
+    request.target = GL_TEXTURE_2D;
+    request.wrap = wrap;
+    request.pendingImages = 1;
+    requests.push_back(request);
+
+    Image image;
+    image.path = path;
+    image.request = requests.size() - 1;
+    image.face = GL_TEXTURE_2D;
+    images.push_back(std::move(image));
+    return requests.size() - 1;
+}
+
+size_t TextureBatchLoader::addCubemap(const std::vector<std::string>& faces) {
+    Request request;
+    request.target = GL_TEXTURE_CUBE_MAP;
+    request.wrap = GL_CLAMP_TO_EDGE;
+    request.pendingImages = faces.size();
+    request.failed = faces.size() != 6;
+    requests.push_back(request);
+
+    for (size_t i = 0; i < faces.size(); ++i) {
+        Image image;
+        image.path = faces[i];
+        image.request = requests.size() - 1;
+        image.face = static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+        images.push_back(std::move(image));
+    }
+    return requests.size() - 1;
+}
+
+void TextureBatchLoader::start() {
+    if (started) {
+        return;
+    }
+    started = true;
+    startTime = std::chrono::steady_clock::now();
+    useCompressed = supportsS3tc();
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    decodes.reserve(images.size());
+    for (size_t i = 0; i < images.size(); ++i) {
+        decodes.push_back(pool.submit([this, i]() { decode(i); }));
+    }
+}
+
+void TextureBatchLoader::decode(size_t index) {
+    auto decodeStart = std::chrono::steady_clock::now();
+    Image& image = images[index];
+
+    // A precompressed copy only needs reading; one older than its image is ignored until recompressed
+    std::string compressedPath = TextureCompressor::getCompressedPath(image.path);
+    if (useCompressed && TextureCompressor::isUpToDate(image.path, compressedPath)) {
+        auto compressed = std::make_unique<KtxTexture>();
+        if (compressed->load(compressedPath)) {
+            image.width = compressed->getWidth();
+            image.height = compressed->getHeight();
+            image.channels = compressed->getFormat() == KtxTexture::Format::BC3 ? 4 : 3;
+            image.compressed = std::move(compressed);
+        }
+    }
+
+    if (!image.compressed) {
+        image.data = stbi_load(image.path.c_str(), &image.width, &image.height, &image.channels, 0);
+    }
+    if (!image.data && !image.compressed) {
+        std::cerr << "ERROR::TEXTURE::FAILED_TO_LOAD: " << image.path << " (" << stbi_failure_reason() << ")" << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - decodeStart).count();
+
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(index);
+        decodeSeconds += seconds;
+    }
+    completedCondition.notify_one();
+}
+
+bool TextureBatchLoader::prepareTexture(const Image& image, GLenum compressedFormat, size_t levelCount) {
+    Request& request = requests[image.request];
+    if (request.failed) {
+        return false;
+    }
+
+    // Cubemap faces must all match the first one uploaded
+    if (request.texture == 0) {
+        request.width = image.width;
+        request.height = image.height;
+        request.channels = image.channels;
+        request.compressedFormat = compressedFormat;
+        request.levelCount = levelCount;
+        glGenTextures(1, &request.texture);
+        return true;
+    }
+    if (image.width != request.width || image.height != request.height || image.channels != request.channels ||
+        compressedFormat != request.compressedFormat || levelCount != request.levelCount) {
+        std::cerr << "ERROR::TEXTURE::FACE_MISMATCH: " << image.path << std::endl;
+        request.failed = true;
+        return false;
+    }
+    return true;
+}
+
+void TextureBatchLoader::upload(Image& image, GLuint pixelBuffer) {
+    Request& request = requests[image.request];
+    GLenum format = formatForChannels(image.channels);
+    if (format == 0) {
+        request.failed = true;
+        return;
+    }
+    if (!prepareTexture(image, 0, 1)) {
+        return;
+    }
+
+    // The copy into the buffer is the only work on this thread; the driver moves it to the texture
+    GLsizeiptr size = static_cast<GLsizeiptr>(image.width) * image.height * image.channels;
+    const void* pixels = image.data;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        std::memcpy(mapped, image.data, static_cast<size_t>(size));
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        pixels = nullptr;
+    }
+    else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLStateCache::getInstance().bindTexture(0, request.target, request.texture);
+    glTexImage2D(image.face, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    timings.bytes += static_cast<size_t>(size);
+    request.bytes += static_cast<size_t>(size);
+}
+
+void TextureBatchLoader::uploadCompressed(Image& image, GLuint pixelBuffer) {
+    Request& request = requests[image.request];
+    const KtxTexture& compressed = *image.compressed;
+    if (!prepareTexture(image, compressed.getGLFormat(), compressed.getLevelCount())) {
+        return;
+    }
+
+    // Every level goes into one buffer back to back, then each is created from its offset
+    GLsizeiptr size = static_cast<GLsizeiptr>(compressed.getDataSize());
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    unsigned char* mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    bool staged = mapped != nullptr;
+    if (staged) {
+        size_t offset = 0;
+        for (size_t level = 0; level < compressed.getLevelCount(); ++level) {
+            std::memcpy(mapped + offset, compressed.getLevel(level).data(), compressed.getLevel(level).size());
+            offset += compressed.getLevel(level).size();
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    GLStateCache::getInstance().bindTexture(0, request.target, request.texture);
+    size_t offset = 0;
+    for (size_t level = 0; level < compressed.getLevelCount(); ++level) {
+        const std::vector<unsigned char>& blocks = compressed.getLevel(level);
+        const void* source = staged ? reinterpret_cast<const void*>(offset) : blocks.data();
+        glCompressedTexImage2D(image.face, static_cast<GLint>(level), compressed.getGLFormat(),
+            std::max(1, image.width >> level), std::max(1, image.height >> level), 0,
+            static_cast<GLsizei>(blocks.size()), source);
+        offset += blocks.size();
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    timings.bytes += static_cast<size_t>(size);
+    request.bytes += static_cast<size_t>(size);
+    ++timings.compressedCount;
+}
+
+void TextureBatchLoader::complete(Request& request) {
+    if (request.failed) {
+        if (request.texture) {
+            GLStateCache::getInstance().deleteTexture(request.texture);
+            request.texture = 0;
+        }
+        request.channels = 0;
+        request.bytes = 0;
+        return;
+    }
+
+    GLStateCache::getInstance().bindTexture(0, request.target, request.texture);
+    if (request.compressedFormat != 0) {
+        glTexParameteri(request.target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(request.levelCount - 1));
+    }
+    else if (request.channels == 1) {
+        // Grayscale images sample as gray rather than red
+        glTexParameteri(request.target, GL_TEXTURE_SWIZZLE_G, GL_RED);
+        glTexParameteri(request.target, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+    if (request.target == GL_TEXTURE_CUBE_MAP) {
+        // Clamped on every axis to prevent seams
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, request.levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+    else {
+        // Precompressed textures bring their own mips
+        if (request.compressedFormat == 0) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            request.bytes += request.bytes / 3;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, request.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, request.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    GLStateCache::getInstance().bindTexture(0, request.target, 0);
+}
+
+bool TextureBatchLoader::finish() {
+    start();
+    timings = Timings();
+    timings.imageCount = images.size();
+
+    // Two buffers in turn, so filling one never waits on the transfer out of the other
+    GLuint pixelBuffers[2] = { 0, 0 };
+    glGenBuffers(2, pixelBuffers);
+    size_t nextBuffer = 0;
+
+    for (size_t uploaded = 0; uploaded < images.size(); ++uploaded) {
+        auto waitStart = std::chrono::steady_clock::now();
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(completedMutex);
+            completedCondition.wait(lock, [this]() { return !completed.empty(); });
+            index = completed.front();
+            completed.erase(completed.begin());
+        }
+        auto uploadStart = std::chrono::steady_clock::now();
+        timings.waitSeconds += std::chrono::duration<double>(uploadStart - waitStart).count();
+
+        Image& image = images[index];
+        if (image.compressed) {
+            uploadCompressed(image, pixelBuffers[nextBuffer]);
+            nextBuffer ^= 1;
+            image.compressed.reset();
+        }
+        else if (image.data) {
+            upload(image, pixelBuffers[nextBuffer]);
+            nextBuffer ^= 1;
+            stbi_image_free(image.data);
+            image.data = nullptr;
+        }
+        else {
+            requests[image.request].failed = true;
+        }
+
+        Request& request = requests[image.request];
+        if (--request.pendingImages == 0) {
+            complete(request);
+        }
+        timings.uploadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - uploadStart).count();
+    }
+
+    glDeleteBuffers(2, pixelBuffers);
+
+    bool allLoaded = true;
+    for (const Request& request : requests) {
+        allLoaded = allLoaded && !request.failed;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        timings.decodeSeconds = decodeSeconds;
+    }
+    timings.totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "INFO: Loaded " << timings.imageCount << " images, " << timings.compressedCount << " precompressed ("
+        << timings.bytes / (1024.0 * 1024.0)
+        << " MB) in " << timings.totalSeconds * 1000.0 << " ms: decode " << timings.decodeSeconds * 1000.0
+        << " ms on " << ThreadPool::getInstance().getThreadCount() << " workers, waited "
+        << timings.waitSeconds * 1000.0 << " ms, upload " << timings.uploadSeconds * 1000.0 << " ms." << std::endl;
+    return allLoaded;
+}
+
+GLuint TextureBatchLoader::getTexture(size_t index) const {
+    return index < requests.size() ? requests[index].texture : 0;
+}
+
+int TextureBatchLoader::getChannels(size_t index) const {
+    return index < requests.size() ? requests[index].channels : 0;
+}
+
+size_t TextureBatchLoader::getBytes(size_t index) const {
+    return index < requests.size() ? requests[index].bytes : 0;
+}
+
+const TextureBatchLoader::Timings& TextureBatchLoader::getTimings() const {
+    return timings;
+}
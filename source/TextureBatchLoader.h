@@ -0,0 +1,190 @@
+// TextureBatchLoader.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "KtxTexture.h"
+
+/**
+ * @class TextureBatchLoader
+ * @brief Decodes many images at once on the thread pool and uploads each one as soon as it is ready.
+ *
+ * Textures and cubemaps are queued first, then start() hands every image file, every cubemap face
+ * included, to the worker threads. finish() runs on the GL thread: it takes decoded images in the
+ * order they complete and copies each into a pixel buffer object, then hands it to the driver. The
+ * driver transfers it while the main thread waits on the next decode. Work between start() and
+ * finish() overlaps with the decoding too.
+ *
+ * When TextureCompressor has written a .ktx2 next to an image and the driver supports S3TC, the
+ * worker reads that instead. Its blocks and prebuilt mips are uploaded as they are, with no decode
+ * and no glGenerateMipmap.
+ */
+class TextureBatchLoader {
+public:
+    /**
+     * @brief Where the time of a batch went.
+     */
+    struct Timings {
+        size_t imageCount = 0;          ///< Images decoded, cubemap faces counted separately.
+        size_t compressedCount = 0;     ///< Images read from precompressed .ktx2 files.
+        size_t bytes = 0;               ///< Decoded pixel bytes uploaded.
+        double decodeSeconds = 0.0;     ///< Decode time summed over the workers.
+        double waitSeconds = 0.0;       ///< Time finish() waited for a decode to complete.
+        double uploadSeconds = 0.0;     ///< Time finish() spent filling buffers and creating textures.
+        double totalSeconds = 0.0;      ///< Time from start() to the end of finish().
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    TextureBatchLoader();
+
+    /**
+     * @brief Destructor. Waits for decodes still running.
+     */
+    ~TextureBatchLoader();
+
+    /**
+     * @brief Queues a 2D texture with mipmaps. Only valid before start().
+     * @param path Path to the image.
+     * @param wrap Wrap mode for both axes.
+     * @return Index to read the texture back with once finish() has run.
+     */
+    size_t addTexture(const std::string& path, GLenum wrap = GL_REPEAT);
+
+    /**
+     * @brief Queues a cubemap. Only valid before start().
+     * @param faces Paths to the +X, -X, +Y, -Y, +Z and -Z faces, in that order.
+     * @return Index to read the texture back with once finish() has run.
+     */
+    size_t addCubemap(const std::vector<std::string>& faces);
+
+    /**
+     * @brief Starts decoding every queued image on the thread pool. Returns immediately.
+     */
+    void start();
+
+    /**
+     * @brief Uploads the images as they finish decoding. Calls start() if it has not run yet.
+     * Must be called on the thread that owns the GL context.
+     * @return True if every texture loaded.
+     */
+    bool finish();
+
+    /**
+     * @brief Gets a loaded texture. The caller owns it from then on.
+     * @param index Index returned by addTexture() or addCubemap().
+     * @return OpenGL texture ID, 0 if any of its images failed to load.
+     */
+    GLuint getTexture(size_t index) const;
+
+    /**
+     * @brief Gets the channel count of a loaded texture.
+     * @param index Index returned by addTexture() or addCubemap().
+     * @return Channels per pixel, 0 if it failed to load.
+     */
+    int getChannels(size_t index) const;
+
+    /**
+     * @brief Gets the video memory a loaded texture takes, mips included.
+     * @param index Index returned by addTexture() or addCubemap().
+     * @return Size in bytes, 0 if it failed to load.
+     */
+    size_t getBytes(size_t index) const;
+
+    /**
+     * @brief Gets the per-stage timings of the last finish().
+     * @return Stage timings.
+     */
+    const Timings& getTimings() const;
+
+private:
+    /**
+     * @brief One texture, made of one image or six cubemap faces.
+     */
+    struct Request {
+        GLenum target;                  ///< GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+        GLenum wrap;                    ///< Wrap mode of 2D textures.
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        GLenum compressedFormat = 0;    ///< Block format, 0 for uncompressed pixels.
+        size_t levelCount = 1;          ///< Mip levels uploaded from the files.
+        size_t bytes = 0;               ///< Texel data uploaded or generated.
+        size_t pendingImages = 0;       ///< Images not uploaded yet.
+        bool failed = false;
+    };
+
+    /**
+     * @brief One image file, decoded on a worker.
+     */
+    struct Image {
+        std::string path;
+        size_t request;                 ///< Texture the image belongs to.
+        GLenum face;                    ///< Upload target, the face for cubemaps.
+        unsigned char* data = nullptr;  ///< Decoded pixels, owned until uploaded.
+        std::unique_ptr<KtxTexture> compressed; ///< Blocks and mips read instead, when a .ktx2 exists.
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+    };
+
+    std::vector<Request> requests;
+    std::vector<Image> images;
+    std::vector<std::future<void>> decodes;
+
+    // Indices of decoded images, filled by the workers in completion order
+    std::mutex completedMutex;
+    std::condition_variable completedCondition;
+    std::vector<size_t> completed;
+    double decodeSeconds;               ///< Summed worker decode time, guarded by completedMutex.
+
+    bool started;
+    bool useCompressed;                 ///< Driver supports S3TC, so .ktx2 files are read.
+    std::chrono::steady_clock::time_point startTime;
+    Timings timings;
+
+    /**
+     * @brief Decodes one image. Runs on a worker thread.
+     * @param index Image index.
+     */
+    void decode(size_t index);
+
+    /**
+     * @brief Uploads one decoded image through a pixel buffer object.
+     * @param image Decoded image.
+     * @param pixelBuffer Pixel buffer object to stage the pixels in.
+     */
+    void upload(Image& image, GLuint pixelBuffer);
+
+    /**
+     * @brief Uploads the blocks of every mip level of one precompressed image through a pixel buffer object.
+     * @param image Image read from a .ktx2 file.
+     * @param pixelBuffer Pixel buffer object to stage the blocks in.
+     */
+    void uploadCompressed(Image& image, GLuint pixelBuffer);
+
+    /**
+     * @brief Checks that an image matches the texture it belongs to, creating the texture for the first one.
+     * @param image Image about to be uploaded.
+     * @param compressedFormat Block format of the image, 0 for pixels.
+     * @param levelCount Mip levels in the image.
+     * @return False if the texture already failed or the image does not match it.
+     */
+    bool prepareTexture(const Image& image, GLenum compressedFormat, size_t levelCount);
+
+    /**
+     * @brief Sets the sampling state of a texture whose images are all uploaded, or deletes it if one failed.
+     * @param request Finished texture.
+     */
+    void complete(Request& request);
+};
@@ -0,0 +1,309 @@
+// TextureCompressor.cpp
+
+#include "TextureCompressor.h"
+#include "ThreadPool.h"
+#include "../Linker/include/stb/stb_image.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace {
+    uint16_t packColor565(const float* color) {
+        int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+        int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+        int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackColor565(uint16_t packed, int* color) {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    void writeLittleEndian(unsigned char* destination, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            destination[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    // Four-color BC1 block, the color half of BC3 too
+    void encodeColorBlock(const unsigned char* rgba, unsigned char* block) {
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                mean[c] += rgba[i * 4 + c] / 16.0f;
+            }
+        }
+
+        // Principal axis of the block's colors by power iteration on their covariance
+        float covariance[3][3] = {};
+        for (int i = 0; i < 16; ++i) {
+            float d[3] = { rgba[i * 4] - mean[0], rgba[i * 4 + 1] - mean[1], rgba[i * 4 + 2] - mean[2] };
+            for (int a = 0; a < 3; ++a) {
+                for (int b = 0; b < 3; ++b) {
+                    covariance[a][b] += d[a] * d[b];
+                }
+            }
+        }
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 4; ++iteration) {
+            float next[3];
+            for (int a = 0; a < 3; ++a) {
+                next[a] = covariance[a][0] * axis[0] + covariance[a][1] * axis[1] + covariance[a][2] * axis[2];
+            }
+            float length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+            if (length <= 0.0f) {
+                break;
+            }
+            for (int a = 0; a < 3; ++a) {
+                axis[a] = next[a] / length;
+            }
+        }
+
+        // The pixels furthest apart along the axis become the endpoints
+        int lowest = 0;
+        int highest = 0;
+        float lowestT = INFINITY;
+        float highestT = -INFINITY;
+        for (int i = 0; i < 16; ++i) {
+            float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+            if (t < lowestT) {
+                lowestT = t;
+                lowest = i;
+            }
+            if (t > highestT) {
+                highestT = t;
+                highest = i;
+            }
+        }
+        float highColor[3] = { float(rgba[highest * 4]), float(rgba[highest * 4 + 1]), float(rgba[highest * 4 + 2]) };
+        float lowColor[3] = { float(rgba[lowest * 4]), float(rgba[lowest * 4 + 1]), float(rgba[lowest * 4 + 2]) };
+        uint16_t color0 = packColor565(highColor);
+        uint16_t color1 = packColor565(lowColor);
+
+        // color0 > color1 selects the four-color mode; equal endpoints need no indices at all
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        writeLittleEndian(block, color0, 2);
+        writeLittleEndian(block + 2, color1, 2);
+        if (color0 == color1) {
+            writeLittleEndian(block + 4, 0, 4);
+            return;
+        }
+
+        int palette[4][3];
+        unpackColor565(color0, palette[0]);
+        unpackColor565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        uint32_t indices = 0;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            int bestDistance = INT32_MAX;
+            for (int p = 0; p < 4; ++p) {
+                int dr = rgba[i * 4] - palette[p][0];
+                int dg = rgba[i * 4 + 1] - palette[p][1];
+                int db = rgba[i * 4 + 2] - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+        writeLittleEndian(block + 4, indices, 4);
+    }
+
+    // Eight-value BC3 alpha block between the lowest and highest alpha
+    void encodeAlphaBlock(const unsigned char* rgba, unsigned char* block) {
+        int alpha0 = 0;
+        int alpha1 = 255;
+        for (int i = 0; i < 16; ++i) {
+            alpha0 = std::max(alpha0, static_cast<int>(rgba[i * 4 + 3]));
+            alpha1 = std::min(alpha1, static_cast<int>(rgba[i * 4 + 3]));
+        }
+        block[0] = static_cast<unsigned char>(alpha0);
+        block[1] = static_cast<unsigned char>(alpha1);
+        if (alpha0 == alpha1) {
+            writeLittleEndian(block + 2, 0, 6);
+            return;
+        }
+
+        int palette[8] = { alpha0, alpha1 };
+        for (int i = 0; i < 6; ++i) {
+            palette[2 + i] = ((6 - i) * alpha0 + (1 + i) * alpha1) / 7;
+        }
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            for (int p = 1; p < 8; ++p) {
+                if (std::abs(rgba[i * 4 + 3] - palette[p]) < std::abs(rgba[i * 4 + 3] - palette[best])) {
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (3 * i);
+        }
+        writeLittleEndian(block + 2, indices, 6);
+    }
+
+    // Next mip level by averaging 2x2 pixels; an odd last row or column is averaged with itself
+    std::vector<unsigned char> downsample(const std::vector<unsigned char>& pixels, int width, int height) {
+        int nextWidth = std::max(1, width / 2);
+        int nextHeight = std::max(1, height / 2);
+        std::vector<unsigned char> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+        for (int y = 0; y < nextHeight; ++y) {
+            int y0 = std::min(2 * y, height - 1);
+            int y1 = std::min(2 * y + 1, height - 1);
+            for (int x = 0; x < nextWidth; ++x) {
+                int x0 = std::min(2 * x, width - 1);
+                int x1 = std::min(2 * x + 1, width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = pixels[(static_cast<size_t>(y0) * width + x0) * 4 + c] + pixels[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                        pixels[(static_cast<size_t>(y1) * width + x0) * 4 + c] + pixels[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                    next[(static_cast<size_t>(y) * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+        return next;
+    }
+
+    std::vector<unsigned char> encodeLevel(const std::vector<unsigned char>& pixels, int width, int height, KtxTexture::Format format) {
+        int blocksX = (width + 3) / 4;
+        int blocksY = (height + 3) / 4;
+        size_t blockBytes = KtxTexture::getBlockBytes(format);
+        std::vector<unsigned char> blocks(static_cast<size_t>(blocksX) * blocksY * blockBytes);
+
+        ThreadPool::getInstance().parallelFor(static_cast<size_t>(blocksY), [&](size_t begin, size_t end) {
+            unsigned char rgba[64];
+            for (size_t blockY = begin; blockY < end; ++blockY) {
+                for (int blockX = 0; blockX < blocksX; ++blockX) {
+                    // Blocks hanging over the edge repeat the last row and column
+                    for (int i = 0; i < 16; ++i) {
+                        int x = std::min(blockX * 4 + i % 4, width - 1);
+                        int y = std::min(static_cast<int>(blockY) * 4 + i / 4, height - 1);
+                        std::copy_n(&pixels[(static_cast<size_t>(y) * width + x) * 4], 4, &rgba[i * 4]);
+                    }
+
+                    unsigned char* block = &blocks[(blockY * blocksX + blockX) * blockBytes];
+                    if (format == KtxTexture::Format::BC3) {
+                        TextureCompressor::encodeBC3Block(rgba, block);
+                    }
+                    else {
+                        TextureCompressor::encodeBC1Block(rgba, block);
+                    }
+                }
+            }
+        });
+        return blocks;
+    }
+}
+
+void TextureCompressor::encodeBC1Block(const unsigned char* rgba, unsigned char* block) {
+    encodeColorBlock(rgba, block);
+}
+
+void TextureCompressor::encodeBC3Block(const unsigned char* rgba, unsigned char* block) {
+    encodeAlphaBlock(rgba, block);
+    encodeColorBlock(rgba, block + 8);
+}
+
+bool TextureCompressor::compress(const std::string& source, const std::string& destination) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(source.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cerr << "ERROR::COMPRESSOR::FAILED_TO_LOAD: " << source << " (" << stbi_failure_reason() << ")" << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> pixels(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+
+    // Alpha costs twice the space, so only images that use it get BC3
+    bool hasAlpha = false;
+    for (size_t i = 3; i < pixels.size() && !hasAlpha; i += 4) {
+        hasAlpha = pixels[i] != 255;
+    }
+    KtxTexture::Format format = hasAlpha ? KtxTexture::Format::BC3 : KtxTexture::Format::BC1;
+
+    std::vector<std::vector<unsigned char>> levels;
+    int levelWidth = width;
+    int levelHeight = height;
+    while (true) {
+        levels.push_back(encodeLevel(pixels, levelWidth, levelHeight, format));
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+        pixels = downsample(pixels, levelWidth, levelHeight);
+        levelWidth = std::max(1, levelWidth / 2);
+        levelHeight = std::max(1, levelHeight / 2);
+    }
+
+    KtxTexture texture;
+    texture.setLevels(format, width, height, std::move(levels));
+    if (!texture.save(destination)) {
+        std::cerr << "ERROR::COMPRESSOR::FAILED_TO_WRITE: " << destination << std::endl;
+        return false;
+    }
+
+    std::cout << "INFO: Compressed " << source << " (" << width << " x " << height << ", " << texture.getLevelCount()
+        << " levels) to " << (hasAlpha ? "BC3" : "BC1") << ", " << texture.getDataSize() / 1024 << " KB." << std::endl;
+    return true;
+}
+
+size_t TextureCompressor::compressDirectory(const std::string& directory) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    size_t failures = 0;
+
+    for (fs::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension != ".png" && extension != ".jpg" && extension != ".jpeg") {
+            continue;
+        }
+
+        // Up-to-date outputs are kept, so rerunning after editing one image converts only that one
+        std::string source = it->path().string();
+        std::string destination = getCompressedPath(source);
+        if (isUpToDate(source, destination)) {
+            continue;
+        }
+        failures += compress(source, destination) ? 0 : 1;
+    }
+
+    if (error) {
+        std::cerr << "ERROR::COMPRESSOR::FAILED_TO_READ_DIRECTORY: " << directory << " (" << error.message() << ")" << std::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+std::string TextureCompressor::getCompressedPath(const std::string& source) {
+    return std::filesystem::path(source).replace_extension(".ktx2").string();
+}
+
+bool TextureCompressor::isUpToDate(const std::string& source, const std::string& compressed) {
+    std::error_code compressedError, sourceError;
+    auto compressedTime = std::filesystem::last_write_time(compressed, compressedError);
+    if (compressedError) {
+        return false;
+    }
+    auto sourceTime = std::filesystem::last_write_time(source, sourceError);
+    return sourceError || compressedTime >= sourceTime;
+}
@@ -0,0 +1,64 @@
+// TextureCompressor.h
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "KtxTexture.h"
+
+/**
+ * @class TextureCompressor
+ * @brief Offline converter from image files to block-compressed KTX2 textures with full mip chains.
+ *
+ * Images without transparency become BC1, half a byte per pixel; images with alpha become BC3, one
+ * byte per pixel. The mip chain is built here with a box filter so the runtime never calls
+ * glGenerateMipmap. Blocks are encoded in parallel on the thread pool. Each block's colors are
+ * fitted along their principal axis, then every pixel takes the nearest of the four palette
+ * entries. TextureBatchLoader picks up the .ktx2 written next to an image in place of the image.
+ */
+class TextureCompressor {
+public:
+    /**
+     * @brief Compresses one image.
+     * @param source Image file, any format stb_image reads.
+     * @param destination KTX2 file to write.
+     * @return True if the file was written.
+     */
+    static bool compress(const std::string& source, const std::string& destination);
+
+    /**
+     * @brief Compresses every PNG and JPEG under a directory whose .ktx2 is missing or older.
+     * @param directory Directory searched recursively.
+     * @return Number of files that failed to convert.
+     */
+    static size_t compressDirectory(const std::string& directory);
+
+    /**
+     * @brief Gets the compressed file that stands in for an image.
+     * @param source Image file.
+     * @return The same path with a .ktx2 extension.
+     */
+    static std::string getCompressedPath(const std::string& source);
+
+    /**
+     * @brief Checks that a compressed copy exists and is at least as new as its image.
+     * @param source Image file. A missing image leaves the compressed copy as the only one, so it counts as up to date.
+     * @param compressed Compressed copy, usually getCompressedPath(source).
+     * @return True if the compressed copy can stand in for the image.
+     */
+    static bool isUpToDate(const std::string& source, const std::string& compressed);
+
+    /**
+     * @brief Encodes a 4x4 block of opaque pixels as BC1.
+     * @param rgba 16 pixels, row by row, 4 bytes each.
+     * @param block Receives 8 bytes.
+     */
+    static void encodeBC1Block(const unsigned char* rgba, unsigned char* block);
+
+    /**
+     * @brief Encodes a 4x4 block of pixels with alpha as BC3.
+     * @param rgba 16 pixels, row by row, 4 bytes each.
+     * @param block Receives 16 bytes.
+     */
+    static void encodeBC3Block(const unsigned char* rgba, unsigned char* block);
+};
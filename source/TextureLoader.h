@@ -4,6 +4,7 @@
 #include <glad/glad.h>
 #include <string>
 #include <vector>
+#include "AssetCache.h"
 
 /**
  * @class TextureLoader
@@ -12,16 +13,16 @@
 class TextureLoader {
 public:
     /**
-     * @brief Loads a 2D texture from a file.
+     * @brief Loads a 2D texture from a file, or shares it if it is already loaded.
      * @param path Path to the texture image.
-     * @return OpenGL texture ID.
+     * @return Handle to the texture, nullptr on failure.
      */
-    static GLuint loadTexture(const char* path);
+    static TextureHandle loadTexture(const char* path);
 
     /**
-     * @brief Loads a cubemap texture from 6 individual texture faces.
+     * @brief Loads a cubemap texture from 6 individual texture faces, or shares it if it is already loaded.
      * @param faces Vector containing paths to the 6 cubemap face images.
-     * @return OpenGL cubemap texture ID.
+     * @return Handle to the cubemap, nullptr on failure.
      */
-    static GLuint loadCubemap(const std::vector<std::string>& faces);
+    static TextureHandle loadCubemap(const std::vector<std::string>& faces);
 };
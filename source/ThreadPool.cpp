@@ -0,0 +1,113 @@
+// ThreadPool.cpp
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+/**
+ * @brief Retrieves the singleton instance of the ThreadPool.
+ */
+ThreadPool& ThreadPool::getInstance() {
+    // Leave one core for the render thread, but always keep a worker so submitted tasks make progress
+    static ThreadPool instance(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : stopping(false) {
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push(std::move(task));
+    }
+    queueCondition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+/**
+ * @brief Runs body over [0, count) in chunks on the workers and the calling thread.
+ */
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Several chunks per thread keep the load balanced when items differ in cost
+    size_t threadCount = workers.size() + 1;
+    size_t chunkCount = std::min(count, threadCount * 4);
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    if (chunkCount == 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+
+    // Shared with helper tasks, which may start after this call already returned
+    struct Job {
+        std::atomic<size_t> nextChunk{ 0 };
+        std::atomic<size_t> finishedChunks{ 0 };
+        std::mutex doneMutex;
+        std::condition_variable doneCondition;
+    };
+    auto job = std::make_shared<Job>();
+
+    // Chunks are claimed from a shared counter, so the caller never waits on a queued helper
+    auto runChunks = [job, &body, count, chunkSize, chunkCount]() {
+        size_t chunk;
+        while ((chunk = job->nextChunk.fetch_add(1)) < chunkCount) {
+            size_t begin = chunk * chunkSize;
+            body(begin, std::min(begin + chunkSize, count));
+            if (job->finishedChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(job->doneMutex);
+                job->doneCondition.notify_all();
+            }
+        }
+    };
+
+    size_t helperCount = std::min(workers.size(), chunkCount - 1);
+    for (size_t i = 0; i < helperCount; ++i) {
+        // Helpers capture body by reference; they only touch it while chunks remain unclaimed
+        enqueue(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(job->doneMutex);
+    job->doneCondition.wait(lock, [&job, chunkCount]() { return job->finishedChunks.load() == chunkCount; });
+}
@@ -0,0 +1,85 @@
+// ThreadPool.h
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Shared pool of worker threads for CPU-heavy loading and simulation work.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Retrieves the singleton instance of the ThreadPool.
+     * @return Reference to the ThreadPool instance.
+     */
+    static ThreadPool& getInstance();
+
+    /**
+     * @brief Queues a task for execution on a worker thread.
+     * @param task Callable without arguments.
+     * @return Future holding the task's result.
+     */
+    template <typename Task>
+    auto submit(Task&& task) -> std::future<decltype(task())>;
+
+    /**
+     * @brief Splits [0, count) into chunks and runs them across the workers and the calling thread.
+     * Returns once every chunk has finished. Safe to call from inside a worker.
+     * @param count Number of items to process.
+     * @param body Called with a half-open [begin, end) range of item indices.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& body);
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return Worker thread count.
+     */
+    size_t getThreadCount() const;
+
+private:
+    // Private Constructor and Destructor for Singleton
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();
+
+    // Delete copy constructor and assignment operator
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::vector<std::thread> workers;          ///< Worker threads.
+    std::queue<std::function<void()>> tasks;   ///< Pending tasks.
+    std::mutex queueMutex;                     ///< Guards the task queue.
+    std::condition_variable queueCondition;    ///< Signals new tasks or shutdown.
+    bool stopping;                             ///< Set when the pool is shutting down.
+
+    /**
+     * @brief Main loop of each worker thread.
+     */
+    void workerLoop();
+
+    /**
+     * @brief Pushes a type-erased task to the queue and wakes a worker.
+     * @param task Task to run.
+     */
+    void enqueue(std::function<void()> task);
+};
+
+template <typename Task>
+auto ThreadPool::submit(Task&& task) -> std::future<decltype(task())> {
+    using Result = decltype(task());
+
+    // std::function needs a copyable callable, so the packaged task lives behind a shared_ptr
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+    std::future<Result> result = packaged->get_future();
+    enqueue([packaged]() { (*packaged)(); });
+    return result;
+}
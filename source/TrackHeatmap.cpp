@@ -0,0 +1,222 @@
+// TrackHeatmap.cpp
+
+#include "TrackHeatmap.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+TrackHeatmap::TrackHeatmap()
+    : terrain(nullptr), gridWidth(0), gridHeight(0), tileSize(64), tilesX(0), tilesZ(0),
+    maxDensity(0.0f), trackCount(0), textureID(0) {}
+
+TrackHeatmap::~TrackHeatmap() {
+    cleanup();
+}
+
+bool TrackHeatmap::initialize(const Terrain& terrain, int tileSize) {
+    cleanup();
+
+    this->terrain = &terrain;
+    this->tileSize = std::max(tileSize, 1);
+    gridWidth = terrain.getWidth();
+    gridHeight = terrain.getHeight();
+    if (gridWidth <= 0 || gridHeight <= 0) {
+        std::cerr << "ERROR::HEATMAP::TERRAIN_NOT_LOADED" << std::endl;
+        return false;
+    }
+
+    tilesX = (gridWidth + this->tileSize - 1) / this->tileSize;
+    tilesZ = (gridHeight + this->tileSize - 1) / this->tileSize;
+    density.assign(static_cast<size_t>(gridWidth) * gridHeight, 0.0f);
+    dirtyTiles.assign(static_cast<size_t>(tilesX) * tilesZ, 0);
+    maxDensity = 0.0f;
+    trackCount = 0;
+
+    glGenTextures(1, &textureID);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, gridWidth, gridHeight, 0, GL_RED, GL_FLOAT, density.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+void TrackHeatmap::rasterizeTrack(const std::vector<glm::vec3>& track, std::vector<uint32_t>& cells, std::vector<std::vector<uint32_t>>& bins) const {
+    cells.clear();
+    auto visit = [&](int x, int z) {
+        if (x < 0 || z < 0 || x >= gridWidth || z >= gridHeight) {
+            return;
+        }
+        uint32_t cell = static_cast<uint32_t>(z * gridWidth + x);
+        // Consecutive repeats are common and cheap to drop before the sort
+        if (cells.empty() || cells.back() != cell) {
+            cells.push_back(cell);
+        }
+    };
+
+    if (track.size() == 1) {
+        glm::vec2 point = terrain->worldToGrid(track[0].x, track[0].z) + 0.5f;
+        visit(static_cast<int>(std::floor(point.x)), static_cast<int>(std::floor(point.y)));
+    }
+
+    // Texel (x, z) covers the half-open square around heightmap vertex (x, z)
+    for (size_t i = 1; i < track.size(); ++i) {
+        glm::vec2 start = terrain->worldToGrid(track[i - 1].x, track[i - 1].z) + 0.5f;
+        glm::vec2 end = terrain->worldToGrid(track[i].x, track[i].z) + 0.5f;
+        glm::vec2 delta = end - start;
+
+        // Walk every cell the segment crosses, one cell edge at a time
+        int x = static_cast<int>(std::floor(start.x));
+        int z = static_cast<int>(std::floor(start.y));
+        int steps = std::abs(static_cast<int>(std::floor(end.x)) - x) + std::abs(static_cast<int>(std::floor(end.y)) - z);
+        int stepX = delta.x > 0.0f ? 1 : -1;
+        int stepZ = delta.y > 0.0f ? 1 : -1;
+        float infinity = std::numeric_limits<float>::infinity();
+        float tDeltaX = delta.x != 0.0f ? 1.0f / std::abs(delta.x) : infinity;
+        float tDeltaZ = delta.y != 0.0f ? 1.0f / std::abs(delta.y) : infinity;
+        float tMaxX = delta.x != 0.0f ? (stepX > 0 ? x + 1 - start.x : start.x - x) * tDeltaX : infinity;
+        float tMaxZ = delta.y != 0.0f ? (stepZ > 0 ? z + 1 - start.y : start.y - z) * tDeltaZ : infinity;
+
+        visit(x, z);
+        for (int step = 0; step < steps; ++step) {
+            if (tMaxX < tMaxZ) {
+                x += stepX;
+                tMaxX += tDeltaX;
+            }
+            else {
+                z += stepZ;
+                tMaxZ += tDeltaZ;
+            }
+            visit(x, z);
+        }
+    }
+
+    // A track that loops back, or jitters across a cell edge, still counts once per cell
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    for (uint32_t cell : cells) {
+        int x = static_cast<int>(cell % gridWidth);
+        int z = static_cast<int>(cell / gridWidth);
+        bins[(z / tileSize) * tilesX + x / tileSize].push_back(cell);
+    }
+}
+
+void TrackHeatmap::addTracks(const std::vector<std::vector<glm::vec3>>& tracks) {
+    if (!terrain || tracks.empty()) {
+        return;
+    }
+
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesZ;
+    ThreadPool& pool = ThreadPool::getInstance();
+
+    // Pass 1: each batch bins its tracks' cells by tile, touching only its own bins
+    size_t batchCount = std::min(tracks.size(), (pool.getThreadCount() + 1) * 4);
+    std::vector<std::vector<std::vector<uint32_t>>> batchBins(batchCount, std::vector<std::vector<uint32_t>>(tileCount));
+    pool.parallelFor(batchCount, [&](size_t begin, size_t end) {
+        for (size_t batch = begin; batch < end; ++batch) {
+            size_t first = batch * tracks.size() / batchCount;
+            size_t last = (batch + 1) * tracks.size() / batchCount;
+            std::vector<uint32_t> cells;
+            for (size_t t = first; t < last; ++t) {
+                rasterizeTrack(tracks[t], cells, batchBins[batch]);
+            }
+        }
+    });
+
+    // Pass 2: each tile sums its bin from every batch; tiles are disjoint, so no two tasks share a cell
+    std::vector<float> tileMax(tileCount, 0.0f);
+    pool.parallelFor(tileCount, [&](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            float highest = 0.0f;
+            for (const auto& bins : batchBins) {
+                for (uint32_t cell : bins[tile]) {
+                    highest = std::max(highest, density[cell] += 1.0f);
+                }
+                if (!bins[tile].empty()) {
+                    dirtyTiles[tile] = 1;
+                }
+            }
+            tileMax[tile] = highest;
+        }
+    });
+
+    for (float highest : tileMax) {
+        maxDensity = std::max(maxDensity, highest);
+    }
+    trackCount += tracks.size();
+}
+
+void TrackHeatmap::upload() {
+    if (textureID == 0) {
+        return;
+    }
+
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, textureID);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, gridWidth);
+
+    // Sub-rectangles are read straight out of the full grid
+    for (int tileZ = 0; tileZ < tilesZ; ++tileZ) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            uint8_t& dirty = dirtyTiles[static_cast<size_t>(tileZ) * tilesX + tileX];
+            if (!dirty) {
+                continue;
+            }
+            dirty = 0;
+
+            int x = tileX * tileSize;
+            int z = tileZ * tileSize;
+            int w = std::min(tileSize, gridWidth - x);
+            int h = std::min(tileSize, gridHeight - z);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, z, w, h, GL_RED, GL_FLOAT, density.data() + static_cast<size_t>(z) * gridWidth + x);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void TrackHeatmap::reset() {
+    std::fill(density.begin(), density.end(), 0.0f);
+    std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+    maxDensity = 0.0f;
+    trackCount = 0;
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void TrackHeatmap::cleanup() {
+    if (textureID) {
+        GLStateCache::getInstance().deleteTexture(textureID);
+        textureID = 0;
+    }
+    density.clear();
+    dirtyTiles.clear();
+    maxDensity = 0.0f;
+    trackCount = 0;
+}
+
+GLuint TrackHeatmap::getTexture() const {
+    return textureID;
+}
+
+float TrackHeatmap::getMaxDensity() const {
+    return maxDensity;
+}
+
+float TrackHeatmap::getDensity(int x, int z) const {
+    if (x < 0 || z < 0 || x >= gridWidth || z >= gridHeight) {
+        return 0.0f;
+    }
+    return density[static_cast<size_t>(z) * gridWidth + x];
+}
+
+size_t TrackHeatmap::getTrackCount() const {
+    return trackCount;
+}
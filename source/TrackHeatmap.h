@@ -0,0 +1,110 @@
+// TrackHeatmap.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "Terrain.h"
+
+/**
+ * @class TrackHeatmap
+ * @brief Density grid of how many tracks pass through each heightmap cell, uploaded as a texture.
+ *
+ * The grid has one texel per heightmap vertex, so Terrain can sample it from world position.
+ * Tracks are rasterized in parallel in two passes. First each batch of tracks sorts the cells it
+ * crosses into per-tile bins. Then each tile sums every batch's bin for that tile. A tile is only
+ * ever written by the one task that owns it, so the merge needs no locks or atomics.
+ * Adding tracks later rasterizes only the new ones and re-uploads only the tiles they touched.
+ */
+class TrackHeatmap {
+public:
+    /**
+     * @brief Constructor.
+     */
+    TrackHeatmap();
+
+    /**
+     * @brief Destructor.
+     */
+    ~TrackHeatmap();
+
+    /**
+     * @brief Sizes the grid to match the terrain and creates the texture.
+     * @param terrain Terrain whose heightmap grid the heatmap aligns with.
+     * @param tileSize Edge length of the tiles the grid is merged and uploaded in.
+     * @return True if the texture was created.
+     */
+    bool initialize(const Terrain& terrain, int tileSize = 64);
+
+    /**
+     * @brief Rasterizes more tracks into the grid. Call upload() to update the texture.
+     * @param tracks Tracks in world space.
+     */
+    void addTracks(const std::vector<std::vector<glm::vec3>>& tracks);
+
+    /**
+     * @brief Uploads the tiles changed since the last upload.
+     */
+    void upload();
+
+    /**
+     * @brief Clears the grid and the texture.
+     */
+    void reset();
+
+    /**
+     * @brief Cleans up OpenGL resources and the grid.
+     */
+    void cleanup();
+
+    /**
+     * @brief Gets the density texture, one float track count per texel.
+     * @return OpenGL texture ID, 0 before initialize.
+     */
+    GLuint getTexture() const;
+
+    /**
+     * @brief Gets the highest density in the grid.
+     * @return Largest number of tracks through one cell.
+     */
+    float getMaxDensity() const;
+
+    /**
+     * @brief Gets the density of one cell.
+     * @param x Heightmap column.
+     * @param z Heightmap row.
+     * @return Number of tracks through the cell, 0 outside the grid.
+     */
+    float getDensity(int x, int z) const;
+
+    /**
+     * @brief Gets the number of tracks added since the last reset.
+     * @return Track count.
+     */
+    size_t getTrackCount() const;
+
+private:
+    const Terrain* terrain;             ///< Terrain the grid is aligned with.
+    int gridWidth;                      ///< Grid columns, the heightmap width.
+    int gridHeight;                     ///< Grid rows, the heightmap height.
+    int tileSize;                       ///< Tile edge length in cells.
+    int tilesX;                         ///< Tiles along x.
+    int tilesZ;                         ///< Tiles along z.
+
+    std::vector<float> density;         ///< Track count per cell, row-major.
+    std::vector<uint8_t> dirtyTiles;    ///< Tiles changed since the last upload.
+    float maxDensity;                   ///< Highest cell value.
+    size_t trackCount;                  ///< Tracks rasterized so far.
+
+    GLuint textureID;
+
+    /**
+     * @brief Appends the id of every cell a track crosses to per-tile bins, each cell once however often the track revisits it.
+     * @param track Track in world space.
+     * @param cells Scratch list of the track's cells, reused between calls.
+     * @param bins One cell id list per tile.
+     */
+    void rasterizeTrack(const std::vector<glm::vec3>& track, std::vector<uint32_t>& cells, std::vector<std::vector<uint32_t>>& bins) const;
+};
@@ -0,0 +1,466 @@
+// TrackLibrary.cpp
+
+#include "TrackLibrary.h"
+#include "ThreadPool.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+namespace {
+    const char ARCHIVE_MAGIC[8] = { 'S', 'P', 'V', 'R', 'T', 'R', 'K', 'S' };
+    const uint32_t ARCHIVE_VERSION = 2;
+    const double EARTH_RADIUS = 6371000.0;
+
+    bool readWholeFile(const std::string& path, std::string& contents) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        contents.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+        return file.good() || file.eof();
+    }
+
+    // Value of an XML attribute such as lat="68.44" inside one tag
+    std::string_view attributeValue(std::string_view tag, std::string_view name) {
+        size_t position = 0;
+        while ((position = tag.find(name, position)) != std::string_view::npos) {
+            size_t quote = position + name.size();
+            bool wholeName = position == 0 || tag[position - 1] == ' ' || tag[position - 1] == '\t' || tag[position - 1] == '\n';
+            if (wholeName && quote + 1 < tag.size() && tag[quote] == '=' && (tag[quote + 1] == '"' || tag[quote + 1] == '\'')) {
+                size_t end = tag.find(tag[quote + 1], quote + 2);
+                return end == std::string_view::npos ? std::string_view() : tag.substr(quote + 2, end - quote - 2);
+            }
+            position = quote;
+        }
+        return std::string_view();
+    }
+
+    // Text between <name> and </name> inside an element body
+    std::string_view elementText(std::string_view body, std::string_view open, std::string_view close) {
+        size_t start = body.find(open);
+        if (start == std::string_view::npos) {
+            return std::string_view();
+        }
+        start += open.size();
+        size_t end = body.find(close, start);
+        return end == std::string_view::npos ? std::string_view() : body.substr(start, end - start);
+    }
+
+    template <typename Number>
+    bool parseNumber(std::string_view text, Number& value) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '+')) {
+            text.remove_prefix(1);
+        }
+        return !text.empty() && std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+    }
+}
+
+std::vector<glm::vec3> TrackLibrary::TrackView::getPoints() const {
+    return std::vector<glm::vec3>(points, points + pointCount);
+}
+
+std::vector<float> TrackLibrary::TrackView::getTimes() const {
+    return std::vector<float>(times, times + timeCount);
+}
+
+TrackLibrary::TrackLibrary()
+    : entryData(nullptr), pointData(nullptr), timeData(nullptr), nameData(nullptr), trackCount(0), sourceHash(0) {}
+
+void TrackLibrary::clear() {
+    archive.close();
+    entries.clear();
+    points.clear();
+    times.clear();
+    names.clear();
+    sourceHash = 0;
+    useMemoryArrays();
+}
+
+void TrackLibrary::useMemoryArrays() {
+    entryData = entries.data();
+    pointData = points.data();
+    timeData = times.data();
+    nameData = names.data();
+    trackCount = entries.size();
+}
+
+size_t TrackLibrary::getTrackCount() const {
+    return trackCount;
+}
+
+TrackLibrary::TrackView TrackLibrary::getTrack(size_t index) const {
+    const TrackEntry& entry = entryData[index];
+
+    TrackView view;
+    view.name = std::string_view(nameData + entry.nameOffset, entry.nameLength);
+    view.contentHash = entry.contentHash;
+    view.points = pointData + entry.firstPoint;
+    view.pointCount = entry.pointCount;
+    view.times = entry.timeCount > 0 ? timeData + entry.firstTime : nullptr;
+    view.timeCount = entry.timeCount;
+    return view;
+}
+
+int TrackLibrary::findTrack(std::string_view name) const {
+    for (size_t i = 0; i < trackCount; ++i) {
+        const TrackEntry& entry = entryData[i];
+        if (std::string_view(nameData + entry.nameOffset, entry.nameLength) == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool TrackLibrary::importDirectory(const std::string& directory) {
+    clear();
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<std::string> files;
+    if (!listTrackFiles(directory, files) || files.empty()) {
+        std::cerr << "ERROR::TRACK_LIBRARY::NO_TRACK_FILES: " << directory << std::endl;
+        return false;
+    }
+
+    // Parsing and hashing dominate, and every file is independent
+    std::vector<ParsedTrack> parsed(files.size());
+    std::vector<char> valid(files.size(), 0);
+    ThreadPool::getInstance().parallelFor(files.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (parseTrackFile(files[i], parsed[i])) {
+                parsed[i].contentHash = hashTrack(parsed[i]);
+                valid[i] = 1;
+            }
+        }
+    });
+
+    // Pack in file order, skipping repeated content
+    std::unordered_set<uint64_t> seenHashes;
+    size_t duplicates = 0;
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        if (!valid[i]) {
+            continue;
+        }
+        ParsedTrack& track = parsed[i];
+        if (!seenHashes.insert(track.contentHash).second) {
+            ++duplicates;
+            continue;
+        }
+
+        TrackEntry entry;
+        entry.contentHash = track.contentHash;
+        entry.firstPoint = points.size();
+        entry.firstTime = times.size();
+        entry.pointCount = static_cast<uint32_t>(track.points.size());
+        entry.timeCount = static_cast<uint32_t>(track.times.size());
+        entry.nameOffset = static_cast<uint32_t>(names.size());
+        entry.nameLength = static_cast<uint32_t>(track.name.size());
+        entries.push_back(entry);
+
+        points.insert(points.end(), track.points.begin(), track.points.end());
+        times.insert(times.end(), track.times.begin(), track.times.end());
+        names += track.name;
+    }
+    useMemoryArrays();
+    sourceHash = hashSourceFiles(directory, files);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "INFO: Imported " << trackCount << " tracks (" << points.size() << " points, "
+        << duplicates << " duplicates skipped) from " << files.size() << " files in " << seconds * 1000.0
+        << " ms, " << files.size() / std::max(seconds, 1e-9) << " tracks/s." << std::endl;
+
+    return trackCount > 0;
+}
+
+bool TrackLibrary::writeArchive(const std::string& archivePath) const {
+    Header header;
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.trackCount = static_cast<uint32_t>(trackCount);
+    header.pointsOffset = sizeof(Header) + trackCount * sizeof(TrackEntry);
+
+    size_t pointCount = 0, timeCount = 0, nameBytes = 0;
+    for (size_t i = 0; i < trackCount; ++i) {
+        pointCount = std::max<size_t>(pointCount, entryData[i].firstPoint + entryData[i].pointCount);
+        timeCount = std::max<size_t>(timeCount, entryData[i].firstTime + entryData[i].timeCount);
+        nameBytes = std::max<size_t>(nameBytes, entryData[i].nameOffset + entryData[i].nameLength);
+    }
+    header.timesOffset = header.pointsOffset + pointCount * sizeof(glm::vec3);
+    header.namesOffset = header.timesOffset + timeCount * sizeof(float);
+    header.fileSize = header.namesOffset + nameBytes;
+    header.sourceHash = sourceHash;
+
+    std::ofstream file(archivePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::TRACK_LIBRARY::FAILED_TO_WRITE_ARCHIVE: " << archivePath << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(entryData), static_cast<std::streamsize>(trackCount * sizeof(TrackEntry)));
+    file.write(reinterpret_cast<const char*>(pointData), static_cast<std::streamsize>(pointCount * sizeof(glm::vec3)));
+    file.write(reinterpret_cast<const char*>(timeData), static_cast<std::streamsize>(timeCount * sizeof(float)));
+    file.write(nameData, static_cast<std::streamsize>(nameBytes));
+
+    if (!file.good()) {
+        std::cerr << "ERROR::TRACK_LIBRARY::FAILED_TO_WRITE_ARCHIVE: " << archivePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TrackLibrary::openArchive(const std::string& archivePath, const std::string& sourceDirectory) {
+    clear();
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (!archive.open(archivePath)) {
+        return false;
+    }
+
+    const unsigned char* base = archive.getData();
+    Header header;
+    if (archive.getSize() < sizeof(Header)) {
+        std::cerr << "ERROR::TRACK_LIBRARY::INVALID_ARCHIVE: " << archivePath << std::endl;
+        archive.close();
+        return false;
+    }
+    std::memcpy(&header, base, sizeof(Header));
+
+    bool validLayout = std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == ARCHIVE_VERSION &&
+        header.fileSize == archive.getSize() &&
+        header.pointsOffset == sizeof(Header) + uint64_t(header.trackCount) * sizeof(TrackEntry) &&
+        header.pointsOffset <= header.timesOffset &&
+        header.timesOffset <= header.namesOffset &&
+        header.namesOffset <= header.fileSize;
+    if (!validLayout) {
+        std::cerr << "ERROR::TRACK_LIBRARY::INVALID_ARCHIVE: " << archivePath << std::endl;
+        archive.close();
+        return false;
+    }
+
+    // Listing the directory is far cheaper than parsing it, and catches added, deleted and edited files
+    if (!sourceDirectory.empty()) {
+        std::vector<std::string> files;
+        if (listTrackFiles(sourceDirectory, files) && hashSourceFiles(sourceDirectory, files) != header.sourceHash) {
+            std::cout << "INFO: Track archive is out of date with " << sourceDirectory << ", reimporting." << std::endl;
+            archive.close();
+            return false;
+        }
+    }
+
+    entryData = reinterpret_cast<const TrackEntry*>(base + sizeof(Header));
+    pointData = reinterpret_cast<const glm::vec3*>(base + header.pointsOffset);
+    timeData = reinterpret_cast<const float*>(base + header.timesOffset);
+    nameData = reinterpret_cast<const char*>(base + header.namesOffset);
+    trackCount = header.trackCount;
+    sourceHash = header.sourceHash;
+
+    // Reject entries pointing outside their arrays rather than reading past the mapping later
+    uint64_t pointCount = (header.timesOffset - header.pointsOffset) / sizeof(glm::vec3);
+    uint64_t timeCount = (header.namesOffset - header.timesOffset) / sizeof(float);
+    uint64_t nameBytes = header.fileSize - header.namesOffset;
+    for (size_t i = 0; i < trackCount; ++i) {
+        const TrackEntry& entry = entryData[i];
+        if (entry.firstPoint + entry.pointCount > pointCount ||
+            entry.firstTime + entry.timeCount > timeCount ||
+            uint64_t(entry.nameOffset) + entry.nameLength > nameBytes) {
+            std::cerr << "ERROR::TRACK_LIBRARY::INVALID_ARCHIVE: " << archivePath << std::endl;
+            clear();
+            return false;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "INFO: Opened track archive with " << trackCount << " tracks in " << seconds * 1000.0 << " ms." << std::endl;
+    return true;
+}
+
+bool TrackLibrary::listTrackFiles(const std::string& directory, std::vector<std::string>& files) {
+    files.clear();
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+        !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        std::string extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".gpx" || extension == ".csv" || extension == ".txt") {
+            files.push_back(it->path().string());
+        }
+    }
+    // Iteration order is up to the file system; the listing hash must not be
+    std::sort(files.begin(), files.end());
+    return !error;
+}
+
+uint64_t TrackLibrary::hashSourceFiles(const std::string& directory, const std::vector<std::string>& files) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (const std::string& file : files) {
+        std::error_code error;
+        std::string relative = std::filesystem::path(file).lexically_relative(directory).generic_string();
+        uint64_t size = std::filesystem::file_size(file, error);
+        int64_t modified = static_cast<int64_t>(std::filesystem::last_write_time(file, error).time_since_epoch().count());
+        // The terminator keeps "ab" + "c" apart from "a" + "bc"
+        mix(relative.c_str(), relative.size() + 1);
+        mix(&size, sizeof(size));
+        mix(&modified, sizeof(modified));
+    }
+    return hash;
+}
+
+bool TrackLibrary::parseTrackFile(const std::string& path, ParsedTrack& track) {
+    std::string contents;
+    if (!readWholeFile(path, contents)) {
+        std::cerr << "ERROR::TRACK_LIBRARY::FAILED_TO_READ: " << path << std::endl;
+        return false;
+    }
+
+    std::filesystem::path filePath(path);
+    track.name = filePath.filename().string();
+
+    std::string extension = filePath.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    bool parsed = extension == ".gpx" ? parseGpx(contents, track) : parseNumberRows(contents, track);
+
+    return parsed && track.points.size() >= 2;
+}
+
+bool TrackLibrary::parseGpx(std::string_view text, ParsedTrack& track) {
+    double originLatitude = 0.0, originLongitude = 0.0, originTime = 0.0;
+    double metresPerDegree = EARTH_RADIUS * glm::pi<double>() / 180.0;
+    bool allTimed = true;
+
+    size_t position = 0;
+    while ((position = text.find("<trkpt", position)) != std::string_view::npos) {
+        size_t tagEnd = text.find('>', position);
+        size_t pointEnd = text.find("</trkpt>", position);
+        if (tagEnd == std::string_view::npos) {
+            break;
+        }
+        std::string_view tag = text.substr(position, tagEnd - position);
+        std::string_view body = pointEnd == std::string_view::npos || tag.back() == '/'
+            ? std::string_view() : text.substr(tagEnd, pointEnd - tagEnd);
+        position = tagEnd;
+
+        double latitude, longitude, elevation = 0.0, seconds;
+        if (!parseNumber(attributeValue(tag, "lat"), latitude) || !parseNumber(attributeValue(tag, "lon"), longitude)) {
+            continue;
+        }
+        parseNumber(elementText(body, "<ele>", "</ele>"), elevation);
+        bool timed = parseIsoTimestamp(elementText(body, "<time>", "</time>"), seconds);
+
+        // Local metres east and north of the first point, same frame as the path text files;
+        // east distances use the mean latitude between the point and the origin
+        if (track.points.empty()) {
+            originLatitude = latitude;
+            originLongitude = longitude;
+            originTime = timed ? seconds : 0.0;
+        }
+        double eastScale = metresPerDegree * std::cos(glm::radians(0.5 * (originLatitude + latitude)));
+        track.points.emplace_back(static_cast<float>((longitude - originLongitude) * eastScale),
+            static_cast<float>((latitude - originLatitude) * metresPerDegree),
+            static_cast<float>(elevation));
+
+        // Clock jumps backwards are flattened so the times stay sorted
+        allTimed = allTimed && timed;
+        if (allTimed) {
+            float offset = static_cast<float>(seconds - originTime);
+            track.times.push_back(track.times.empty() ? 0.0f : std::max(offset, track.times.back()));
+        }
+    }
+
+    if (!allTimed) {
+        track.times.clear();
+    }
+    return !track.points.empty();
+}
+
+bool TrackLibrary::parseNumberRows(std::string_view text, ParsedTrack& track) {
+    // Rows of three numbers separated by spaces, tabs or commas; anything else, such as a header, is skipped
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = text.size();
+        }
+
+        const char* cursor = text.data() + lineStart;
+        const char* end = text.data() + lineEnd;
+        float values[3];
+        int count = 0;
+        while (count < 3) {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == ',' || *cursor == '\r')) {
+                ++cursor;
+            }
+            auto result = std::from_chars(cursor, end, values[count]);
+            if (result.ec != std::errc()) {
+                break;
+            }
+            cursor = result.ptr;
+            ++count;
+        }
+        if (count == 3) {
+            track.points.emplace_back(values[0], values[1], values[2]);
+        }
+
+        lineStart = lineEnd + 1;
+    }
+    return !track.points.empty();
+}
+
+uint64_t TrackLibrary::hashTrack(const ParsedTrack& track) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    uint64_t pointCount = track.points.size();
+    mix(&pointCount, sizeof(pointCount));
+    mix(track.points.data(), track.points.size() * sizeof(glm::vec3));
+    mix(track.times.data(), track.times.size() * sizeof(float));
+    return hash;
+}
+
+bool TrackLibrary::parseIsoTimestamp(std::string_view text, double& seconds) {
+    int year, month, day, hour, minute;
+    double second;
+    std::string buffer(text);
+    if (std::sscanf(buffer.c_str(), "%d-%d-%dT%d:%d:%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
+        return false;
+    }
+
+    // Days from civil date (proleptic Gregorian calendar)
+    year -= month <= 2 ? 1 : 0;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    double days = static_cast<double>(era) * 146097.0 + dayOfEra - 719468.0;
+
+    seconds = days * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+    return true;
+}
@@ -0,0 +1,192 @@
+// TrackLibrary.h
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+/**
+ * @class TrackLibrary
+ * @brief Collection of recorded tracks, ingested from a directory or reopened from a packed archive.
+ *
+ * Points use the same frame as the hiker path files: metres east and north of the first point,
+ * then elevation. GPX tracks are projected into that frame; TXT and CSV files are taken as is.
+ *
+ * Archive layout, little endian:
+ *   Header | TrackEntry[trackCount] | vec3 points | float times | name bytes
+ * Every track is a contiguous slice of the shared point and time arrays, so a reopened archive
+ * is served straight from the memory mapping without parsing or copying. The header keeps a hash
+ * of the source files' paths, sizes and modification times, so an archive can be checked against
+ * the directory it was packed from.
+ */
+class TrackLibrary {
+public:
+    /**
+     * @brief Read-only view of one track. Valid until the library is reloaded or cleared.
+     */
+    struct TrackView {
+        std::string_view name;              ///< File name the track was read from.
+        uint64_t contentHash = 0;           ///< Hash of the parsed points and times.
+        const glm::vec3* points = nullptr;  ///< Track points.
+        size_t pointCount = 0;              ///< Number of points.
+        const float* times = nullptr;       ///< Seconds since the first point, or nullptr.
+        size_t timeCount = 0;               ///< Number of times, 0 or pointCount.
+
+        std::vector<glm::vec3> getPoints() const;
+        std::vector<float> getTimes() const;
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    TrackLibrary();
+
+    /**
+     * @brief Parses every .gpx, .csv and .txt file under a directory on the thread pool.
+     * Tracks with identical content are kept once. Replaces the current contents.
+     * @param directory Directory to scan recursively.
+     * @return True if at least one track was loaded.
+     */
+    bool importDirectory(const std::string& directory);
+
+    /**
+     * @brief Writes the current tracks to a packed archive.
+     * @param archivePath Output file.
+     * @return True on success.
+     */
+    bool writeArchive(const std::string& archivePath) const;
+
+    /**
+     * @brief Memory-maps a packed archive. Replaces the current contents.
+     * @param archivePath Archive written by writeArchive.
+     * @param sourceDirectory Directory the archive was packed from; if given, the archive is
+     *        rejected when a track file there was added, removed or changed since.
+     * @return True if the archive was valid and, with a source directory, up to date.
+     */
+    bool openArchive(const std::string& archivePath, const std::string& sourceDirectory = "");
+
+    /**
+     * @brief Removes all tracks and unmaps any archive.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of tracks.
+     * @return Track count.
+     */
+    size_t getTrackCount() const;
+
+    /**
+     * @brief Gets a track by index.
+     * @param index Track index, below getTrackCount().
+     * @return View of the track.
+     */
+    TrackView getTrack(size_t index) const;
+
+    /**
+     * @brief Finds a track by file name.
+     * @param name File name including extension, e.g. "Afternoon_Run3.txt".
+     * @return Track index, or -1 if not found.
+     */
+    int findTrack(std::string_view name) const;
+
+    /**
+     * @brief Parses an ISO 8601 UTC timestamp such as 2024-06-18T13:58:44Z.
+     * @param text Timestamp text.
+     * @param seconds Output seconds since 1970.
+     * @return True if the text was a timestamp.
+     */
+    static bool parseIsoTimestamp(std::string_view text, double& seconds);
+
+private:
+    /**
+     * @brief Archive file header.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t trackCount;
+        uint64_t pointsOffset;
+        uint64_t timesOffset;
+        uint64_t namesOffset;
+        uint64_t fileSize;
+        uint64_t sourceHash;    ///< Hash of the source file listing, see hashSourceFiles.
+    };
+
+    /**
+     * @brief Offset table entry, also used for tracks held in memory.
+     */
+    struct TrackEntry {
+        uint64_t contentHash;
+        uint64_t firstPoint;
+        uint64_t firstTime;
+        uint32_t pointCount;
+        uint32_t timeCount;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+    };
+
+    /**
+     * @brief One file's parse result.
+     */
+    struct ParsedTrack {
+        std::string name;
+        std::vector<glm::vec3> points;
+        std::vector<float> times;
+        uint64_t contentHash = 0;
+    };
+
+    // Tracks are served from either the mapping or these arrays, in the same layout
+    std::vector<TrackEntry> entries;
+    std::vector<glm::vec3> points;
+    std::vector<float> times;
+    std::string names;
+
+    MappedFile archive;                 ///< Mapped archive, when opened from one.
+    const TrackEntry* entryData;        ///< Offset table in use.
+    const glm::vec3* pointData;         ///< Point array in use.
+    const float* timeData;              ///< Time array in use.
+    const char* nameData;               ///< Name bytes in use.
+    size_t trackCount;                  ///< Number of tracks.
+    uint64_t sourceHash;                ///< Source listing hash of the tracks in use.
+
+    /**
+     * @brief Points the data pointers at the in-memory arrays.
+     */
+    void useMemoryArrays();
+
+    /**
+     * @brief Lists the .gpx, .csv and .txt files under a directory.
+     * @param directory Directory to scan recursively.
+     * @param files Output paths, sorted.
+     * @return False if the directory could not be read.
+     */
+    static bool listTrackFiles(const std::string& directory, std::vector<std::string>& files);
+
+    /**
+     * @brief Hashes the path relative to the directory, size and modification time of each file.
+     * @param directory Directory the files were listed from.
+     * @param files Sorted paths from listTrackFiles.
+     * @return Listing hash; changes when a file is added, removed or rewritten.
+     */
+    static uint64_t hashSourceFiles(const std::string& directory, const std::vector<std::string>& files);
+
+    /**
+     * @brief Parses one track file, choosing the format by extension.
+     * @param path File to parse.
+     * @param track Output track.
+     * @return True if the file held at least two points.
+     */
+    static bool parseTrackFile(const std::string& path, ParsedTrack& track);
+    static bool parseGpx(std::string_view text, ParsedTrack& track);
+    static bool parseNumberRows(std::string_view text, ParsedTrack& track);
+
+    /**
+     * @brief 64-bit FNV-1a hash of the parsed points and times.
+     */
+    static uint64_t hashTrack(const ParsedTrack& track);
+};
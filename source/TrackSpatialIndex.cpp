@@ -0,0 +1,285 @@
+// TrackSpatialIndex.cpp
+
+#include "TrackSpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Upper bound on grid cells, so a few huge segments cannot blow up memory
+    const size_t MAX_CELLS = size_t(1) << 22;
+
+    glm::vec2 horizontal(const glm::vec3& point) {
+        return glm::vec2(point.x, point.z);
+    }
+}
+
+TrackSpatialIndex::TrackSpatialIndex()
+    : cellSize(0.0f), builtCellSize(1.0f), trackCount(0),
+    gridMin(0.0f), cellsX(0), cellsZ(0) {}
+
+void TrackSpatialIndex::setCellSize(float size) {
+    cellSize = size;
+}
+
+uint32_t TrackSpatialIndex::addTrack(const std::vector<glm::vec3>& points) {
+    uint32_t trackId = trackCount++;
+
+    float offset = 0.0f;
+    for (size_t i = 1; i < points.size(); ++i) {
+        segmentStarts.push_back(points[i - 1]);
+        segmentEnds.push_back(points[i]);
+        segmentTracks.push_back(trackId);
+        segmentIndices.push_back(static_cast<uint32_t>(i - 1));
+        segmentOffsets.push_back(offset);
+        offset += glm::distance(points[i - 1], points[i]);
+    }
+
+    return trackId;
+}
+
+void TrackSpatialIndex::clear() {
+    trackCount = 0;
+    segmentStarts.clear();
+    segmentEnds.clear();
+    segmentTracks.clear();
+    segmentIndices.clear();
+    segmentOffsets.clear();
+    cellStarts.clear();
+    cellSegments.clear();
+    cellsX = 0;
+    cellsZ = 0;
+}
+
+size_t TrackSpatialIndex::getSegmentCount() const {
+    return segmentStarts.size();
+}
+
+int TrackSpatialIndex::cellX(float x) const {
+    return glm::clamp(static_cast<int>(std::floor((x - gridMin.x) / builtCellSize)), 0, cellsX - 1);
+}
+
+int TrackSpatialIndex::cellZ(float z) const {
+    return glm::clamp(static_cast<int>(std::floor((z - gridMin.y) / builtCellSize)), 0, cellsZ - 1);
+}
+
+void TrackSpatialIndex::build() {
+    cellStarts.clear();
+    cellSegments.clear();
+    cellsX = 0;
+    cellsZ = 0;
+
+    size_t segmentCount = segmentStarts.size();
+    if (segmentCount == 0) {
+        return;
+    }
+
+    // Bounds and average segment length
+    glm::vec2 boundsMin(std::numeric_limits<float>::max());
+    glm::vec2 boundsMax(std::numeric_limits<float>::lowest());
+    double totalLength = 0.0;
+    for (size_t i = 0; i < segmentCount; ++i) {
+        glm::vec2 start = horizontal(segmentStarts[i]);
+        glm::vec2 end = horizontal(segmentEnds[i]);
+        boundsMin = glm::min(boundsMin, glm::min(start, end));
+        boundsMax = glm::max(boundsMax, glm::max(start, end));
+        totalLength += glm::distance(start, end);
+    }
+
+    // A cell a few segments wide keeps both the per-cell lists and the cells per segment small
+    glm::vec2 extent = glm::max(boundsMax - boundsMin, glm::vec2(1e-3f));
+    builtCellSize = cellSize > 0.0f ? cellSize : std::max(static_cast<float>(totalLength / segmentCount) * 4.0f, 1e-3f);
+    float minimumCellSize = std::sqrt(extent.x * extent.y / static_cast<float>(MAX_CELLS));
+    builtCellSize = std::max(builtCellSize, minimumCellSize);
+
+    gridMin = boundsMin;
+    cellsX = static_cast<int>(extent.x / builtCellSize) + 1;
+    cellsZ = static_cast<int>(extent.y / builtCellSize) + 1;
+    size_t cellCount = static_cast<size_t>(cellsX) * cellsZ;
+
+    // Each segment goes into every cell its bounding box overlaps: count, prefix-sum, then fill
+    auto forEachCell = [this](size_t segment, auto&& visit) {
+        glm::vec2 start = horizontal(segmentStarts[segment]);
+        glm::vec2 end = horizontal(segmentEnds[segment]);
+        int x0 = cellX(std::min(start.x, end.x));
+        int x1 = cellX(std::max(start.x, end.x));
+        int z0 = cellZ(std::min(start.y, end.y));
+        int z1 = cellZ(std::max(start.y, end.y));
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                visit(static_cast<size_t>(z) * cellsX + x);
+            }
+        }
+    };
+
+    cellStarts.assign(cellCount + 1, 0);
+    for (size_t i = 0; i < segmentCount; ++i) {
+        forEachCell(i, [this](size_t cell) { ++cellStarts[cell + 1]; });
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        cellStarts[cell + 1] += cellStarts[cell];
+    }
+
+    std::vector<uint32_t> fillCursor(cellStarts.begin(), cellStarts.end() - 1);
+    cellSegments.resize(cellStarts.back());
+    for (size_t i = 0; i < segmentCount; ++i) {
+        forEachCell(i, [this, &fillCursor, i](size_t cell) { cellSegments[fillCursor[cell]++] = static_cast<uint32_t>(i); });
+    }
+
+    std::cout << "INFO: Track spatial index built: " << segmentCount << " segments from " << trackCount
+        << " tracks in " << cellsX << " x " << cellsZ << " cells of size " << builtCellSize << std::endl;
+}
+
+TrackSpatialIndex::Hit TrackSpatialIndex::closestPoint(uint32_t segment, const glm::vec2& position) const {
+    glm::vec2 start = horizontal(segmentStarts[segment]);
+    glm::vec2 delta = horizontal(segmentEnds[segment]) - start;
+
+    float lengthSquared = glm::dot(delta, delta);
+    float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(position - start, delta) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+
+    Hit hit;
+    hit.trackId = segmentTracks[segment];
+    hit.segmentIndex = segmentIndices[segment];
+    hit.fraction = t;
+    hit.distance = glm::distance(position, start + delta * t);
+    hit.point = glm::mix(segmentStarts[segment], segmentEnds[segment], t);
+    hit.trackDistance = segmentOffsets[segment] + t * glm::distance(segmentStarts[segment], segmentEnds[segment]);
+    return hit;
+}
+
+bool TrackSpatialIndex::findNearest(const glm::vec3& position, Hit& hit, float maxDistance) const {
+    if (cellStarts.empty()) {
+        return false;
+    }
+
+    glm::vec2 query = horizontal(position);
+    int centerX = cellX(query.x);
+    int centerZ = cellZ(query.y);
+    int maxRing = std::max(cellsX, cellsZ);
+
+    float bestDistance = maxDistance;
+    bool found = false;
+
+    // Visit rings of cells around the query cell until no unvisited cell can hold anything closer
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        int x0 = centerX - ring, x1 = centerX + ring;
+        int z0 = centerZ - ring, z1 = centerZ + ring;
+
+        for (int z = std::max(z0, 0); z <= std::min(z1, cellsZ - 1); ++z) {
+            bool edgeRow = (z == z0 || z == z1);
+            for (int x = std::max(x0, 0); x <= std::min(x1, cellsX - 1); ++x) {
+                if (!edgeRow && x != x0 && x != x1) {
+                    continue;
+                }
+
+                size_t cell = static_cast<size_t>(z) * cellsX + x;
+                for (uint32_t k = cellStarts[cell]; k < cellStarts[cell + 1]; ++k) {
+                    Hit candidate = closestPoint(cellSegments[k], query);
+                    if (candidate.distance < bestDistance) {
+                        bestDistance = candidate.distance;
+                        hit = candidate;
+                        found = true;
+                    }
+                }
+            }
+        }
+
+        // Cells outside this ring lie beyond one of its sides; sides at the grid edge have nothing beyond them
+        float bound = std::numeric_limits<float>::max();
+        if (x0 > 0) bound = std::min(bound, std::max(query.x - (gridMin.x + x0 * builtCellSize), 0.0f));
+        if (x1 < cellsX - 1) bound = std::min(bound, std::max(gridMin.x + (x1 + 1) * builtCellSize - query.x, 0.0f));
+        if (z0 > 0) bound = std::min(bound, std::max(query.y - (gridMin.y + z0 * builtCellSize), 0.0f));
+        if (z1 < cellsZ - 1) bound = std::min(bound, std::max(gridMin.y + (z1 + 1) * builtCellSize - query.y, 0.0f));
+
+        if (bound >= bestDistance) {
+            break;
+        }
+    }
+
+    return found;
+}
+
+void TrackSpatialIndex::queryRadius(const glm::vec3& center, float radius, std::vector<Hit>& hits) const {
+    hits.clear();
+    if (cellStarts.empty()) {
+        return;
+    }
+
+    glm::vec2 query = horizontal(center);
+    int x0 = cellX(query.x - radius), x1 = cellX(query.x + radius);
+    int z0 = cellZ(query.y - radius), z1 = cellZ(query.y + radius);
+
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            size_t cell = static_cast<size_t>(z) * cellsX + x;
+            for (uint32_t k = cellStarts[cell]; k < cellStarts[cell + 1]; ++k) {
+                Hit candidate = closestPoint(cellSegments[k], query);
+                if (candidate.distance <= radius) {
+                    hits.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    removeDuplicates(hits);
+}
+
+void TrackSpatialIndex::queryBox(const glm::vec2& boxMin, const glm::vec2& boxMax, std::vector<Hit>& hits) const {
+    hits.clear();
+    if (cellStarts.empty()) {
+        return;
+    }
+
+    int x0 = cellX(boxMin.x), x1 = cellX(boxMax.x);
+    int z0 = cellZ(boxMin.y), z1 = cellZ(boxMax.y);
+    glm::vec2 boxCenter = (boxMin + boxMax) * 0.5f;
+
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            size_t cell = static_cast<size_t>(z) * cellsX + x;
+            for (uint32_t k = cellStarts[cell]; k < cellStarts[cell + 1]; ++k) {
+                uint32_t segment = cellSegments[k];
+                glm::vec2 start = horizontal(segmentStarts[segment]);
+                glm::vec2 delta = horizontal(segmentEnds[segment]) - start;
+
+                // Clip the segment against the box slab by slab
+                float tEnter = 0.0f, tExit = 1.0f;
+                bool inside = true;
+                for (int axis = 0; axis < 2 && inside; ++axis) {
+                    if (std::abs(delta[axis]) < 1e-12f) {
+                        inside = start[axis] >= boxMin[axis] && start[axis] <= boxMax[axis];
+                        continue;
+                    }
+                    float tA = (boxMin[axis] - start[axis]) / delta[axis];
+                    float tB = (boxMax[axis] - start[axis]) / delta[axis];
+                    tEnter = std::max(tEnter, std::min(tA, tB));
+                    tExit = std::min(tExit, std::max(tA, tB));
+                    inside = tEnter <= tExit;
+                }
+
+                if (inside) {
+                    Hit hit = closestPoint(segment, boxCenter);
+                    hit.fraction = tEnter;
+                    hit.point = glm::mix(segmentStarts[segment], segmentEnds[segment], tEnter);
+                    hit.distance = glm::distance(boxCenter, start + delta * tEnter);
+                    hit.trackDistance = segmentOffsets[segment] + tEnter * glm::distance(segmentStarts[segment], segmentEnds[segment]);
+                    hits.push_back(hit);
+                }
+            }
+        }
+    }
+
+    removeDuplicates(hits);
+}
+
+void TrackSpatialIndex::removeDuplicates(std::vector<Hit>& hits) {
+    auto bySegment = [](const Hit& a, const Hit& b) {
+        return a.trackId != b.trackId ? a.trackId < b.trackId : a.segmentIndex < b.segmentIndex;
+    };
+    auto sameSegment = [](const Hit& a, const Hit& b) {
+        return a.trackId == b.trackId && a.segmentIndex == b.segmentIndex;
+    };
+
+    std::sort(hits.begin(), hits.end(), bySegment);
+    hits.erase(std::unique(hits.begin(), hits.end(), sameSegment), hits.end());
+}
@@ -0,0 +1,129 @@
+// TrackSpatialIndex.h
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @class TrackSpatialIndex
+ * @brief Uniform grid over the segments of any number of tracks for nearest, radius and box queries.
+ *
+ * Queries work in the horizontal (x, z) plane, which is what snapping a camera, a mouse pick
+ * or another hiker onto a trail needs. Hits still report the 3D point on the segment.
+ * Cells are stored in compressed form: one offset per cell into a single array of segment ids.
+ */
+class TrackSpatialIndex {
+public:
+    /**
+     * @brief A segment found by a query.
+     */
+    struct Hit {
+        uint32_t trackId = 0;       ///< Track the segment belongs to.
+        uint32_t segmentIndex = 0;  ///< Segment index within the track.
+        float fraction = 0.0f;      ///< Position of the closest point along the segment in [0, 1].
+        float distance = 0.0f;      ///< Horizontal distance from the query point.
+        float trackDistance = 0.0f; ///< Distance of the closest point from the start of the track.
+        glm::vec3 point{ 0.0f };    ///< Closest point on the segment.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    TrackSpatialIndex();
+
+    /**
+     * @brief Sets the grid cell size used by the next build.
+     * @param size Cell edge length in world units, or 0 to derive it from the average segment length.
+     */
+    void setCellSize(float size);
+
+    /**
+     * @brief Adds a track. Call build() after adding tracks to make them queryable.
+     * @param points Track points in world space.
+     * @return Track id used in query hits.
+     */
+    uint32_t addTrack(const std::vector<glm::vec3>& points);
+
+    /**
+     * @brief Builds the grid over all tracks added so far.
+     */
+    void build();
+
+    /**
+     * @brief Removes all tracks and the grid.
+     */
+    void clear();
+
+    /**
+     * @brief Finds the closest segment to a position.
+     * @param position Query position; y is ignored.
+     * @param hit Output closest segment.
+     * @param maxDistance Segments further than this are ignored.
+     * @return True if a segment was found within maxDistance.
+     */
+    bool findNearest(const glm::vec3& position, Hit& hit,
+        float maxDistance = std::numeric_limits<float>::max()) const;
+
+    /**
+     * @brief Finds every segment passing within a radius of a position.
+     * @param center Query position; y is ignored.
+     * @param radius Search radius.
+     * @param hits Output segments, one per segment, with the closest point to center.
+     */
+    void queryRadius(const glm::vec3& center, float radius, std::vector<Hit>& hits) const;
+
+    /**
+     * @brief Finds every segment crossing an axis-aligned box.
+     * @param boxMin Minimum (x, z) corner.
+     * @param boxMax Maximum (x, z) corner.
+     * @param hits Output segments, one per segment, with fraction at the first point inside the box.
+     */
+    void queryBox(const glm::vec2& boxMin, const glm::vec2& boxMax, std::vector<Hit>& hits) const;
+
+    /**
+     * @brief Gets the number of indexed segments.
+     * @return Segment count.
+     */
+    size_t getSegmentCount() const;
+
+private:
+    float cellSize;                         ///< Requested cell size, 0 for automatic.
+    float builtCellSize;                    ///< Cell size of the current grid.
+    uint32_t trackCount;                    ///< Number of tracks added.
+
+    // Segments, structure of arrays
+    std::vector<glm::vec3> segmentStarts;   ///< Start point of each segment.
+    std::vector<glm::vec3> segmentEnds;     ///< End point of each segment.
+    std::vector<uint32_t> segmentTracks;    ///< Track id of each segment.
+    std::vector<uint32_t> segmentIndices;   ///< Index of each segment within its track.
+    std::vector<float> segmentOffsets;      ///< Track distance at each segment start.
+
+    // Grid
+    glm::vec2 gridMin;                      ///< Minimum (x, z) corner of the grid.
+    int cellsX;                             ///< Number of cells along x.
+    int cellsZ;                             ///< Number of cells along z.
+    std::vector<uint32_t> cellStarts;       ///< Offset of each cell's first entry; one extra entry at the end.
+    std::vector<uint32_t> cellSegments;     ///< Segment ids grouped by cell.
+
+    /**
+     * @brief Converts a world coordinate to a cell coordinate, clamped to the grid.
+     */
+    int cellX(float x) const;
+    int cellZ(float z) const;
+
+    /**
+     * @brief Computes the closest point on a segment to a position in the (x, z) plane.
+     * @param segment Segment id.
+     * @param position Query (x, z).
+     * @return Hit describing the closest point.
+     */
+    Hit closestPoint(uint32_t segment, const glm::vec2& position) const;
+
+    /**
+     * @brief Sorts hits by segment and removes segments that were found through several cells.
+     */
+    static void removeDuplicates(std::vector<Hit>& hits);
+};
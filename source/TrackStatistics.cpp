@@ -0,0 +1,182 @@
+// TrackStatistics.cpp
+
+#include "TrackStatistics.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+void TrackStatistics::MinMaxTree::build(const std::vector<float>& values) {
+    leafCount = values.size();
+    nodes.assign(leafCount * 2, MinMax{ 0.0f, 0.0f });
+
+    for (size_t i = 0; i < leafCount; ++i) {
+        nodes[leafCount + i] = MinMax{ values[i], values[i] };
+    }
+    for (size_t i = leafCount - 1; i > 0; --i) {
+        nodes[i].min = std::min(nodes[2 * i].min, nodes[2 * i + 1].min);
+        nodes[i].max = std::max(nodes[2 * i].max, nodes[2 * i + 1].max);
+    }
+}
+
+TrackStatistics::MinMax TrackStatistics::MinMaxTree::query(size_t from, size_t to) const {
+    MinMax result{ std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+
+    // Walk both ends up the tree, folding in the nodes that fall wholly inside the range
+    for (from += leafCount, to += leafCount; from < to; from >>= 1, to >>= 1) {
+        if (from & 1) {
+            result.min = std::min(result.min, nodes[from].min);
+            result.max = std::max(result.max, nodes[from].max);
+            ++from;
+        }
+        if (to & 1) {
+            --to;
+            result.min = std::min(result.min, nodes[to].min);
+            result.max = std::max(result.max, nodes[to].max);
+        }
+    }
+    return result;
+}
+
+TrackStatistics::TrackStatistics() {}
+
+void TrackStatistics::build(const std::vector<glm::vec3>& points, const std::vector<float>& times) {
+    size_t pointCount = points.size();
+
+    cumulativeDistance.assign(pointCount, 0.0f);
+    cumulativeAscent.assign(pointCount, 0.0f);
+    cumulativeDescent.assign(pointCount, 0.0f);
+    elevations.resize(pointCount);
+    grades.clear();
+    pointTimes.clear();
+
+    if (pointCount < 2) {
+        return;
+    }
+
+    grades.resize(pointCount - 1);
+    elevations[0] = points[0].y;
+    for (size_t i = 1; i < pointCount; ++i) {
+        float rise = points[i].y - points[i - 1].y;
+        float run = glm::length(glm::vec2(points[i].x - points[i - 1].x, points[i].z - points[i - 1].z));
+
+        cumulativeDistance[i] = cumulativeDistance[i - 1] + glm::distance(points[i - 1], points[i]);
+        cumulativeAscent[i] = cumulativeAscent[i - 1] + std::max(rise, 0.0f);
+        cumulativeDescent[i] = cumulativeDescent[i - 1] + std::max(-rise, 0.0f);
+        elevations[i] = points[i].y;
+        grades[i - 1] = run > 0.0f ? rise / run : 0.0f;
+    }
+
+    if (times.size() == pointCount) {
+        pointTimes = times;
+    }
+
+    elevationTree.build(elevations);
+    gradeTree.build(grades);
+}
+
+bool TrackStatistics::isBuilt() const {
+    return !grades.empty();
+}
+
+float TrackStatistics::getTotalDistance() const {
+    return cumulativeDistance.empty() ? 0.0f : cumulativeDistance.back();
+}
+
+float TrackStatistics::getDistanceAt(size_t index) const {
+    return cumulativeDistance[index];
+}
+
+float TrackStatistics::getDistance(size_t from, size_t to) const {
+    return cumulativeDistance[to] - cumulativeDistance[from];
+}
+
+float TrackStatistics::getAscent(size_t from, size_t to) const {
+    return cumulativeAscent[to] - cumulativeAscent[from];
+}
+
+float TrackStatistics::getDescent(size_t from, size_t to) const {
+    return cumulativeDescent[to] - cumulativeDescent[from];
+}
+
+float TrackStatistics::getDuration(size_t from, size_t to) const {
+    return pointTimes.empty() ? 0.0f : pointTimes[to] - pointTimes[from];
+}
+
+float TrackStatistics::getMinElevation(size_t from, size_t to) const {
+    return elevationTree.query(from, to + 1).min;
+}
+
+float TrackStatistics::getMaxElevation(size_t from, size_t to) const {
+    return elevationTree.query(from, to + 1).max;
+}
+
+float TrackStatistics::getMaxGrade(size_t from, size_t to) const {
+    return from < to ? gradeTree.query(from, to).max : 0.0f;
+}
+
+float TrackStatistics::getMinGrade(size_t from, size_t to) const {
+    return from < to ? gradeTree.query(from, to).min : 0.0f;
+}
+
+size_t TrackStatistics::locate(float distance, float& fraction) const {
+    size_t lastSegment = cumulativeDistance.size() - 2;
+    distance = glm::clamp(distance, 0.0f, cumulativeDistance.back());
+
+    auto it = std::upper_bound(cumulativeDistance.begin(), cumulativeDistance.end(), distance);
+    size_t segment = static_cast<size_t>(std::max<std::ptrdiff_t>(it - cumulativeDistance.begin() - 1, 0));
+    segment = std::min(segment, lastSegment);
+
+    float segmentLength = cumulativeDistance[segment + 1] - cumulativeDistance[segment];
+    fraction = segmentLength > 0.0f ? (distance - cumulativeDistance[segment]) / segmentLength : 0.0f;
+    return segment;
+}
+
+TrackStatistics::Interval TrackStatistics::query(float fromDistance, float toDistance) const {
+    Interval result;
+    if (!isBuilt()) {
+        return result;
+    }
+
+    if (fromDistance > toDistance) {
+        std::swap(fromDistance, toDistance);
+    }
+
+    float fromFraction, toFraction;
+    size_t fromSegment = locate(fromDistance, fromFraction);
+    size_t toSegment = locate(toDistance, toFraction);
+
+    // Prefix values grow linearly within a segment, so partial segments interpolate
+    auto prefixAt = [](const std::vector<float>& prefix, size_t segment, float fraction) {
+        return glm::mix(prefix[segment], prefix[segment + 1], fraction);
+    };
+
+    result.distance = prefixAt(cumulativeDistance, toSegment, toFraction) - prefixAt(cumulativeDistance, fromSegment, fromFraction);
+    result.ascent = prefixAt(cumulativeAscent, toSegment, toFraction) - prefixAt(cumulativeAscent, fromSegment, fromFraction);
+    result.descent = prefixAt(cumulativeDescent, toSegment, toFraction) - prefixAt(cumulativeDescent, fromSegment, fromFraction);
+
+    // The interpolated end elevations plus every whole point in between
+    float fromElevation = prefixAt(elevations, fromSegment, fromFraction);
+    float toElevation = prefixAt(elevations, toSegment, toFraction);
+    result.minElevation = std::min(fromElevation, toElevation);
+    result.maxElevation = std::max(fromElevation, toElevation);
+    if (fromSegment < toSegment) {
+        MinMax inner = elevationTree.query(fromSegment + 1, toSegment + 1);
+        result.minElevation = std::min(result.minElevation, inner.min);
+        result.maxElevation = std::max(result.maxElevation, inner.max);
+    }
+
+    // Every segment touched, including partially covered ones at both ends
+    size_t gradeEnd = (toFraction > 0.0f || toSegment == fromSegment) ? toSegment + 1 : toSegment;
+    MinMax grade = gradeTree.query(fromSegment, gradeEnd);
+    result.minGrade = grade.min;
+    result.maxGrade = grade.max;
+
+    if (!pointTimes.empty()) {
+        result.duration = prefixAt(pointTimes, toSegment, toFraction) - prefixAt(pointTimes, fromSegment, fromFraction);
+        if (result.distance > 0.0f) {
+            result.averagePace = result.duration / (result.distance / 1000.0f);
+        }
+    }
+
+    return result;
+}
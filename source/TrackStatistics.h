@@ -0,0 +1,124 @@
+// TrackStatistics.h
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class TrackStatistics
+ * @brief Answers "from A to B" questions about a track without rescanning its points.
+ *
+ * Prefix sums give distance, ascent, descent and duration between two points in O(1).
+ * Segment trees give minimum/maximum elevation and grade over a range in O(log n).
+ * Queries by distance add one binary search to find the segments containing both ends.
+ */
+class TrackStatistics {
+public:
+    /**
+     * @brief Statistics over a stretch of the track.
+     */
+    struct Interval {
+        float distance = 0.0f;      ///< Distance covered.
+        float ascent = 0.0f;        ///< Total climb.
+        float descent = 0.0f;       ///< Total descent, as a positive value.
+        float minElevation = 0.0f;  ///< Lowest elevation.
+        float maxElevation = 0.0f;  ///< Highest elevation.
+        float maxGrade = 0.0f;      ///< Steepest climb, rise over horizontal run.
+        float minGrade = 0.0f;      ///< Steepest descent, negative rise over horizontal run.
+        float duration = 0.0f;      ///< Recorded time, 0 without timestamps.
+        float averagePace = 0.0f;   ///< Seconds per kilometre, 0 without timestamps.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    TrackStatistics();
+
+    /**
+     * @brief Builds the prefix sums and segment trees in O(n).
+     * @param points Track points; y is the elevation.
+     * @param times Optional recorded time of each point. Ignored unless it has one entry per point.
+     */
+    void build(const std::vector<glm::vec3>& points, const std::vector<float>& times = {});
+
+    /**
+     * @brief Checks if statistics were built for a track with at least one segment.
+     * @return True if built.
+     */
+    bool isBuilt() const;
+
+    /**
+     * @brief Gets the total track length.
+     * @return Sum of all segment lengths.
+     */
+    float getTotalDistance() const;
+
+    /**
+     * @brief Gets the distance from the start to a point in O(1).
+     * @param index Point index.
+     * @return Cumulative distance at the point.
+     */
+    float getDistanceAt(size_t index) const;
+
+    // Between two point indices, from <= to, in O(1)
+    float getDistance(size_t from, size_t to) const;
+    float getAscent(size_t from, size_t to) const;
+    float getDescent(size_t from, size_t to) const;
+    float getDuration(size_t from, size_t to) const;
+
+    // Between two point indices, from <= to, in O(log n)
+    float getMinElevation(size_t from, size_t to) const;
+    float getMaxElevation(size_t from, size_t to) const;
+    float getMaxGrade(size_t from, size_t to) const;
+    float getMinGrade(size_t from, size_t to) const;
+
+    /**
+     * @brief Computes every statistic between two distances along the track in O(log n).
+     * Ends inside a segment are interpolated linearly.
+     * @param fromDistance Start distance; swapped with toDistance if larger.
+     * @param toDistance End distance.
+     * @return Statistics over the stretch.
+     */
+    Interval query(float fromDistance, float toDistance) const;
+
+private:
+    /**
+     * @brief Minimum and maximum of a range.
+     */
+    struct MinMax {
+        float min;
+        float max;
+    };
+
+    /**
+     * @brief Bottom-up segment tree of min/max values.
+     */
+    class MinMaxTree {
+    public:
+        void build(const std::vector<float>& values);
+        MinMax query(size_t from, size_t to) const; ///< Half-open range [from, to), must be non-empty.
+
+    private:
+        size_t leafCount = 0;
+        std::vector<MinMax> nodes;
+    };
+
+    std::vector<float> cumulativeDistance;  ///< Distance from the start to each point.
+    std::vector<float> cumulativeAscent;    ///< Climb from the start to each point.
+    std::vector<float> cumulativeDescent;   ///< Descent from the start to each point.
+    std::vector<float> pointTimes;          ///< Recorded time of each point, empty without timestamps.
+    std::vector<float> elevations;          ///< Elevation of each point.
+    std::vector<float> grades;              ///< Grade of each segment.
+    MinMaxTree elevationTree;               ///< Min/max over point elevations.
+    MinMaxTree gradeTree;                   ///< Min/max over segment grades.
+
+    /**
+     * @brief Finds the segment containing a distance and how far along it the distance lies.
+     * @param distance Distance along the track, clamped to the track.
+     * @param fraction Output position within the segment in [0, 1].
+     * @return Segment index.
+     */
+    size_t locate(float distance, float& fraction) const;
+};
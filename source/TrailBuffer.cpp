@@ -0,0 +1,120 @@
+// TrailBuffer.cpp
+
+#include "TrailBuffer.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <iostream>
+
+TrailBuffer::TrailBuffer()
+    : VAO(0), VBO(0), capacity(0), appendedCount(0) {}
+
+TrailBuffer::~TrailBuffer() {
+    cleanup();
+}
+
+bool TrailBuffer::initialize(size_t capacity) {
+    cleanup();
+
+    if (capacity < 2) {
+        std::cerr << "ERROR::TRAIL_BUFFER::CAPACITY_TOO_SMALL" << std::endl;
+        return false;
+    }
+    this->capacity = capacity;
+
+    // Ring slots, the mirror of slot 0, and one spare slot the tip vertex indices can point at
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, (capacity + 2) * 2 * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+
+    // Position attribute
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+
+    GLStateCache::getInstance().bindVertexArray(0);
+    return true;
+}
+
+void TrailBuffer::writeSlot(size_t slot, const glm::vec3* edges) {
+    glBufferSubData(GL_ARRAY_BUFFER, slot * 2 * sizeof(glm::vec3), 2 * sizeof(glm::vec3), edges);
+}
+
+void TrailBuffer::append(const glm::vec3& left, const glm::vec3& right) {
+    if (VBO == 0) {
+        return;
+    }
+
+    glm::vec3 edges[2] = { left, right };
+    size_t slot = appendedCount % capacity;
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    writeSlot(slot, edges);
+    if (slot == 0) {
+        writeSlot(capacity, edges);
+    }
+    ++appendedCount;
+}
+
+void TrailBuffer::clear() {
+    appendedCount = 0;
+}
+
+void TrailBuffer::render(Shader& shader, size_t count, const glm::vec3* tip) const {
+    count = std::min(count, getSize());
+    if (VAO == 0 || count == 0) {
+        return;
+    }
+
+    shader.use();
+    shader.setMat4("model", glm::mat4(1.0f));
+    shader.setVec3("tipLeft", tip ? tip[0] : glm::vec3(0.0f));
+    shader.setVec3("tipRight", tip ? tip[1] : glm::vec3(0.0f));
+
+    // The oldest kept point lives in slot 0 until the ring wraps; slot n starts at vertex 2n
+    size_t first = appendedCount > capacity ? appendedCount % capacity : 0;
+    size_t tipSlots = tip ? 1 : 0;
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    if (first + count <= capacity + 1) {
+        shader.setInt("tipIndex", tip ? static_cast<int>((first + count) * 2) : -1);
+        glDrawArrays(GL_TRIANGLE_STRIP, static_cast<GLint>(first * 2), static_cast<GLsizei>((count + tipSlots) * 2));
+    }
+    else {
+        // Up to and including the mirror of slot 0, then on from slot 0
+        shader.setInt("tipIndex", -1);
+        glDrawArrays(GL_TRIANGLE_STRIP, static_cast<GLint>(first * 2), static_cast<GLsizei>((capacity + 1 - first) * 2));
+
+        size_t remaining = count - (capacity - first);
+        shader.setInt("tipIndex", tip ? static_cast<int>(remaining * 2) : -1);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, static_cast<GLsizei>((remaining + tipSlots) * 2));
+    }
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void TrailBuffer::cleanup() {
+    if (VAO) {
+        GLStateCache::getInstance().deleteVertexArray(VAO);
+        VAO = 0;
+    }
+    if (VBO) {
+        glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+    capacity = 0;
+    appendedCount = 0;
+}
+
+size_t TrailBuffer::getSize() const {
+    return std::min(appendedCount, capacity);
+}
+
+size_t TrailBuffer::getAppendedCount() const {
+    return appendedCount;
+}
+
+size_t TrailBuffer::getCapacity() const {
+    return capacity;
+}
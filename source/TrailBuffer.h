@@ -0,0 +1,95 @@
+// TrailBuffer.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Shader.h"
+
+/**
+ * @class TrailBuffer
+ * @brief Append-only ribbon in a fixed GPU ring, for trails that grow while they are drawn.
+ *
+ * Each point is the left and right edge of the ribbon across it, drawn as a triangle strip so the
+ * width does not depend on glLineWidth limits. Appending writes one pair in place, so the buffer is
+ * never re-uploaded. Once full, the oldest points are overwritten. Slot 0 is mirrored into one
+ * extra slot at the end of the ring so a wrapped trail still draws as two strips that share an edge.
+ *
+ * The end of the drawn trail can lie between two stored points. That tip pair is passed as uniforms
+ * and substituted in trailVert.glsl for the pair after the last one drawn, so moving it every frame
+ * costs no buffer writes at all.
+ */
+class TrailBuffer {
+public:
+    /**
+     * @brief Constructor.
+     */
+    TrailBuffer();
+
+    /**
+     * @brief Destructor.
+     */
+    ~TrailBuffer();
+
+    /**
+     * @brief Allocates the ring and clears the trail.
+     * @param capacity Number of points kept before the oldest are overwritten.
+     * @return True if the buffer was created.
+     */
+    bool initialize(size_t capacity);
+
+    /**
+     * @brief Appends a point in O(1).
+     * @param left Left edge of the ribbon at the point, in world space.
+     * @param right Right edge of the ribbon at the point, in world space.
+     */
+    void append(const glm::vec3& left, const glm::vec3& right);
+
+    /**
+     * @brief Empties the trail without touching the GPU buffer.
+     */
+    void clear();
+
+    /**
+     * @brief Draws the oldest points of the trail as a triangle strip, optionally ending at a tip.
+     * The caller sets pathColor on the shader.
+     * @param shader Shader built from trailVert.glsl.
+     * @param count Number of stored points to draw, clamped to getSize().
+     * @param tip Left and right edge of an extra final point after the last drawn one, or nullptr.
+     */
+    void render(Shader& shader, size_t count, const glm::vec3* tip = nullptr) const;
+
+    /**
+     * @brief Cleans up OpenGL resources.
+     */
+    void cleanup();
+
+    /**
+     * @brief Gets the number of points kept.
+     * @return Points currently in the ring.
+     */
+    size_t getSize() const;
+
+    /**
+     * @brief Gets the number of points appended since the last clear, including overwritten ones.
+     * @return Appended point count.
+     */
+    size_t getAppendedCount() const;
+
+    /**
+     * @brief Gets the ring capacity.
+     * @return Maximum points kept.
+     */
+    size_t getCapacity() const;
+
+private:
+    GLuint VAO;
+    GLuint VBO;
+    size_t capacity;        ///< Ring slots holding points.
+    size_t appendedCount;   ///< Points appended since the last clear.
+
+    /**
+     * @brief Writes one edge pair into a slot.
+     */
+    void writeSlot(size_t slot, const glm::vec3* edges);
+};
@@ -0,0 +1,202 @@
+// TrailRibbon.cpp
+
+#include "TrailRibbon.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+TrailRibbon::TrailRibbon()
+    : VAO(0), VBO(0), vertexCount(0) {}
+
+TrailRibbon::~TrailRibbon() {
+    cleanup();
+}
+
+/**
+ * @brief Appends the start of a segment and every grid-edge crossing along it.
+ */
+void TrailRibbon::densifySegment(const glm::vec2& start, const glm::vec2& end, size_t segment, const Terrain& terrain,
+    std::vector<Sample>& samples) {
+    glm::vec2 gridStart = terrain.worldToGrid(start.x, start.y);
+    glm::vec2 gridEnd = terrain.worldToGrid(end.x, end.y);
+    glm::vec2 gridDelta = gridEnd - gridStart;
+
+    // Parameters along the segment where it crosses a line coord = k for integer k
+    std::vector<float> crossings;
+    auto addCrossings = [&crossings](float from, float delta) {
+        if (std::abs(delta) < 1e-6f) {
+            return;
+        }
+        float low = std::min(from, from + delta);
+        float high = std::max(from, from + delta);
+        for (float k = std::floor(low) + 1.0f; k < high; k += 1.0f) {
+            crossings.push_back((k - from) / delta);
+        }
+    };
+
+    // Vertical and horizontal cell edges, plus the x + z = k diagonals that split each cell into triangles
+    addCrossings(gridStart.x, gridDelta.x);
+    addCrossings(gridStart.y, gridDelta.y);
+    addCrossings(gridStart.x + gridStart.y, gridDelta.x + gridDelta.y);
+    std::sort(crossings.begin(), crossings.end());
+
+    float base = static_cast<float>(segment);
+    samples.push_back({ start, base });
+    float lastT = 0.0f;
+    for (float t : crossings) {
+        // Crossings through a grid vertex show up twice
+        if (t - lastT > 1e-4f && t < 1.0f - 1e-4f) {
+            samples.push_back({ glm::mix(start, end, t), base + t });
+            lastT = t;
+        }
+    }
+}
+
+bool TrailRibbon::build(const std::vector<glm::vec3>& pathPoints, const Terrain& terrain, float width, float heightOffset) {
+    cleanup();
+
+    if (pathPoints.size() < 2) {
+        return false;
+    }
+
+    ThreadPool& pool = ThreadPool::getInstance();
+
+    // Densify fixed-size runs of segments in parallel; each run fills its own list so the order stays stable
+    const size_t segmentsPerChunk = 256;
+    size_t segmentCount = pathPoints.size() - 1;
+    size_t chunkCount = (segmentCount + segmentsPerChunk - 1) / segmentsPerChunk;
+    std::vector<std::vector<Sample>> chunkSamples(chunkCount);
+
+    pool.parallelFor(chunkCount, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            size_t first = chunk * segmentsPerChunk;
+            size_t last = std::min(first + segmentsPerChunk, segmentCount);
+            for (size_t i = first; i < last; ++i) {
+                glm::vec2 segmentStart(pathPoints[i].x, pathPoints[i].z);
+                glm::vec2 segmentEnd(pathPoints[i + 1].x, pathPoints[i + 1].z);
+                densifySegment(segmentStart, segmentEnd, i, terrain, chunkSamples[chunk]);
+            }
+        }
+    });
+
+    // Stitch the runs in path order, dropping repeated GPS fixes that would give a zero-length tangent
+    size_t totalSamples = 1;
+    for (const auto& samples : chunkSamples) {
+        totalSamples += samples.size();
+    }
+
+    std::vector<glm::vec2> centers;
+    centers.reserve(totalSamples);
+    sampleParameters.reserve(totalSamples);
+    auto appendCenter = [this, &centers](const Sample& sample) {
+        if (centers.empty() || glm::distance(centers.back(), sample.position) > 1e-4f) {
+            centers.push_back(sample.position);
+            sampleParameters.push_back(sample.parameter);
+        }
+    };
+    for (const auto& samples : chunkSamples) {
+        for (const auto& sample : samples) {
+            appendCenter(sample);
+        }
+    }
+    appendCenter({ glm::vec2(pathPoints.back().x, pathPoints.back().z), static_cast<float>(segmentCount) });
+
+    if (centers.size() < 2) {
+        sampleParameters.clear();
+        return false;
+    }
+
+    // Offset each sample sideways and look up the edge heights a batch at a time
+    size_t sampleCount = centers.size();
+    float halfWidth = width * 0.5f;
+    vertices.resize(sampleCount * 2);
+
+    pool.parallelFor(sampleCount, [&](size_t begin, size_t end) {
+        std::vector<glm::vec2> edges;
+        edges.reserve((end - begin) * 2);
+
+        for (size_t i = begin; i < end; ++i) {
+            glm::vec2 previous = centers[i > 0 ? i - 1 : 0];
+            glm::vec2 next = centers[std::min(i + 1, sampleCount - 1)];
+            glm::vec2 direction = next - previous;
+            if (glm::dot(direction, direction) < 1e-8f) {
+                // The path doubles back on itself here; use the outgoing direction alone
+                direction = next != centers[i] ? next - centers[i] : centers[i] - previous;
+            }
+            glm::vec2 tangent = glm::normalize(direction);
+            glm::vec2 side = glm::vec2(-tangent.y, tangent.x) * halfWidth;
+
+            edges.push_back(centers[i] + side);
+            edges.push_back(centers[i] - side);
+        }
+
+        std::vector<float> edgeHeights(edges.size());
+        terrain.getHeightsAtPositions(edges.data(), edges.size(), edgeHeights.data());
+
+        for (size_t k = 0; k < edges.size(); ++k) {
+            vertices[begin * 2 + k] = glm::vec3(edges[k].x, edgeHeights[k] + heightOffset, edges[k].y);
+        }
+    });
+
+    // Upload the strip
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+
+    // Position attribute
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+
+    GLStateCache::getInstance().bindVertexArray(0);
+
+    vertexCount = static_cast<GLsizei>(vertices.size());
+
+    std::cout << "INFO: Trail ribbon built from " << pathPoints.size() << " path points into "
+        << sampleCount << " terrain-following samples." << std::endl;
+    return true;
+}
+
+void TrailRibbon::render() const {
+    if (vertexCount == 0) return;
+
+    GLStateCache::getInstance().bindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertexCount);
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void TrailRibbon::cleanup() {
+    if (VAO) {
+        GLStateCache::getInstance().deleteVertexArray(VAO);
+        VAO = 0;
+    }
+    if (VBO) {
+        glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+    vertexCount = 0;
+    vertices.clear();
+    sampleParameters.clear();
+}
+
+bool TrailRibbon::isBuilt() const {
+    return vertexCount > 0;
+}
+
+GLsizei TrailRibbon::getVertexCount() const {
+    return vertexCount;
+}
+
+const std::vector<glm::vec3>& TrailRibbon::getVertices() const {
+    return vertices;
+}
+
+const std::vector<float>& TrailRibbon::getSampleParameters() const {
+    return sampleParameters;
+}
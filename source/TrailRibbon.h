@@ -0,0 +1,99 @@
+// TrailRibbon.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Terrain.h"
+
+/**
+ * @class TrailRibbon
+ * @brief Triangle-strip mesh of a path draped over the terrain.
+ *
+ * Each path segment is split wherever it crosses a heightmap cell edge or triangle diagonal,
+ * so the ribbon bends with the terrain instead of cutting through hills between GPS points.
+ * The vertices and the path position of each sample are kept after upload, so a part of the
+ * path can be drawn from the same surface.
+ */
+class TrailRibbon {
+public:
+    /**
+     * @brief Constructor.
+     */
+    TrailRibbon();
+
+    /**
+     * @brief Destructor that cleans up OpenGL resources.
+     */
+    ~TrailRibbon();
+
+    /**
+     * @brief Builds the ribbon mesh and uploads it. Densification and height lookups run in parallel.
+     * @param pathPoints Path points in world space.
+     * @param terrain Terrain to drape the ribbon over.
+     * @param width Ribbon width in world units.
+     * @param heightOffset Distance kept above the terrain surface.
+     * @return True if a mesh was built, false if the path has fewer than two points.
+     */
+    bool build(const std::vector<glm::vec3>& pathPoints, const Terrain& terrain, float width, float heightOffset);
+
+    /**
+     * @brief Draws the ribbon with a single draw call. The caller binds the shader and sets uniforms.
+     */
+    void render() const;
+
+    /**
+     * @brief Cleans up OpenGL resources.
+     */
+    void cleanup();
+
+    /**
+     * @brief Checks if the ribbon has a mesh to draw.
+     * @return True if built.
+     */
+    bool isBuilt() const;
+
+    /**
+     * @brief Gets the number of strip vertices.
+     * @return Vertex count, two per densified sample.
+     */
+    GLsizei getVertexCount() const;
+
+    /**
+     * @brief Gets the strip vertices, the left then the right edge of each sample.
+     * @return Vertices as uploaded.
+     */
+    const std::vector<glm::vec3>& getVertices() const;
+
+    /**
+     * @brief Gets where each sample lies on the path, as segment index plus fraction along the segment.
+     * @return Increasing path parameters, one per sample.
+     */
+    const std::vector<float>& getSampleParameters() const;
+
+private:
+    /**
+     * @brief Point on the path centerline.
+     */
+    struct Sample {
+        glm::vec2 position;   ///< World (x, z).
+        float parameter;      ///< Segment index plus fraction along the segment.
+    };
+
+    GLuint VAO, VBO;          ///< Vertex Array Object and Vertex Buffer Object.
+    GLsizei vertexCount;      ///< Number of strip vertices.
+    std::vector<glm::vec3> vertices;
+    std::vector<float> sampleParameters;
+
+    /**
+     * @brief Appends the start of a segment and every grid-edge crossing along it (supercover walk).
+     * @param start Segment start in world (x, z).
+     * @param end Segment end in world (x, z).
+     * @param segment Index of the segment in the path.
+     * @param terrain Terrain providing the grid mapping.
+     * @param samples Output list of samples.
+     */
+    static void densifySegment(const glm::vec2& start, const glm::vec2& end, size_t segment, const Terrain& terrain,
+        std::vector<Sample>& samples);
+};
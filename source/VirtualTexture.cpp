@@ -0,0 +1,498 @@
+// VirtualTexture.cpp
+
+#include "VirtualTexture.h"
+#include "GLStateCache.h"
+#include "ThreadPool.h"
+#include "../Linker/include/stb/stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+    const char PAGE_FILE_MAGIC[8] = { 'S', 'P', 'V', 'R', 'V', 'T', 'E', 'X' };
+    const uint32_t PAGE_FILE_VERSION = 1;
+    const uint32_t PAGE_BORDER = 4;
+    const uint64_t PINNED = std::numeric_limits<uint64_t>::max();
+
+    int keyLevel(uint64_t key) { return static_cast<int>(key >> 56); }
+    int keyX(uint64_t key) { return static_cast<int>(key & 0xFFFFFFF); }
+    int keyY(uint64_t key) { return static_cast<int>((key >> 28) & 0xFFFFFFF); }
+
+    // Slot x, slot y, resident level, valid; read back as RGBA8 by the shader
+    uint32_t packEntry(int slotX, int slotY, int level) {
+        return static_cast<uint32_t>(slotX) | static_cast<uint32_t>(slotY) << 8 | static_cast<uint32_t>(level) << 16 | 0xFF000000u;
+    }
+
+    /**
+     * @brief One mip level of the image being cut, only as large as the image itself; pages past it repeat its edge.
+     */
+    struct LevelImage {
+        const unsigned char* texels;
+        int width;
+        int height;
+
+        const unsigned char* at(int x, int y) const {
+            x = std::clamp(x, 0, width - 1);
+            y = std::clamp(y, 0, height - 1);
+            return texels + (static_cast<size_t>(y) * width + x) * 4;
+        }
+    };
+
+    // 2x2 box filter; odd edges reuse their last texel
+    std::vector<unsigned char> downsample(const LevelImage& level, int& width, int& height) {
+        width = (level.width + 1) / 2;
+        height = (level.height + 1) / 2;
+        std::vector<unsigned char> result(static_cast<size_t>(width) * height * 4);
+        ThreadPool::getInstance().parallelFor(static_cast<size_t>(height), [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    int sx = x * 2, sy = static_cast<int>(y) * 2;
+                    const unsigned char* a = level.at(sx, sy);
+                    const unsigned char* b = level.at(sx + 1, sy);
+                    const unsigned char* c = level.at(sx, sy + 1);
+                    const unsigned char* d = level.at(sx + 1, sy + 1);
+                    unsigned char* out = result.data() + (y * width + x) * 4;
+                    for (int channel = 0; channel < 4; ++channel) {
+                        out[channel] = static_cast<unsigned char>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+}
+
+VirtualTexture::VirtualTexture()
+    : header(), slotsPerSide(0), slotSize(0), pageBytes(0), boundsMin(0.0f), boundsMax(1.0f),
+    physicalTexture(0), indirectionTexture(0), frame(0), maxPendingPages(32), maxUploadsPerUpdate(16) {}
+
+VirtualTexture::~VirtualTexture() {
+    cleanup();
+}
+
+uint64_t VirtualTexture::makeKey(int level, int x, int y) {
+    return static_cast<uint64_t>(level) << 56 | static_cast<uint64_t>(y) << 28 | static_cast<uint64_t>(x);
+}
+
+int VirtualTexture::getPagesPerSide(int level) const {
+    return static_cast<int>(header.size / header.pageSize) >> level;
+}
+
+bool VirtualTexture::build(const std::string& image, const std::string& pageFile, int pageSize) {
+    auto startTime = std::chrono::steady_clock::now();
+    int width, height, channels;
+    unsigned char* data = stbi_load(image.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::FAILED_TO_LOAD_IMAGE: " << image << std::endl;
+        return false;
+    }
+
+    // Pad to a power of two number of pages so every level halves cleanly down to one page
+    pageSize = std::max(pageSize, 16);
+    int pagesNeeded = (std::max(width, height) + pageSize - 1) / pageSize;
+    int pagesPerSide = 1;
+    uint32_t levelCount = 1;
+    while (pagesPerSide < pagesNeeded) {
+        pagesPerSide *= 2;
+        ++levelCount;
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, PAGE_FILE_MAGIC, sizeof(header.magic));
+    header.version = PAGE_FILE_VERSION;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.size = static_cast<uint32_t>(pagesPerSide * pageSize);
+    header.pageSize = static_cast<uint32_t>(pageSize);
+    header.border = PAGE_BORDER;
+    header.levelCount = levelCount;
+
+    int slotSize = pageSize + 2 * static_cast<int>(PAGE_BORDER);
+    size_t pageBytes = static_cast<size_t>(slotSize) * slotSize * 4;
+    uint64_t pageCount = 0;
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        uint64_t side = static_cast<uint64_t>(pagesPerSide >> level);
+        pageCount += side * side;
+    }
+    header.fileSize = sizeof(Header) + pageCount * pageBytes;
+
+    std::ofstream file(pageFile, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::FAILED_TO_WRITE_PAGE_FILE: " << pageFile << std::endl;
+        stbi_image_free(data);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+    // Only two levels are held at a time; each row of pages is cut in parallel and written in order
+    LevelImage level = { data, width, height };
+    std::vector<unsigned char> levelTexels;
+    std::vector<unsigned char> pageRow;
+    for (uint32_t levelIndex = 0; levelIndex < levelCount; ++levelIndex) {
+        int pages = pagesPerSide >> levelIndex;
+        pageRow.resize(pageBytes * pages);
+        for (int pageY = 0; pageY < pages; ++pageY) {
+            ThreadPool::getInstance().parallelFor(static_cast<size_t>(pages), [&](size_t begin, size_t end) {
+                for (size_t pageX = begin; pageX < end; ++pageX) {
+                    unsigned char* out = pageRow.data() + pageX * pageBytes;
+                    int originX = static_cast<int>(pageX) * pageSize - static_cast<int>(PAGE_BORDER);
+                    int originY = pageY * pageSize - static_cast<int>(PAGE_BORDER);
+                    for (int y = 0; y < slotSize; ++y) {
+                        for (int x = 0; x < slotSize; ++x) {
+                            std::memcpy(out + (static_cast<size_t>(y) * slotSize + x) * 4, level.at(originX + x, originY + y), 4);
+                        }
+                    }
+                }
+            });
+            file.write(reinterpret_cast<const char*>(pageRow.data()), static_cast<std::streamsize>(pageRow.size()));
+        }
+
+        if (levelIndex + 1 < levelCount) {
+            int nextWidth, nextHeight;
+            std::vector<unsigned char> next = downsample(level, nextWidth, nextHeight);
+            levelTexels.swap(next);
+            level = { levelTexels.data(), nextWidth, nextHeight };
+        }
+    }
+    stbi_image_free(data);
+
+    if (!file.good()) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::FAILED_TO_WRITE_PAGE_FILE: " << pageFile << std::endl;
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "INFO: Built virtual texture " << pageFile << ": " << width << " x " << height << ", "
+        << pageCount << " pages in " << levelCount << " levels, " << seconds * 1000.0 << " ms." << std::endl;
+    return true;
+}
+
+bool VirtualTexture::open(const std::string& pageFile, int cacheSizeInPages) {
+    cleanup();
+
+    if (!file.open(pageFile)) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::FAILED_TO_OPEN_PAGE_FILE: " << pageFile << std::endl;
+        return false;
+    }
+    if (file.getSize() < sizeof(Header)) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::INVALID_PAGE_FILE: " << pageFile << std::endl;
+        file.close();
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(Header));
+
+    bool validLayout = std::memcmp(header.magic, PAGE_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == PAGE_FILE_VERSION &&
+        header.fileSize == file.getSize() &&
+        header.pageSize > 0 && header.levelCount > 0 && header.levelCount < 28 &&
+        header.size == header.pageSize << (header.levelCount - 1) &&
+        header.width > 0 && header.width <= header.size && header.height > 0 && header.height <= header.size;
+    slotSize = static_cast<int>(header.pageSize + 2 * header.border);
+    pageBytes = static_cast<size_t>(slotSize) * slotSize * 4;
+    levelFirstPage.clear();
+    uint64_t pageCount = 0;
+    for (uint32_t level = 0; validLayout && level < header.levelCount; ++level) {
+        levelFirstPage.push_back(pageCount);
+        uint64_t side = static_cast<uint64_t>(getPagesPerSide(level));
+        pageCount += side * side;
+    }
+    if (!validLayout || header.fileSize != sizeof(Header) + pageCount * pageBytes) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::INVALID_PAGE_FILE: " << pageFile << std::endl;
+        file.close();
+        return false;
+    }
+
+    // Slot coordinates are stored in 8 bits, and the cache has to fit in one texture
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    slotsPerSide = std::clamp(cacheSizeInPages, 2, 256);
+    slotsPerSide = std::min(slotsPerSide, std::max(maxTextureSize / slotSize, 2));
+    int cacheSize = slotsPerSide * slotSize;
+
+    glGenTextures(1, &physicalTexture);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, physicalTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheSize, cacheSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Level k of the indirection texture has one texel per page of level k
+    indirection.assign(header.levelCount, {});
+    glGenTextures(1, &indirectionTexture);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, indirectionTexture);
+    for (uint32_t level = 0; level < header.levelCount; ++level) {
+        int side = getPagesPerSide(level);
+        indirection[level].assign(static_cast<size_t>(side) * side, 0);
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, indirection[level].data());
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+
+    slots.assign(static_cast<size_t>(slotsPerSide) * slotsPerSide, Slot());
+    frame = 0;
+    statistics = Statistics();
+
+    // The single page of the last level is the fallback for everything, so it never leaves
+    int lastLevel = static_cast<int>(header.levelCount) - 1;
+    LoadedPage coarsest = { makeKey(lastLevel, 0, 0), std::vector<unsigned char>(pageBytes) };
+    std::memcpy(coarsest.texels.data(), file.getData() + sizeof(Header) + levelFirstPage[lastLevel] * pageBytes, pageBytes);
+    uploadPage(coarsest);
+    slots[residentPages[coarsest.page]].lastUsed = PINNED;
+
+    std::cout << "INFO: Opened virtual texture " << pageFile << ": " << header.width << " x " << header.height
+        << ", " << header.levelCount << " levels, cache of " << slots.size() << " pages ("
+        << cacheSize << " x " << cacheSize << ")." << std::endl;
+    return true;
+}
+
+bool VirtualTexture::isOpen() const {
+    return physicalTexture != 0;
+}
+
+void VirtualTexture::setBounds(const glm::vec3& min, const glm::vec3& max) {
+    boundsMin = min;
+    boundsMax = max;
+}
+
+void VirtualTexture::selectPages(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float pixelsPerUnit,
+    std::vector<PageRequest>& requests) const {
+    // Frustum planes from the rows of the combined matrix
+    glm::mat4 m = glm::transpose(viewProjection);
+    const glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+
+    glm::vec2 worldPerTexel((boundsMax.x - boundsMin.x) / header.width, (boundsMax.z - boundsMin.z) / header.height);
+    float texelWorldSize = std::max(worldPerTexel.x, worldPerTexel.y);
+
+    // Quadtree walk from the single coarsest page; a page is refined while its texels cover more than a pixel
+    std::vector<uint64_t> stack = { makeKey(static_cast<int>(header.levelCount) - 1, 0, 0) };
+    while (!stack.empty()) {
+        uint64_t key = stack.back();
+        stack.pop_back();
+        int level = keyLevel(key), x = keyX(key), y = keyY(key);
+
+        // Pages entirely in the padding are never sampled
+        int texelsPerPage = static_cast<int>(header.pageSize) << level;
+        if (static_cast<int64_t>(x) * texelsPerPage >= header.width || static_cast<int64_t>(y) * texelsPerPage >= header.height) {
+            continue;
+        }
+        glm::vec3 lower(boundsMin.x + x * texelsPerPage * worldPerTexel.x, boundsMin.y, boundsMin.z + y * texelsPerPage * worldPerTexel.y);
+        glm::vec3 upper(std::min(lower.x + texelsPerPage * worldPerTexel.x, boundsMax.x), boundsMax.y,
+            std::min(lower.z + texelsPerPage * worldPerTexel.y, boundsMax.z));
+
+        bool visible = true;
+        for (const glm::vec4& plane : planes) {
+            glm::vec3 farthest(plane.x >= 0.0f ? upper.x : lower.x, plane.y >= 0.0f ? upper.y : lower.y, plane.z >= 0.0f ? upper.z : lower.z);
+            if (glm::dot(glm::vec3(plane), farthest) + plane.w < 0.0f) {
+                visible = false;
+                break;
+            }
+        }
+        if (!visible) {
+            continue;
+        }
+
+        float distance = std::max(glm::length(glm::clamp(cameraPosition, lower, upper) - cameraPosition), 1e-3f);
+        requests.push_back({ key, level, distance });
+
+        float texelPixels = texelWorldSize * static_cast<float>(1 << level) * pixelsPerUnit / distance;
+        if (level > 0 && texelPixels > 1.0f) {
+            for (int child = 0; child < 4; ++child) {
+                stack.push_back(makeKey(level - 1, x * 2 + (child & 1), y * 2 + (child >> 1)));
+            }
+        }
+    }
+}
+
+void VirtualTexture::update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float viewportHeight) {
+    if (!isOpen()) {
+        return;
+    }
+    ++frame;
+    statistics.uploadedPages = 0;
+    statistics.evictedPages = 0;
+
+    std::vector<PageRequest> requests;
+    selectPages(projection * view, cameraPosition, viewportHeight * 0.5f * projection[1][1], requests);
+    statistics.requestedPages = requests.size();
+
+    // Coarse pages first, then nearest; asking for more than the cache holds would only thrash it
+    std::sort(requests.begin(), requests.end(), [](const PageRequest& a, const PageRequest& b) {
+        return a.level != b.level ? a.level > b.level : a.distance < b.distance;
+    });
+    if (requests.size() > slots.size() - 1) {
+        requests.resize(slots.size() - 1);
+    }
+    for (const PageRequest& request : requests) {
+        auto resident = residentPages.find(request.page);
+        if (resident != residentPages.end()) {
+            Slot& slot = slots[resident->second];
+            slot.lastUsed = std::max(slot.lastUsed, frame);
+        }
+        else if (pendingPages.size() < maxPendingPages && pendingPages.count(request.page) == 0) {
+            loadPage(request.page);
+        }
+    }
+
+    while (!loads.empty() && loads.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        loads.pop_front();
+    }
+
+    std::vector<LoadedPage> arrived;
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        arrived.swap(loadedPages);
+    }
+    // Pages past the upload budget wait for the next update
+    size_t uploaded = 0;
+    for (LoadedPage& page : arrived) {
+        if (uploaded < maxUploadsPerUpdate) {
+            pendingPages.erase(page.page);
+            if (uploadPage(page)) {
+                ++uploaded;
+            }
+        }
+        else {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            loadedPages.push_back(std::move(page));
+        }
+    }
+    statistics.uploadedPages = uploaded;
+    statistics.residentPages = residentPages.size();
+    statistics.pendingPages = pendingPages.size();
+}
+
+void VirtualTexture::loadPage(uint64_t page) {
+    pendingPages.insert(page);
+    loads.push_back(ThreadPool::getInstance().submit([this, page]() {
+        // Touching the mapping is what reads the page from disk
+        int level = keyLevel(page);
+        uint64_t index = levelFirstPage[level] + static_cast<uint64_t>(keyY(page)) * getPagesPerSide(level) + keyX(page);
+        LoadedPage loaded = { page, std::vector<unsigned char>(pageBytes) };
+        std::memcpy(loaded.texels.data(), file.getData() + sizeof(Header) + index * pageBytes, pageBytes);
+
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        loadedPages.push_back(std::move(loaded));
+    }));
+}
+
+bool VirtualTexture::uploadPage(const LoadedPage& page) {
+    // A free slot, or else the one needed longest ago; pages wanted this frame stay
+    int slotIndex = -1;
+    uint64_t oldest = frame;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (!slots[i].occupied) {
+            slotIndex = static_cast<int>(i);
+            break;
+        }
+        if (slots[i].lastUsed < oldest) {
+            oldest = slots[i].lastUsed;
+            slotIndex = static_cast<int>(i);
+        }
+    }
+    if (slotIndex < 0) {
+        return false;
+    }
+
+    Slot& slot = slots[slotIndex];
+    if (slot.occupied) {
+        residentPages.erase(slot.page);
+        slot.occupied = false;
+        updateIndirection(keyLevel(slot.page), keyX(slot.page), keyY(slot.page));
+        ++statistics.evictedPages;
+    }
+
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, physicalTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slotIndex % slotsPerSide) * slotSize, (slotIndex / slotsPerSide) * slotSize,
+        slotSize, slotSize, GL_RGBA, GL_UNSIGNED_BYTE, page.texels.data());
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+
+    slot.page = page.page;
+    slot.lastUsed = frame;
+    slot.occupied = true;
+    residentPages[page.page] = slotIndex;
+    updateIndirection(keyLevel(page.page), keyX(page.page), keyY(page.page));
+    return true;
+}
+
+void VirtualTexture::updateIndirection(int level, int x, int y) {
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, indirectionTexture);
+
+    // Every finer page under this one points at its own slot if resident, else at whatever its parent points at
+    for (int k = level; k >= 0; --k) {
+        int span = 1 << (level - k);
+        int side = getPagesPerSide(k);
+        int parentSide = k + 1 < static_cast<int>(header.levelCount) ? getPagesPerSide(k + 1) : 0;
+        for (int pageY = y * span; pageY < (y + 1) * span; ++pageY) {
+            for (int pageX = x * span; pageX < (x + 1) * span; ++pageX) {
+                uint32_t entry = 0;
+                auto resident = residentPages.find(makeKey(k, pageX, pageY));
+                if (resident != residentPages.end()) {
+                    entry = packEntry(resident->second % slotsPerSide, resident->second / slotsPerSide, k);
+                }
+                else if (parentSide > 0) {
+                    entry = indirection[k + 1][static_cast<size_t>(pageY / 2) * parentSide + pageX / 2];
+                }
+                indirection[k][static_cast<size_t>(pageY) * side + pageX] = entry;
+            }
+        }
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, side);
+        glTexSubImage2D(GL_TEXTURE_2D, k, x * span, y * span, span, span, GL_RGBA, GL_UNSIGNED_BYTE,
+            indirection[k].data() + static_cast<size_t>(y * span) * side + x * span);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    GLStateCache::getInstance().bindTexture(0, GL_TEXTURE_2D, 0);
+}
+
+void VirtualTexture::bind(const Shader& shader, int physicalUnit, int indirectionUnit) const {
+    GLStateCache::getInstance().bindTexture(physicalUnit, GL_TEXTURE_2D, physicalTexture);
+    shader.setInt("vtPhysical", physicalUnit);
+    GLStateCache::getInstance().bindTexture(indirectionUnit, GL_TEXTURE_2D, indirectionTexture);
+    shader.setInt("vtIndirection", indirectionUnit);
+
+    // World (x, z) to texels of the padded level 0
+    glm::vec2 scale(header.width / (boundsMax.x - boundsMin.x), header.height / (boundsMax.z - boundsMin.z));
+    shader.setVec2("vtScale", scale);
+    shader.setVec2("vtOffset", -glm::vec2(boundsMin.x, boundsMin.z) * scale);
+    shader.setFloat("vtPageSize", static_cast<float>(header.pageSize));
+    shader.setFloat("vtBorder", static_cast<float>(header.border));
+    shader.setFloat("vtCacheSize", static_cast<float>(slotsPerSide * slotSize));
+    shader.setInt("vtMaxLevel", static_cast<int>(header.levelCount) - 1);
+}
+
+const VirtualTexture::Statistics& VirtualTexture::getStatistics() const {
+    return statistics;
+}
+
+/**
+ * @brief Cleans up OpenGL resources.
+ */
+void VirtualTexture::cleanup() {
+    // Reads in flight copy from the mapping into this object, so they finish first
+    for (std::future<void>& load : loads) {
+        load.wait();
+    }
+    loads.clear();
+    loadedPages.clear();
+    pendingPages.clear();
+    residentPages.clear();
+    slots.clear();
+    indirection.clear();
+
+    if (physicalTexture) {
+        GLStateCache::getInstance().deleteTexture(physicalTexture);
+        physicalTexture = 0;
+    }
+    if (indirectionTexture) {
+        GLStateCache::getInstance().deleteTexture(indirectionTexture);
+        indirectionTexture = 0;
+    }
+    file.close();
+}
@@ -0,0 +1,224 @@
+// VirtualTexture.h
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "MappedFile.h"
+#include "Shader.h"
+
+/**
+ * @class VirtualTexture
+ * @brief Streams a very large texture from a page file on disk through a fixed-size page cache.
+ *
+ * The image is cut into square pages at every mip level. Only the pages the camera needs are kept
+ * in video memory, in one physical cache texture with a fixed number of slots. An indirection
+ * texture, one texel per page at every level, tells the shader which slot holds each page, or the
+ * nearest coarser page that is resident while the fine one is still loading. Video memory use is
+ * set by the cache size alone, so the image size is limited by the disk.
+ *
+ * Each frame, update() walks the page quadtree against the view frustum and asks for the level
+ * whose texels cover about one pixel. Missing pages are copied out of the memory-mapped page file
+ * on the thread pool and uploaded on the next update() after they arrive. When the cache is full,
+ * the least recently needed pages make room. The coarsest page is always resident.
+ *
+ * Page file layout, little endian:
+ *   Header | pages of level 0 | pages of level 1 | ... | the single page of the last level
+ * Pages are stored row by row as RGBA8 with a border of neighbouring texels on every side, so
+ * bilinear filtering never reads across into another slot. The image is padded to a square power
+ * of two number of pages, so every level has half the pages of the one above it.
+ */
+class VirtualTexture {
+public:
+    /**
+     * @brief Page traffic of the last update().
+     */
+    struct Statistics {
+        size_t requestedPages = 0;  ///< Pages the visible terrain asked for.
+        size_t residentPages = 0;   ///< Pages in the cache.
+        size_t pendingPages = 0;    ///< Pages being read from disk.
+        size_t uploadedPages = 0;   ///< Pages copied into the cache this update.
+        size_t evictedPages = 0;    ///< Pages dropped to make room this update.
+    };
+
+    /**
+     * @brief Constructor.
+     */
+    VirtualTexture();
+
+    /**
+     * @brief Destructor. Waits for pages still loading.
+     */
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    /**
+     * @brief Cuts an image into a page file.
+     * @param image Source image, any format stb_image reads.
+     * @param pageFile Page file to write.
+     * @param pageSize Texels per page side, without the border.
+     * @return True if the file was written.
+     */
+    static bool build(const std::string& image, const std::string& pageFile, int pageSize = 128);
+
+    /**
+     * @brief Opens a page file and creates the cache and indirection textures.
+     * @param pageFile Page file written by build().
+     * @param cacheSizeInPages Slots per side of the physical cache, at most 256.
+     * @return True if the file is valid and the textures were created.
+     */
+    bool open(const std::string& pageFile, int cacheSizeInPages = 16);
+
+    /**
+     * @brief Checks if a page file is open.
+     * @return True if open.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Sets the world box the image is draped over. The image spans x and z; y is only used for culling.
+     * @param min Corner with the smallest coordinates.
+     * @param max Corner with the largest coordinates.
+     */
+    void setBounds(const glm::vec3& min, const glm::vec3& max);
+
+    /**
+     * @brief Requests the pages the view needs, uploads pages that finished loading and updates the indirection.
+     * @param view View matrix.
+     * @param projection Projection matrix.
+     * @param cameraPosition Camera position in world space.
+     * @param viewportHeight Height of the viewport in pixels.
+     */
+    void update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPosition, float viewportHeight);
+
+    /**
+     * @brief Binds the cache and indirection textures and sets the sampling uniforms.
+     * @param shader Shader using sampleVirtualTexture().
+     * @param physicalUnit Texture unit for the page cache.
+     * @param indirectionUnit Texture unit for the indirection texture.
+     */
+    void bind(const Shader& shader, int physicalUnit, int indirectionUnit) const;
+
+    /**
+     * @brief Gets the page traffic of the last update().
+     * @return Counters.
+     */
+    const Statistics& getStatistics() const;
+
+    /**
+     * @brief Cleans up OpenGL resources.
+     */
+    void cleanup();
+
+private:
+    /**
+     * @brief Page file header.
+     */
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t width;         ///< Image width in texels.
+        uint32_t height;        ///< Image height in texels.
+        uint32_t size;          ///< Padded side of level 0 in texels.
+        uint32_t pageSize;      ///< Texels per page side, without the border.
+        uint32_t border;        ///< Texels of border on each side of a page.
+        uint32_t levelCount;    ///< Mip levels, the last one a single page.
+        uint32_t reserved;
+        uint64_t fileSize;
+    };
+
+    /**
+     * @brief One slot of the physical cache.
+     */
+    struct Slot {
+        uint64_t page = 0;      ///< Key of the page held.
+        uint64_t lastUsed = 0;  ///< Frame the page was last requested.
+        bool occupied = false;
+    };
+
+    /**
+     * @brief A page the view needs.
+     */
+    struct PageRequest {
+        uint64_t page;
+        int level;
+        float distance;         ///< From the camera to the nearest point of the page.
+    };
+
+    /**
+     * @brief A page read from disk, waiting for upload.
+     */
+    struct LoadedPage {
+        uint64_t page;
+        std::vector<unsigned char> texels;
+    };
+
+    MappedFile file;
+    Header header;
+    int slotsPerSide;                               ///< Cache slots per side.
+    int slotSize;                                   ///< Page side with borders, in texels.
+    size_t pageBytes;                               ///< Bytes of one stored page.
+    std::vector<uint64_t> levelFirstPage;           ///< Index in the file of each level's first page.
+
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+
+    GLuint physicalTexture;                         ///< Page cache.
+    GLuint indirectionTexture;                      ///< Slot and level per page, one mip per level.
+    std::vector<std::vector<uint32_t>> indirection; ///< CPU copy of every indirection level.
+
+    std::vector<Slot> slots;
+    std::unordered_map<uint64_t, int> residentPages;    ///< Page key to slot.
+    std::unordered_set<uint64_t> pendingPages;          ///< Pages queued or being read.
+    std::deque<std::future<void>> loads;                ///< Reads still running on the thread pool.
+    std::mutex loadedMutex;
+    std::vector<LoadedPage> loadedPages;                ///< Finished reads, guarded by loadedMutex.
+
+    uint64_t frame;
+    size_t maxPendingPages;                         ///< Reads in flight at once.
+    size_t maxUploadsPerUpdate;                     ///< Pages copied into the cache per update.
+    Statistics statistics;
+
+    /**
+     * @brief Packs a page address into a key.
+     */
+    static uint64_t makeKey(int level, int x, int y);
+
+    /**
+     * @brief Gets the pages per side of a level.
+     */
+    int getPagesPerSide(int level) const;
+
+    /**
+     * @brief Collects the visible pages, descending until a texel covers about one pixel.
+     */
+    void selectPages(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float pixelsPerUnit,
+        std::vector<PageRequest>& requests) const;
+
+    /**
+     * @brief Queues a page read on the thread pool.
+     */
+    void loadPage(uint64_t page);
+
+    /**
+     * @brief Copies a loaded page into a free or the least recently used slot.
+     * @return False if every slot holds a page needed this frame.
+     */
+    bool uploadPage(const LoadedPage& page);
+
+    /**
+     * @brief Recomputes and uploads the indirection entries under a page after it arrived or left.
+     */
+    void updateIndirection(int level, int x, int y);
+};
@@ -3,6 +3,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "WindowManager.h"
+#include "HeadlessSimulation.h"
+#include "TextureCompressor.h"
+#include "VirtualTexture.h"
+#include "FrameUniforms.h"
+#include "GLStateCache.h"
 #include "Terrain.h"
 #include "Hiker.h"
 #include "Shader.h"
@@ -10,6 +15,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <string>
+#include <unordered_map>
 
 // Logging instance
 Logger logger("application.log");
@@ -149,7 +156,7 @@ void initHikerModel() {
     glGenVertexArrays(1, &hikerVAO);
     glGenBuffers(1, &hikerVBO);
 
-    glBindVertexArray(hikerVAO);
+    GLStateCache::getInstance().bindVertexArray(hikerVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, hikerVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
@@ -158,11 +165,11 @@ void initHikerModel() {
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 }
 
 // Function to render the hiker at its current position
-void renderHiker(const glm::vec3& position, Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
+void renderHiker(const glm::vec3& position, Shader& shader) {
     shader.use();
 
     glm::mat4 model = glm::mat4(1.0f);
@@ -170,17 +177,140 @@ void renderHiker(const glm::vec3& position, Shader& shader, const glm::mat4& vie
     model = glm::scale(model, glm::vec3(2.0f)); // Adjust scale as needed
 
     shader.setMat4("model", model);
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
 
     shader.setVec3("objectColor", glm::vec3(1.0f, 0.0f, 0.0f)); // Red color
 
-    glBindVertexArray(hikerVAO);
+    GLStateCache::getInstance().bindVertexArray(hikerVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
 }
 
-int main() {
+// Runs the simulation without a window, for batch studies over many tracks
+int runHeadless(int argc, char** argv) {
+    logger.log("INFO: Starting headless simulation");
+
+    HeadlessSimulation::Settings settings;
+    if (!HeadlessSimulation::parseArguments(argc, argv, settings)) {
+        std::cerr << "Usage: semProVR --headless [--heightmap file] [--tracks archive.pak|directory] "
+            "[--telemetry file.csv] [--step seconds] [--interval seconds] [--hours hours]" << std::endl;
+        return -1;
+    }
+
+    HeadlessSimulation simulation;
+    HeadlessSimulation::Result result;
+    if (!simulation.load(settings) || !simulation.run(result)) {
+        logger.log("ERROR: Headless simulation failed");
+        return -1;
+    }
+
+    logger.log("INFO: Headless simulation finished, " + std::to_string(result.simulatedSeconds / 3600.0 / result.wallSeconds) +
+        " simulated hours per second");
+    return 0;
+}
+
+// Converts every texture image to a block-compressed .ktx2 next to it, picked up at load time
+int runTextureCompression(const std::string& directory) {
+    logger.log("INFO: Compressing textures in " + directory);
+
+    size_t failures = TextureCompressor::compressDirectory(directory);
+    if (failures > 0) {
+        logger.log("ERROR: " + std::to_string(failures) + " textures failed to compress");
+        return -1;
+    }
+    logger.log("INFO: Texture compression finished");
+    return 0;
+}
+
+// Cuts an aerial image into a virtual texture page file; data/orthophoto.vtex is draped over the terrain
+int runVirtualTextureBuild(int argc, char** argv, int first) {
+    if (first >= argc) {
+        std::cerr << "Usage: semProVR --build-virtual-texture image [output.vtex]" << std::endl;
+        return -1;
+    }
+    std::string output = first + 1 < argc ? argv[first + 1] : "data/orthophoto.vtex";
+    logger.log("INFO: Building virtual texture " + output + " from " + argv[first]);
+
+    if (!VirtualTexture::build(argv[first], output)) {
+        logger.log("ERROR: Virtual texture build failed");
+        return -1;
+    }
+    return 0;
+}
+
+// Times 10k uniform sets per frame through the old string-keyed lookup and through Shader's hashed names
+int runUniformBenchmark() {
+    WindowManager windowManager(WIDTH, HEIGHT, "Uniform benchmark");
+    Shader shader("A:/Taief/semProVR/shaders/terrainVert.glsl", "A:/Taief/semProVR/shaders/terrainFrag.glsl", { "HEATMAP" });
+    if (!shader.isLoaded()) {
+        logger.log("ERROR: Failed to load shaders");
+        return -1;
+    }
+    shader.use();
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+    // The setters as they were: a std::string per call, looked up in an unordered_map
+    std::unordered_map<std::string, GLint> cache;
+    auto legacyLocation = [&](const std::string& name) {
+        auto it = cache.find(name);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        GLint location = glGetUniformLocation(program, name.c_str());
+        cache[name] = location;
+        return location;
+    };
+
+    const int setsPerFrame = 10000;
+    const int frames = 100;
+    double legacySeconds = 0.0;
+    double hashedSeconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        glFinish();
+        double start = glfwGetTime();
+        for (int i = 0; i < setsPerFrame / 4; ++i) {
+            float value = static_cast<float>(i);
+            glm::mat4 matrix(value);
+            glUniformMatrix4fv(legacyLocation("model"), 1, GL_FALSE, &matrix[0][0]);
+            glUniform1f(legacyLocation("heatmapMaxDensity"), value);
+            glUniform1i(legacyLocation("heatmapTexture"), i & 1);
+            glUniform2f(legacyLocation("gridScale"), value, value);
+        }
+        glFinish();
+        legacySeconds += glfwGetTime() - start;
+
+        start = glfwGetTime();
+        for (int i = 0; i < setsPerFrame / 4; ++i) {
+            float value = static_cast<float>(i);
+            shader.setMat4("model", glm::mat4(value));
+            shader.setFloat("heatmapMaxDensity", value);
+            shader.setInt("heatmapTexture", i & 1);
+            shader.setVec2("gridScale", glm::vec2(value));
+        }
+        glFinish();
+        hashedSeconds += glfwGetTime() - start;
+    }
+
+    logger.log("INFO: " + std::to_string(setsPerFrame) + " uniform sets per frame, string lookup " +
+        std::to_string(legacySeconds * 1000.0 / frames) + " ms, hashed names " + std::to_string(hashedSeconds * 1000.0 / frames) + " ms");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--headless") {
+            return runHeadless(argc, argv);
+        }
+        if (std::string(argv[i]) == "--compress-textures") {
+            return runTextureCompression(i + 1 < argc ? argv[i + 1] : "textures/");
+        }
+        if (std::string(argv[i]) == "--build-virtual-texture") {
+            return runVirtualTextureBuild(argc, argv, i + 1);
+        }
+        if (std::string(argv[i]) == "--bench-uniforms") {
+            return runUniformBenchmark();
+        }
+    }
+
     logger.log("INFO: Starting application");
 
     // Initialize WindowManager
@@ -223,11 +353,11 @@ int main() {
     }
 
     // Load shaders
-    Shader terrainShader("A:/Taief/semProVR/shaders/terrainVert.glsl", "A:/Taief/semProVR/shaders/terrainFrag.glsl");
+    ShaderVariants terrainShader("A:/Taief/semProVR/shaders/terrainVert.glsl", "A:/Taief/semProVR/shaders/terrainFrag.glsl", Terrain::getShaderDefines());
     Shader pathShader("A:/Taief/semProVR/shaders/pathVert.glsl", "A:/Taief/semProVR/shaders/pathFrag.glsl");
     Shader hikerShader("A:/Taief/semProVR/shaders/hikerVert.glsl", "A:/Taief/semProVR/shaders/hikerFrag.glsl"); // New shader for hiker
 
-    if (!terrainShader.isLoaded() || !pathShader.isLoaded() || !hikerShader.isLoaded()) {
+    if (!terrainShader.get(0).isLoaded() || !pathShader.isLoaded() || !hikerShader.isLoaded()) {
         logger.log("ERROR: Failed to load shaders");
         return -1;
     }
@@ -238,6 +368,9 @@ int main() {
     // Initialize hiker model
     initHikerModel();
 
+    // Camera, light and time shared by every shader
+    FrameUniforms frameUniforms;
+
     // Set initial time
     lastFrame = static_cast<float>(glfwGetTime());
 
@@ -253,6 +386,7 @@ int main() {
         // Clear buffers for the new frame
         glClearColor(0.6f, 0.8f, 1.0f, 1.0f); // Light blue sky color
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLStateCache::getInstance().invalidate();
 
         // Process input
         processInput(window);
@@ -267,18 +401,30 @@ int main() {
         glm::mat4 view = glm::lookAt(cameraPosition, cameraPosition + cameraFront, cameraUp);
         glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / HEIGHT, 0.1f, 1000.0f);
 
+        FrameData frameData = {};
+        frameData.view = view;
+        frameData.projection = projection;
+        frameData.viewProjection = projection * view;
+        frameData.cameraPosition = glm::vec4(cameraPosition, 1.0f);
+        frameData.lightPosition = glm::vec4(0.0f, 100.0f, 0.0f, 1.0f); // Fixed overhead light
+        frameData.lightColor = glm::vec4(1.0f);
+        frameData.sunDirection = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+        frameData.time = currentFrame;
+        frameData.deltaTime = deltaTime;
+        frameUniforms.update(frameData);
+
         // Render terrain
-        terrain.render(glm::mat4(1.0f), view, projection, cameraPosition);
+        terrain.render(glm::mat4(1.0f));
 
         // Update hiker's position
         hiker.updatePosition(deltaTime, terrain);
 
         // Render hiker's path
-        hiker.renderPath(view, projection, pathShader);
+        hiker.renderPath(pathShader);
 
         // Render hiker at current position
         glm::vec3 hikerPosition = hiker.getPosition();
-        renderHiker(hikerPosition, hikerShader, view, projection);
+        renderHiker(hikerPosition, hikerShader);
 
         // Output hiker progress
         std::cout << "Hiker position: (" << hikerPosition.x << ", " << hikerPosition.y << ", " << hikerPosition.z << ")\n";
@@ -291,9 +437,10 @@ int main() {
     // Cleanup resources
     terrain.cleanup();
     hiker.cleanup();
+    frameUniforms.cleanup();
 
     // Cleanup hiker model
-    glDeleteVertexArrays(1, &hikerVAO);
+    GLStateCache::getInstance().deleteVertexArray(hikerVAO);
     glDeleteBuffers(1, &hikerVBO);
 
     logger.log("INFO: Program terminated successfully");